@@ -0,0 +1,44 @@
+#pragma once
+#include <optional>
+
+#include "shape/shape.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace graphics::shape {
+class Cube : public Shape {
+ public:
+  explicit Cube(glm::vec3 position) noexcept;
+
+  glm::vec3 getPosition() const noexcept { return glm::round(rotation * position); }
+  float getPosition(Axis axis) const noexcept { return glm::round((rotation * position)[static_cast<int>(axis)]); }
+  bool isIdle() const noexcept { return !rotation_direction.has_value(); }
+  const glm::quat& getRotation() const noexcept { return rotation; }
+  /// @return Translation applied before the rotation, i.e. model = rotation * translate(offset).
+  glm::vec3 getOffset() const noexcept { return glm::vec3(translation[3]) + position; }
+
+  /// @brief Advance the rotation animation by one frame, returns true if the rotation changed.
+  bool update() noexcept;
+
+  void setupModel() noexcept override;
+  void draw() const noexcept override;
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Cube"; }
+
+  /// @brief Start a quarter turn, +90 degrees about axis or -90 degrees if inverse.
+  void rotate(Axis axis, bool inverse = false);
+
+ private:
+  static constexpr float scale = 1.2f;
+  static int rotation_speed;
+  static glm::quat base_rotation[3];
+  std::optional<int> rotation_direction;
+  bool rotation_inverse = false;
+  int rotation_progress;
+  glm::vec3 position;
+  glm::mat4 translation;
+  glm::quat rotation;
+  // Rotation at the end of the current turn, an exact cube rotation
+  glm::quat target_rotation;
+};
+}  // namespace graphics::shape
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "utils.h"
+
+namespace graphics::shape {
+/**
+ * @brief Core-profile renderer that draws all cubies with one glDrawElementsInstanced call.
+ *
+ * The unit cubie is uploaded once. Each instance stores a rotation quaternion and a translation, and only the
+ * instances changed since the last draw are uploaded, so a frame without a turning layer uploads nothing.
+ */
+class CubeRenderer final {
+ public:
+  DELETE_COPY(CubeRenderer)
+  DELETE_MOVE(CubeRenderer)
+  /// @brief Create the program and buffers for up to capacity cubies, needs an OpenGL 3.3 context.
+  explicit CubeRenderer(std::size_t capacity);
+  ~CubeRenderer();
+
+  /// @brief Set the transform of cubie index, model = rotation * translate(offset).
+  void setInstance(std::size_t index, const glm::quat& rotation, const glm::vec3& offset) noexcept;
+  /// @brief Upload the changed instances and draw the first count cubies.
+  void draw(const float* viewMatrix, const float* projectionMatrix, std::size_t count);
+
+  std::size_t getCapacity() const noexcept { return instances.size(); }
+  /// @return Instance bytes uploaded by the last draw call.
+  std::size_t getUploadedBytes() const noexcept { return uploadedBytes; }
+
+ private:
+  struct Instance {
+    // x, y, z, w
+    glm::vec4 rotation;
+    // xyz, w unused
+    glm::vec4 offset;
+  };
+  GLuint program;
+  GLuint vertexArray;
+  GLuint vertexBuffer;
+  GLuint indexBuffer;
+  GLuint instanceBuffer;
+  GLint viewProjectionLocation;
+  std::vector<Instance> instances;
+  // Changed instances are [dirtyBegin, dirtyEnd)
+  std::size_t dirtyBegin;
+  std::size_t dirtyEnd;
+  std::size_t uploadedBytes;
+};
+}  // namespace graphics::shape
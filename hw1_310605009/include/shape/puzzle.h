@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "shape/cube.h"
+#include "utils.h"
+
+namespace graphics::shape {
+/**
+ * @brief N x N x N puzzle made of Cube cubies.
+ *
+ * Only surface cubies exist, interior ones can never be seen. Every cubie is listed in one layer per axis, so a layer
+ * turn touches just the cubies of that layer. Turns are queued and animated one after another, input is never
+ * dropped while a layer is still turning.
+ */
+class Puzzle {
+ public:
+  struct Move {
+    Axis axis;
+    // Layer 0 .. size - 1 along axis, wholePuzzle turns every layer.
+    int layer;
+    // Turn by -90 degrees about axis instead of +90
+    bool inverse;
+  };
+  static constexpr int wholePuzzle = -1;
+
+  MOVE_ONLY(Puzzle)
+  explicit Puzzle(int size);
+
+  int getSize() const noexcept { return size; }
+  std::size_t getCubieCount() const noexcept { return cubes.size(); }
+  const Cube& getCubie(std::size_t index) const noexcept { return cubes[index]; }
+  /// @return Cubie indices of a layer, in no particular order.
+  const std::vector<uint32_t>& getLayer(Axis axis, int layer) const noexcept {
+    return layers[static_cast<int>(axis)][layer];
+  }
+  /// @return Layer of a cubie along axis, turns are applied when their animation starts.
+  int getLayerOf(std::size_t index, Axis axis) const noexcept {
+    return cubies[index].coordinate[static_cast<int>(axis)];
+  }
+  bool isIdle() const noexcept { return active.empty() && moves.empty(); }
+  std::size_t getQueuedMoveCount() const noexcept { return moves.size(); }
+
+  /// @brief Queue a quarter turn of a layer (or wholePuzzle), throws std::out_of_range for invalid layers.
+  void push(Axis axis, int layer, bool inverse = false);
+  /**
+   * @brief Sticker colors of the started moves, 6 * size * size letters in U, R, F, D, L, B face order.
+   *
+   * Each face is read row by row in the layout of Kociemba's facelet strings (U = +Y, R = +X, F = +Z), and every
+   * sticker is named after the face it started on. Queued moves that have not started are not included.
+   */
+  std::string getFacelets() const;
+  /**
+   * @brief Advance the animation by one frame, starting the next queued move when the current one finishes.
+   *
+   * @param changed Called with the index of every cubie whose rotation changed this frame.
+   */
+  template <class Callback>
+  void update(Callback&& changed) {
+    if (active.empty()) {
+      if (moves.empty()) return;
+      start(moves.front());
+      moves.pop_front();
+    }
+    for (uint32_t index : active) {
+      cubes[index].update();
+      changed(static_cast<std::size_t>(index));
+    }
+    // Cubies of a move start together and finish together.
+    if (cubes[active.front()].isIdle()) active.clear();
+  }
+
+ private:
+  struct Cubie {
+    // Layer along each axis
+    std::array<int, 3> coordinate;
+    // Coordinate of the solved puzzle
+    std::array<int, 3> home;
+    // Position inside layers[axis][coordinate[axis]]
+    std::array<uint32_t, 3> slot;
+  };
+  /// @brief Rotate the logical coordinates of the move's cubies and start their animation.
+  void start(const Move& move);
+  void moveToLayer(uint32_t index, int axis, int layer);
+
+  int size;
+  std::vector<Cube> cubes;
+  std::vector<Cubie> cubies;
+  // layers[axis][layer] lists the cubie indices in that layer
+  std::array<std::vector<std::vector<uint32_t>>, 3> layers;
+  std::deque<Move> moves;
+  // Cubies of the move being animated
+  std::vector<uint32_t> active;
+};
+}  // namespace graphics::shape
@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils.h"
+
+namespace solver {
+/// Face turns U, U2, U', R, ..., B', i.e. face * 3 + quarter turns - 1, clockwise as seen from the face.
+enum class Move : uint8_t {
+  U1, U2, U3, R1, R2, R3, F1, F2, F3, D1, D2, D3, L1, L2, L3, B1, B2, B3
+};
+constexpr int moveCount = 18;
+constexpr int cornerCount = 8;
+constexpr int edgeCount = 12;
+
+constexpr int getFace(Move move) { return static_cast<int>(move) / 3; }
+/// @return Clockwise quarter turns, 1 .. 3.
+constexpr int getPower(Move move) { return static_cast<int>(move) % 3 + 1; }
+constexpr Move makeMove(int face, int power) { return static_cast<Move>(face * 3 + power - 1); }
+/// @return Singmaster notation, e.g. "R2" or "F'".
+const char* getMoveName(Move move);
+/// @brief Parse a space separated move sequence, throws std::invalid_argument on unknown moves.
+std::vector<Move> parseMoves(std::string_view text);
+std::string toString(const std::vector<Move>& moves);
+
+/**
+ * @brief Packed cubie-level state of a 3x3x3 puzzle, 20 bytes.
+ *
+ * Byte i of corners is the corner cubie at position i (URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB) with its twist in bits
+ * 3-4. Byte i of edges is the edge cubie at position i (UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR) with its flip
+ * in bit 4. Centers are fixed. Moves are table-driven byte permutations, and the coordinates are the ones of
+ * Kociemba's two-phase algorithm.
+ */
+class CubeState {
+ public:
+  /// @brief Solved state.
+  CubeState() noexcept;
+  /**
+   * @brief Convert a 54-letter facelet string (U1..U9, R1..R9, F1..F9, D1..D9, L1..L9, B1..B9).
+   *
+   * Any six letters can be used as colors, each face is named after the letter of its center. Throws
+   * std::invalid_argument if the stickers do not describe a solvable cube.
+   */
+  static CubeState fromFacelets(std::string_view facelets);
+  /// @brief State after applying other's permutation on top of this one.
+  CubeState operator*(const CubeState& other) const noexcept;
+  CubeState apply(Move move) const noexcept;
+  CubeState apply(const std::vector<Move>& moves) const noexcept;
+  bool operator==(const CubeState& other) const noexcept { return corners == other.corners && edges == other.edges; }
+  bool operator!=(const CubeState& other) const noexcept { return !(*this == other); }
+  bool isSolved() const noexcept { return *this == CubeState(); }
+  std::size_t hash() const noexcept;
+
+  int getCorner(int position) const noexcept { return corners[position] & 7; }
+  int getTwist(int position) const noexcept { return corners[position] >> 3; }
+  int getEdge(int position) const noexcept { return edges[position] & 15; }
+  int getFlip(int position) const noexcept { return edges[position] >> 4; }
+
+  // Phase 1 coordinates
+  /// @return Corner orientation, 0 .. 2186.
+  int getTwistCoordinate() const noexcept;
+  /// @return Edge orientation, 0 .. 2047.
+  int getFlipCoordinate() const noexcept;
+  /// @return Positions of the FR, FL, BL, BR edges, 0 .. 494 (0 when they are in the middle layer).
+  int getSliceCoordinate() const noexcept;
+  // Phase 2 coordinates, only meaningful when the twist, flip and slice coordinates are 0
+  /// @return Corner permutation, 0 .. 40319.
+  int getCornerPermutation() const noexcept;
+  /// @return Permutation of the eight U and D layer edges, 0 .. 40319.
+  int getEdgePermutation() const noexcept;
+  /// @return Permutation of the four middle layer edges, 0 .. 23.
+  int getSlicePermutation() const noexcept;
+
+  void setTwistCoordinate(int twist) noexcept;
+  void setFlipCoordinate(int flip) noexcept;
+  void setSliceCoordinate(int slice) noexcept;
+  void setCornerPermutation(int permutation) noexcept;
+  void setEdgePermutation(int permutation) noexcept;
+  void setSlicePermutation(int permutation) noexcept;
+
+ private:
+  /// @return States of the 18 moves applied to the solved cube.
+  static const std::array<CubeState, moveCount>& getMoveTable();
+
+  std::array<uint8_t, cornerCount> corners;
+  std::array<uint8_t, edgeCount> edges;
+};
+}  // namespace solver
+
+namespace std {
+template <>
+struct hash<solver::CubeState> {
+  std::size_t operator()(const solver::CubeState& state) const noexcept { return state.hash(); }
+};
+}  // namespace std
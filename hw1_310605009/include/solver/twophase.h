@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "solver/cubestate.h"
+#include "utils.h"
+
+namespace solver {
+/**
+ * @brief Kociemba's two-phase solver for the 3x3x3 puzzle.
+ *
+ * Phase 1 brings the cube into <U, D, R2, L2, F2, B2> (corners and edges oriented, middle layer edges in the middle
+ * layer), phase 2 solves it with those moves only. Both phases run IDA* over coordinate move tables, with the
+ * maximum of two pruning tables as heuristic. The pruning tables (4 MB) are generated on first use and cached on
+ * disk, the move tables are rebuilt every time since that takes a few milliseconds.
+ */
+class TwoPhaseSolver {
+ public:
+  struct Statistics {
+    // Pruning tables were read from the cache file
+    bool loadedFromCache = false;
+    // Time to build the move tables and to load or generate the pruning tables
+    double tableMilliseconds = 0;
+  };
+
+  DELETE_COPY(TwoPhaseSolver)
+  DELETE_MOVE(TwoPhaseSolver)
+  /**
+   * @brief Build the tables, reading the pruning tables from cacheFile if it is valid.
+   *
+   * Otherwise they are generated and written to cacheFile (unless it is empty). Failing to write the cache is not
+   * an error.
+   */
+  explicit TwoPhaseSolver(const utils::fs::path& cacheFile = {});
+  /**
+   * @brief Find a solution of at most maxLength moves.
+   *
+   * Returns the first solution found, std::nullopt if none exists within maxLength or timeout elapsed. Random cubes
+   * are solved in 24 moves or less within milliseconds.
+   */
+  std::optional<std::vector<Move>> solve(const CubeState& state,
+                                         int maxLength = 24,
+                                         std::chrono::milliseconds timeout = std::chrono::seconds(5)) const;
+  const Statistics& getStatistics() const { return statistics; }
+
+ private:
+  struct Search;
+  void buildMoveTables();
+  void generatePruningTables();
+  bool loadPruningTables(const utils::fs::path& cacheFile);
+  void savePruningTables(const utils::fs::path& cacheFile) const;
+
+  bool searchPhase1(Search& search, int twist, int flip, int slice, int depth) const;
+  bool searchPhase2(Search& search, int corner, int edge, int slice, int depth) const;
+  /// @brief Try to finish the phase 1 moves in search with phase 2.
+  bool startPhase2(Search& search) const;
+
+  // Move tables, [coordinate * moveCount + move], phase 2 tables only hold phase 2 moves
+  std::vector<uint16_t> twistMove, flipMove, sliceMove;
+  std::vector<uint16_t> cornerMove, edgeMove, slicePermutationMove;
+  // Pruning tables, minimum number of moves to reach the phase goal
+  std::vector<uint8_t> twistSlicePruning, flipSlicePruning;
+  std::vector<uint8_t> cornerSlicePruning, edgeSlicePruning;
+  Statistics statistics;
+};
+}  // namespace solver
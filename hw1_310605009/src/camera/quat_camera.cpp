@@ -77,7 +77,7 @@ void QuaternionCamera::updateView() {
 void QuaternionCamera::updateProjection(float aspectRatio) {
   constexpr float FOV = glm::radians(45.0f);
   constexpr float zNear = 0.1f;
-  constexpr float zFar = 100.0f;
+  constexpr float zFar = 1000.0f;
   projectionMatrix = glm::identity<glm::mat4>();
   projectionMatrix= glm::perspective(FOV, aspectRatio, zNear, zFar);
 
@@ -1,9 +1,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <algorithm>
 #include <memory>
-#include <vector>
+#include <random>
 
 #include <GLFW/glfw3.h>
 #define GLAD_GL_IMPLEMENTATION
@@ -13,16 +12,52 @@
 
 #include "camera/quat_camera.h"
 #include "context_manager.h"
-#include "shape/cube.h"
+#include "shape/cuberenderer.h"
+#include "shape/puzzle.h"
+#include "solver/twophase.h"
 
 using namespace glm;
 
 // Unnamed namespace for global variables
 namespace {
-std::vector<std::unique_ptr<graphics::shape::Cube>> cubes;
+std::unique_ptr<graphics::shape::Puzzle> puzzle;
+// Tables are built on the first solve request
+std::unique_ptr<solver::TwoPhaseSolver> cubeSolver;
+// Solve once the queued moves have been played
+bool solveRequested = false;
+
+// Play a face turn of the 3x3x3 solver on the puzzle (U = +Y, R = +X, F = +Z).
+void pushSolverMove(solver::Move move) {
+  using Axis = graphics::shape::Axis;
+  static const Axis axes[6] = {Axis::Y, Axis::X, Axis::Z, Axis::Y, Axis::X, Axis::Z};
+  int face = solver::getFace(move), power = solver::getPower(move);
+  // Clockwise seen from U, R or F is -90 degrees about the axis, from D, L or B it is +90 degrees.
+  bool positiveFace = face < 3;
+  int layer = positiveFace ? puzzle->getSize() - 1 : 0;
+  if (power == 3) {
+    puzzle->push(axes[face], layer, !positiveFace);
+  } else {
+    for (int i = 0; i < power; ++i) puzzle->push(axes[face], layer, positiveFace);
+  }
+}
+
+void solvePuzzle() {
+  if (!cubeSolver) {
+    cubeSolver = std::make_unique<solver::TwoPhaseSolver>("twophase.tables");
+    printf("Solver tables ready in %.1f ms\n", cubeSolver->getStatistics().tableMilliseconds);
+  }
+  solver::CubeState state = solver::CubeState::fromFacelets(puzzle->getFacelets());
+  auto moves = cubeSolver->solve(state);
+  if (!moves) {
+    puts("No solution found.");
+    return;
+  }
+  printf("Solution (%zu moves): %s\n", moves->size(), solver::toString(*moves).c_str());
+  for (solver::Move move : *moves) pushSolverMove(move);
+}
 }  // namespace
 
-void keyCallback(GLFWwindow* window, int key, int original_front, int action, int mode) {
+void keyCallback(GLFWwindow* window, int key, int, int action, int) {
   // There are three actions: press, release, hold
   if (action != GLFW_PRESS) return;
   // Press ESC to close the window.
@@ -30,85 +65,38 @@ void keyCallback(GLFWwindow* window, int key, int original_front, int action, in
     glfwSetWindowShouldClose(window, GLFW_TRUE);
     return;
   }
-  // Check all cubes are not rotating
-  bool idle = std::all_of(cubes.begin(), cubes.end(), [](const auto& cube) { return cube->isIdle(); });
-  if (!idle) return;
-  // There are three Axis: X, Y, Z
+  // Moves are queued, so keys pressed while a layer is turning are not dropped.
   using Axis = graphics::shape::Axis;
-  
-    for (auto& cube : cubes) {
-      switch (key) { 
-         case 'U':
-            cube->rotate(Axis::X);
-          break;
-        case 'R':    
-          if (cube->getPosition(Axis::X) == 1) {
-              
-            cube->rotate(Axis::X);
-          }
-          break;
-        case 'F':
-          if (cube->getPosition(Axis::X) == 0) {
-            cube->rotate(Axis::X);
-          }
-          break;
-        case 'V':
-          if (cube->getPosition(Axis::X) == -1) {
-            cube->rotate(Axis::X);
-          }
-          break;
-        case 'J':
-          cube->rotate(Axis::Y);
-          break;
-        case 'T':
-          if (cube->getPosition(Axis::Y) == 1) {
-            cube->rotate(Axis::Y);
-          }
-          break;
-        case 'G':
-          if (cube->getPosition(Axis::Y) == 0) {
-            cube->rotate(Axis::Y);
-          }
-          break;
-        case 'B':
-          if (cube->getPosition(Axis::Y) == -1) {
-            cube->rotate(Axis::Y);
-          }
-          break;
-        case 'M':
-          cube->rotate(Axis::Z);
-          break;
-        case 'Y':
-          if (cube->getPosition(Axis::Z) == 1) {
-            cube->rotate(Axis::Z);
-          }
-          break;
-        case 'H':
-          if (cube->getPosition(Axis::Z) == 0) {
-            cube->rotate(Axis::Z);
-          }
-          break;
-        case 'N':
-          if (cube->getPosition(Axis::Z) == -1) {
-            cube->rotate(Axis::Z);
-          }
-          break;
-      }
+  using Puzzle = graphics::shape::Puzzle;
+  const int last = puzzle->getSize() - 1, middle = puzzle->getSize() / 2;
+  switch (key) {
+    case 'U': puzzle->push(Axis::X, Puzzle::wholePuzzle); break;
+    case 'R': puzzle->push(Axis::X, last); break;
+    case 'F': puzzle->push(Axis::X, middle); break;
+    case 'V': puzzle->push(Axis::X, 0); break;
+    case 'J': puzzle->push(Axis::Y, Puzzle::wholePuzzle); break;
+    case 'T': puzzle->push(Axis::Y, last); break;
+    case 'G': puzzle->push(Axis::Y, middle); break;
+    case 'B': puzzle->push(Axis::Y, 0); break;
+    case 'M': puzzle->push(Axis::Z, Puzzle::wholePuzzle); break;
+    case 'Y': puzzle->push(Axis::Z, last); break;
+    case 'H': puzzle->push(Axis::Z, middle); break;
+    case 'N': puzzle->push(Axis::Z, 0); break;
+    // Scramble with random face turns
+    case 'P': {
+      if (puzzle->getSize() != 3) break;
+      static std::mt19937 random{std::random_device{}()};
+      for (int i = 0; i < 25; ++i) pushSolverMove(static_cast<solver::Move>(random() % solver::moveCount));
+      break;
     }
-   
-  
-  // TODO: Detect key-events, perform rotation
-  //       1. Use switch/case to find the key you want.
-  //       2. Iterate through all cubes, perform rotation on those you want to rotate.
-  // Hint:
-  //       1. You can get the cube's layer by calling getPosition with Axis ( cube->getPosition(Axis::X) ),
-  //          the return value can be {-1, 0, 1}, representing three layers
-  //       2. You can rotate it by calling rotate with Axis ( cube->rotate(Axis::X) )
-  //       3. glfw3's key list (https://www.glfw.org/docs/3.3/group__keys.html)
-  // Note:
-  //       You should finish your cube rendering first.
-  //       Otherwise you will spend a lot of time debugging this with a black screen.
-  
+    // Solve with the two-phase solver
+    case 'K':
+      if (puzzle->getSize() == 3)
+        solveRequested = true;
+      else
+        puts("The solver only supports 3x3x3 puzzles.");
+      break;
+  }
 }
 
 void resizeCallback(GLFWwindow* window, int width, int height) {
@@ -119,14 +107,16 @@ void resizeCallback(GLFWwindow* window, int width, int height) {
   }
 }
 
-int main() {
- 
+int main(int argc, char** argv) {
+  // Puzzle size, e.g. "HW1 50" for a 50x50x50 cube
+  int size = argc > 1 ? atoi(argv[1]) : 3;
+  if (size < 1) size = 3;
   // Initialize OpenGL context, details are wrapped in class.
 #ifdef __APPLE__
-  // MacOS need explicit request legacy support
-  OpenGLContext::createContext(21, GLFW_OPENGL_ANY_PROFILE);
+  // MacOS only supports up to 4.1 core profile
+  OpenGLContext::createContext(41, GLFW_OPENGL_CORE_PROFILE);
 #else
-  OpenGLContext::createContext(43, GLFW_OPENGL_COMPAT_PROFILE);
+  OpenGLContext::createContext(43, GLFW_OPENGL_CORE_PROFILE);
 #endif
   GLFWwindow* window = OpenGLContext::getWindow();
   glfwSetWindowTitle(window, "HW1");
@@ -139,57 +129,32 @@ int main() {
   OpenGLContext::enableDebugCallback();
 #endif
   // Setup camera.
-  graphics::camera::QuaternionCamera camera(glm::vec3(0, 0, 15));
+  graphics::camera::QuaternionCamera camera(glm::vec3(0, 0, 5.0f * size));
   camera.initialize(OpenGLContext::getAspectRatio());
   glfwSetWindowUserPointer(window, &camera);
-  // Generate all mini-cubes
-  for (int i = -1; i <= 1; ++i) {
-    for (int j = -1; j <= 1; ++j) {
-      for (int k = -1; k <= 1; ++k) {
-        cubes.emplace_back(std::make_unique<graphics::shape::Cube>(glm::vec3(i, j, k)));
-        //cubes-> draw(color(0.502f, 0.0f, 0.502f, 1.0f));
-      }
-    }
-  }
+  // Generate all surface mini-cubes
+  puzzle = std::make_unique<graphics::shape::Puzzle>(size);
+  // All cubies in one instanced draw call
+  graphics::shape::CubeRenderer renderer(puzzle->getCubieCount());
+  auto updateInstance = [&renderer](std::size_t index) {
+    const graphics::shape::Cube& cube = puzzle->getCubie(index);
+    renderer.setInstance(index, cube.getRotation(), cube.getOffset());
+  };
+  for (std::size_t i = 0; i < puzzle->getCubieCount(); ++i) updateInstance(i);
   // Main rendering loop
   while (!glfwWindowShouldClose(window)) {
-    glDisable(GL_CULL_FACE);
     // Polling events.
     glfwPollEvents();
     camera.move(window);
     // GL_XXX_BIT can simply "OR" together to use.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    // Projection Matrix
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(camera.getProjectionMatrix());
-    // ModelView Matrix
-    glMatrixMode(GL_MODELVIEW);
-    glLoadMatrixf(camera.getViewMatrix());
- 
-    /*for (int i = 0; i < cubes.size(); i++) {
-      graphics::shape::Cube& cube = *cubes[i];
-      glPushMatrix();
-      cube->setupModel();
-      cube->draw();
-      glPopMatrix();
-    }*/
-    for (auto& cube : cubes)  // access by reference to avoid copying
-    {
-      glPushMatrix();
-      cube->setupModel();
-      
-      cube->draw();
-      glPopMatrix();
+    if (solveRequested && puzzle->isIdle()) {
+      solveRequested = false;
+      solvePuzzle();
     }
-
-    // TODO: Render Rubik's cube
-    //       1. Iterate through all cube in cubes.
-    //       2. For each cube, call cube->setupModel() and cube->draw().
-    //       3. You can use glPushMatrix, glPopMatrix to 'cache' the current matrix.
-    // Hint:
-    //       glPushMatrix/glPopMatrix   (https://www.khronos.org/registry/OpenGL-Refpages/gl2.1/xhtml/glPushMatrix.xml)
-    // Note:
-    //       You can implement this section using less than 10 lines of code.
+    // Only cubies of the turning layer change
+    puzzle->update(updateInstance);
+    renderer.draw(camera.getViewMatrix(), camera.getProjectionMatrix(), puzzle->getCubieCount());
 #ifdef __APPLE__
     // Some platform need explicit glFlush
     glFlush();
@@ -1,10 +1,26 @@
 #include "shape/cube.h"
 
+#include <cmath>
+
 #include <glad/gl.h>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "utils.h"
 
+namespace {
+/// @return q with each component rounded to one a cube rotation can have: 0, 1/2, sqrt(1/2) or 1, with its sign.
+glm::quat snapToCubeRotation(glm::quat q) {
+  constexpr float magnitudes[] = {0.0f, 0.5f, 0.70710678f, 1.0f};
+  for (int i = 0; i < 4; ++i) {
+    float nearest = magnitudes[0];
+    for (float magnitude : magnitudes)
+      if (std::abs(std::abs(q[i]) - magnitude) < std::abs(std::abs(q[i]) - nearest)) nearest = magnitude;
+    q[i] = std::copysign(nearest, q[i]);
+  }
+  return q;
+}
+}  // namespace
+
 namespace graphics::shape {
 // TODO (optional): If your cube rotates very slow or fast, you can change rotation_speed.
 int Cube::rotation_speed = 60;
@@ -17,21 +33,27 @@ Cube::Cube(glm::vec3 _position) noexcept
     : rotation_progress(rotation_speed),
       position(_position),
       translation(glm::translate(glm::identity<glm::mat4>(), position * scale)),
-      rotation(glm::identity<glm::quat>()) {}
-
+      rotation(glm::identity<glm::quat>()),
+      target_rotation(rotation) {}
+
+
+bool Cube::update() noexcept {
+  if (!rotation_direction) return false;
+  if (rotation_progress == 0) {
+    rotation_direction = std::nullopt;
+    rotation_progress = rotation_speed;
+    // Land exactly on the quarter turn, so rounding errors of the steps do not accumulate across moves.
+    rotation = target_rotation;
+    return true;
+  }
+  --rotation_progress;
+  const glm::quat& step = base_rotation[*rotation_direction];
+  rotation = (rotation_inverse ? glm::conjugate(step) : step) * rotation;
+  return true;
+}
 
 void Cube::setupModel() noexcept {
-  
-  if (rotation_direction) {
-    if (rotation_progress == 0) {
-      rotation_direction = std::nullopt;
-      rotation_progress = rotation_speed;
-    } else {
-      --rotation_progress;
-      rotation = base_rotation[*rotation_direction] * rotation;
-    }
-    
-  }
+  update();
   glm::mat4 rotation_matrix = glm::mat4_cast(this->rotation);
   glm::mat4 trans_matrix = glm::translate(this->translation, this->position);
   const float* ptr1 = glm::value_ptr(rotation_matrix);
@@ -156,5 +178,11 @@ void Cube::draw() const noexcept {
   // White, back
 }
 
-void Cube::rotate(Axis axis) { rotation_direction = static_cast<int>(axis); }
+void Cube::rotate(Axis axis, bool inverse) {
+  rotation_direction = static_cast<int>(axis);
+  rotation_inverse = inverse;
+  glm::vec3 direction(0);
+  direction[static_cast<int>(axis)] = inverse ? -1.0f : 1.0f;
+  target_rotation = snapToCubeRotation(glm::angleAxis(utils::PI_2<float>(), direction) * target_rotation);
+}
 }  // namespace graphics::shape
@@ -0,0 +1,188 @@
+#include "shape/cuberenderer.h"
+
+#include <algorithm>
+#include <string>
+
+#include <glm/gtc/type_ptr.hpp>
+
+namespace {
+// GLSL 3.30 core, so the same code runs on macOS' 4.1 core profile.
+constexpr const char* vertexShaderSource = R"(#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec4 rotation;
+layout(location = 3) in vec4 offset;
+
+uniform mat4 viewProjection;
+
+out vec3 fragmentColor;
+
+vec3 rotate(vec4 q, vec3 v) { return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v); }
+
+void main() {
+  fragmentColor = color;
+  gl_Position = viewProjection * vec4(rotate(rotation, position + offset.xyz), 1.0);
+}
+)";
+
+constexpr const char* fragmentShaderSource = R"(#version 330 core
+in vec3 fragmentColor;
+
+out vec4 color;
+
+void main() { color = vec4(fragmentColor, 1.0); }
+)";
+
+struct Vertex {
+  GLfloat position[3];
+  GLfloat color[3];
+};
+
+struct Face {
+  // Face normal is u x v, so (-u, -v), (u, -v), (u, v), (-u, v) is counter-clockwise from outside.
+  glm::vec3 u, v;
+  glm::vec3 color;
+};
+
+// Same colors as the immediate-mode Cube::draw.
+constexpr int faceCount = 6;
+const Face faces[faceCount] = {
+    {{0, 0, 1}, {1, 0, 0}, {0.0f, 1.0f, 0.0f}},  // Green, top
+    {{1, 0, 0}, {0, 0, 1}, {0.0f, 0.0f, 1.0f}},  // Blue, bottom
+    {{0, 1, 0}, {0, 0, 1}, {1.0f, 0.0f, 0.0f}},  // Red, right
+    {{0, 0, 1}, {0, 1, 0}, {1.0f, 0.5f, 0.0f}},  // Orange, left
+    {{1, 0, 0}, {0, 1, 0}, {1.0f, 1.0f, 0.0f}},  // Yellow, front
+    {{0, 1, 0}, {1, 0, 0}, {1.0f, 1.0f, 1.0f}},  // White, back
+};
+constexpr GLsizei cubieIndexCount = faceCount * 6;
+
+GLuint compileShader(GLenum type, const char* source) {
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint success;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    GLchar infoLog[1024];
+    glGetShaderInfoLog(shader, 1024, nullptr, infoLog);
+    glDeleteShader(shader);
+    THROW_EXCEPTION(std::runtime_error, std::string("Shader compilation error: ") + infoLog);
+  }
+  return shader;
+}
+
+GLuint linkProgram() {
+  GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+  GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  glLinkProgram(program);
+  glDetachShader(program, vertexShader);
+  glDetachShader(program, fragmentShader);
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+  GLint success;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    GLchar infoLog[1024];
+    glGetProgramInfoLog(program, 1024, nullptr, infoLog);
+    glDeleteProgram(program);
+    THROW_EXCEPTION(std::runtime_error, std::string("Failed to link shader program: ") + infoLog);
+  }
+  return program;
+}
+}  // namespace
+
+namespace graphics::shape {
+CubeRenderer::CubeRenderer(std::size_t capacity)
+    : program(linkProgram()),
+      vertexArray(0),
+      vertexBuffer(0),
+      indexBuffer(0),
+      instanceBuffer(0),
+      viewProjectionLocation(glGetUniformLocation(program, "viewProjection")),
+      instances(capacity, Instance{glm::vec4(0, 0, 0, 1), glm::vec4(0)}),
+      dirtyBegin(0),
+      dirtyEnd(capacity),
+      uploadedBytes(0) {
+  Vertex vertices[faceCount * 4];
+  GLushort indices[cubieIndexCount];
+  for (int i = 0; i < faceCount; ++i) {
+    const Face& face = faces[i];
+    glm::vec3 normal = glm::cross(face.u, face.v);
+    const float signs[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    for (int j = 0; j < 4; ++j) {
+      glm::vec3 corner = normal + signs[j][0] * face.u + signs[j][1] * face.v;
+      Vertex& vertex = vertices[i * 4 + j];
+      std::copy_n(glm::value_ptr(corner), 3, vertex.position);
+      std::copy_n(glm::value_ptr(face.color), 3, vertex.color);
+    }
+    const GLushort quad[6] = {0, 1, 2, 0, 2, 3};
+    for (int j = 0; j < 6; ++j) indices[i * 6 + j] = static_cast<GLushort>(i * 4 + quad[j]);
+  }
+
+  glGenVertexArrays(1, &vertexArray);
+  glGenBuffers(1, &vertexBuffer);
+  glGenBuffers(1, &indexBuffer);
+  glGenBuffers(1, &instanceBuffer);
+  glBindVertexArray(vertexArray);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        reinterpret_cast<GLvoid*>(offsetof(Vertex, position)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<GLvoid*>(offsetof(Vertex, color)));
+
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+  glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                        reinterpret_cast<GLvoid*>(offsetof(Instance, rotation)));
+  glVertexAttribDivisor(2, 1);
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                        reinterpret_cast<GLvoid*>(offsetof(Instance, offset)));
+  glVertexAttribDivisor(3, 1);
+
+  // Element array binding is part of the vertex array state.
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+  glBindVertexArray(0);
+}
+
+CubeRenderer::~CubeRenderer() {
+  glDeleteBuffers(1, &instanceBuffer);
+  glDeleteBuffers(1, &indexBuffer);
+  glDeleteBuffers(1, &vertexBuffer);
+  glDeleteVertexArrays(1, &vertexArray);
+  glDeleteProgram(program);
+}
+
+void CubeRenderer::setInstance(std::size_t index, const glm::quat& rotation, const glm::vec3& offset) noexcept {
+  instances[index] = Instance{glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w), glm::vec4(offset, 0)};
+  dirtyBegin = std::min(dirtyBegin, index);
+  dirtyEnd = std::max(dirtyEnd, index + 1);
+}
+
+void CubeRenderer::draw(const float* viewMatrix, const float* projectionMatrix, std::size_t count) {
+  count = std::min(count, instances.size());
+  uploadedBytes = 0;
+  glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+  if (dirtyBegin < dirtyEnd) {
+    // One upload of the changed range, a turning layer is a few slabs of the instance array.
+    uploadedBytes = (dirtyEnd - dirtyBegin) * sizeof(Instance);
+    glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * sizeof(Instance), uploadedBytes, instances.data() + dirtyBegin);
+    dirtyBegin = instances.size();
+    dirtyEnd = 0;
+  }
+  glm::mat4 viewProjection = glm::make_mat4(projectionMatrix) * glm::make_mat4(viewMatrix);
+  glUseProgram(program);
+  glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+  glBindVertexArray(vertexArray);
+  glDrawElementsInstanced(GL_TRIANGLES, cubieIndexCount, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(count));
+  glBindVertexArray(0);
+}
+}  // namespace graphics::shape
@@ -0,0 +1,114 @@
+#include "shape/puzzle.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+struct FaceLayout {
+  char name;
+  // Outward normal
+  glm::ivec3 normal;
+  // Axis and direction of facelet rows and columns, seen from outside with the face in the standard net
+  int rowAxis, rowSign, columnAxis, columnSign;
+};
+// U, R, F, D, L, B as in Kociemba's facelet strings.
+const FaceLayout faceLayouts[6] = {
+    {'U', {0, 1, 0}, 2, 1, 0, 1},    {'R', {1, 0, 0}, 1, -1, 2, -1}, {'F', {0, 0, 1}, 1, -1, 0, 1},
+    {'D', {0, -1, 0}, 2, -1, 0, 1}, {'L', {-1, 0, 0}, 1, -1, 2, 1}, {'B', {0, 0, -1}, 1, -1, 0, -1},
+};
+
+int findFace(const glm::ivec3& normal) {
+  for (int face = 0; face < 6; ++face)
+    if (faceLayouts[face].normal == normal) return face;
+  return -1;
+}
+}  // namespace
+
+namespace graphics::shape {
+Puzzle::Puzzle(int _size) : size(_size) {
+  if (size < 1) THROW_EXCEPTION(std::out_of_range, "Puzzle size must be positive, got " + std::to_string(size));
+  for (auto& axisLayers : layers) axisLayers.resize(size);
+  float center = (size - 1) * 0.5f;
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      for (int k = 0; k < size; ++k) {
+        bool surface = i == 0 || j == 0 || k == 0 || i == size - 1 || j == size - 1 || k == size - 1;
+        if (!surface) continue;
+        uint32_t index = static_cast<uint32_t>(cubes.size());
+        cubes.emplace_back(glm::vec3(i - center, j - center, k - center));
+        Cubie cubie{{i, j, k}, {i, j, k}, {}};
+        for (int axis = 0; axis < 3; ++axis) {
+          std::vector<uint32_t>& layer = layers[axis][cubie.coordinate[axis]];
+          cubie.slot[axis] = static_cast<uint32_t>(layer.size());
+          layer.push_back(index);
+        }
+        cubies.push_back(cubie);
+      }
+    }
+  }
+}
+
+void Puzzle::push(Axis axis, int layer, bool inverse) {
+  if (layer != wholePuzzle && (layer < 0 || layer >= size))
+    THROW_EXCEPTION(std::out_of_range, "Invalid layer " + std::to_string(layer));
+  moves.push_back(Move{axis, layer, inverse});
+}
+
+std::string Puzzle::getFacelets() const {
+  const int faceSize = size * size;
+  std::string facelets(6 * faceSize, '?');
+  auto toStep = [this](int sign, int layer) { return sign > 0 ? layer : size - 1 - layer; };
+  for (std::size_t index = 0; index < cubes.size(); ++index) {
+    const Cubie& cubie = cubies[index];
+    for (int home = 0; home < 6; ++home) {
+      const FaceLayout& homeFace = faceLayouts[home];
+      int axis = homeFace.normal.x != 0 ? 0 : (homeFace.normal.y != 0 ? 1 : 2);
+      int homeLayer = homeFace.normal[axis] > 0 ? size - 1 : 0;
+      if (cubie.home[axis] != homeLayer) continue;
+      // The sticker normal turns with the cubie, quarter turns keep it on a coordinate axis.
+      glm::vec3 normal = cubes[index].getRotation() * glm::vec3(homeFace.normal);
+      int face = findFace(glm::ivec3(std::lround(normal.x), std::lround(normal.y), std::lround(normal.z)));
+      if (face < 0) continue;
+      const FaceLayout& layout = faceLayouts[face];
+      // Rows and columns count from the top-left corner of the face.
+      int row = toStep(layout.rowSign, cubie.coordinate[layout.rowAxis]);
+      int column = toStep(layout.columnSign, cubie.coordinate[layout.columnAxis]);
+      facelets[face * faceSize + row * size + column] = homeFace.name;
+    }
+  }
+  return facelets;
+}
+
+void Puzzle::moveToLayer(uint32_t index, int axis, int layer) {
+  Cubie& cubie = cubies[index];
+  std::vector<uint32_t>& from = layers[axis][cubie.coordinate[axis]];
+  // Swap-remove, the moved-in cubie takes over the slot.
+  uint32_t last = from.back();
+  from[cubie.slot[axis]] = last;
+  cubies[last].slot[axis] = cubie.slot[axis];
+  from.pop_back();
+  std::vector<uint32_t>& to = layers[axis][layer];
+  cubie.coordinate[axis] = layer;
+  cubie.slot[axis] = static_cast<uint32_t>(to.size());
+  to.push_back(index);
+}
+
+void Puzzle::start(const Move& move) {
+  int axis = static_cast<int>(move.axis);
+  if (move.layer == wholePuzzle) {
+    active.resize(cubes.size());
+    for (uint32_t i = 0; i < active.size(); ++i) active[i] = i;
+  } else {
+    active = layers[axis][move.layer];
+  }
+  // On the other two axes, +90 degrees maps (u, v) -> (size - 1 - v, u), -90 degrees (u, v) -> (v, size - 1 - u).
+  int u = (axis + 1) % 3, v = (axis + 2) % 3;
+  for (uint32_t index : active) {
+    std::array<int, 3> coordinate = cubies[index].coordinate;
+    moveToLayer(index, u, move.inverse ? coordinate[v] : size - 1 - coordinate[v]);
+    moveToLayer(index, v, move.inverse ? size - 1 - coordinate[u] : coordinate[u]);
+    cubes[index].rotate(move.axis, move.inverse);
+  }
+}
+}  // namespace graphics::shape
@@ -0,0 +1,64 @@
+// Cost of one layer turn of Puzzle (start plus every animation frame) for growing N, against scanning all N^3
+// cubies per turn and updating all of them per frame as before. Puzzle's cost grows with the layer (N^2 cubies at
+// most, 4 (N - 1) for inner layers), the scan with N^3.
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "shape/puzzle.h"
+
+namespace {
+using graphics::shape::Axis;
+using graphics::shape::Cube;
+using graphics::shape::Puzzle;
+constexpr int turns = 64;
+
+/// @return Microseconds per turn of the queued puzzle.
+double measurePuzzle(int size, std::size_t& touched) {
+  std::mt19937 random(size);
+  return utils::measureMilliseconds(1, [&] {
+           Puzzle puzzle(size);
+           for (int i = 0; i < turns; ++i) puzzle.push(static_cast<Axis>(random() % 3), random() % size);
+           touched = 0;
+           while (!puzzle.isIdle()) puzzle.update([&](std::size_t) { ++touched; });
+         }) *
+         1000 / turns;
+}
+
+/// @return Microseconds per turn of the previous approach, a layer test and an update for every cubie.
+double measureScan(int size) {
+  std::vector<Cube> cubes;
+  const float center = (size - 1) * 0.5f;
+  for (int i = 0; i < size; ++i)
+    for (int j = 0; j < size; ++j)
+      for (int k = 0; k < size; ++k) cubes.emplace_back(glm::vec3(i - center, j - center, k - center));
+  std::mt19937 random(size);
+  const int scanTurns = size >= 50 ? 2 : turns;
+  return utils::measureMilliseconds(1, [&] {
+           for (int i = 0; i < scanTurns; ++i) {
+             const Axis axis = static_cast<Axis>(random() % 3);
+             const float layer = static_cast<float>(random() % size) - center;
+             for (Cube& cube : cubes)
+               if (cube.getPosition(axis) == layer) cube.rotate(axis);
+             bool isMoving = true;
+             while (isMoving) {
+               isMoving = false;
+               for (Cube& cube : cubes) isMoving |= cube.update();
+             }
+           }
+         }) *
+         1000 / scanTurns;
+}
+}  // namespace
+
+int main() {
+  std::printf("%6s %10s %16s %14s %14s\n", "N", "cubies", "updates / turn", "puzzle us", "scan us");
+  for (int size : {3, 10, 30, 50, 100}) {
+    std::size_t touched = 0;
+    const double puzzle = measurePuzzle(size, touched);
+    Puzzle reference(size);
+    std::printf("%6d %10zu %16zu %14.1f %14.1f\n", size, reference.getCubieCount(), touched / turns, puzzle,
+                measureScan(size));
+  }
+}
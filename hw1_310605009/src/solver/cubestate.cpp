@@ -0,0 +1,339 @@
+#include "solver/cubestate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+using solver::cornerCount;
+using solver::edgeCount;
+
+enum Corner { URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB };
+enum Edge { UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR };
+enum Facelet {
+  U1, U2, U3, U4, U5, U6, U7, U8, U9,
+  R1, R2, R3, R4, R5, R6, R7, R8, R9,
+  F1, F2, F3, F4, F5, F6, F7, F8, F9,
+  D1, D2, D3, D4, D5, D6, D7, D8, D9,
+  L1, L2, L3, L4, L5, L6, L7, L8, L9,
+  B1, B2, B3, B4, B5, B6, B7, B8, B9
+};
+enum Color { U, R, F, D, L, B };
+constexpr int faceletCount = 54;
+
+// Stickers of each corner and edge position, clockwise starting with the U or D sticker (Kociemba's order).
+constexpr Facelet cornerFacelets[cornerCount][3] = {{U9, R1, F3}, {U7, F1, L3}, {U1, L1, B3}, {U3, B1, R3},
+                                                     {D3, F9, R7}, {D1, L9, F7}, {D7, B9, L7}, {D9, R9, B7}};
+constexpr Color cornerColors[cornerCount][3] = {{U, R, F}, {U, F, L}, {U, L, B}, {U, B, R},
+                                                 {D, F, R}, {D, L, F}, {D, B, L}, {D, R, B}};
+constexpr Facelet edgeFacelets[edgeCount][2] = {{U6, R2}, {U8, F2}, {U4, L2}, {U2, B2}, {D6, R8}, {D2, F8},
+                                                 {D4, L8}, {D8, B8}, {F6, R4}, {F4, L6}, {B6, L4}, {B4, R6}};
+constexpr Color edgeColors[edgeCount][2] = {{U, R}, {U, F}, {U, L}, {U, B}, {D, R}, {D, F},
+                                             {D, L}, {D, B}, {F, R}, {F, L}, {B, L}, {B, R}};
+
+struct BasicMove {
+  // Cubie moved to each position, and the orientation it gains
+  uint8_t cornerPermutation[cornerCount], cornerTwist[cornerCount];
+  uint8_t edgePermutation[edgeCount], edgeFlip[edgeCount];
+};
+// Clockwise quarter turns U, R, F, D, L, B.
+constexpr BasicMove basicMoves[6] = {
+    {{UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {{DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR}, {2, 0, 0, 1, 1, 0, 0, 2},
+     {FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {{UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB}, {1, 2, 0, 0, 2, 1, 0, 0},
+     {UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR}, {0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0}},
+    {{URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {{URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB}, {0, 1, 2, 0, 0, 2, 1, 0},
+     {UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}},
+    {{URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL}, {0, 0, 1, 2, 0, 0, 2, 1},
+     {UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB}, {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1}},
+};
+
+constexpr const char* moveNames[solver::moveCount] = {"U",  "U2", "U'", "R",  "R2", "R'", "F",  "F2", "F'",
+                                                      "D",  "D2", "D'", "L",  "L2", "L'", "B",  "B2", "B'"};
+
+constexpr int binomial(int n, int k) {
+  if (k < 0 || k > n) return 0;
+  int result = 1;
+  for (int i = 0; i < k; ++i) result = result * (n - i) / (i + 1);
+  return result;
+}
+
+// Lexicographic rank of a permutation of 0 .. count - 1.
+template <int count>
+int rankPermutation(const uint8_t* permutation) {
+  int rank = 0;
+  for (int i = 0; i < count; ++i) {
+    int smaller = 0;
+    for (int j = i + 1; j < count; ++j) smaller += permutation[j] < permutation[i];
+    rank = rank * (count - i) + smaller;
+  }
+  return rank;
+}
+
+template <int count>
+void unrankPermutation(int rank, uint8_t* permutation) {
+  int digits[count];
+  for (int i = count - 1; i >= 0; --i) {
+    digits[i] = rank % (count - i);
+    rank /= count - i;
+  }
+  uint8_t available[count];
+  for (int i = 0; i < count; ++i) available[i] = static_cast<uint8_t>(i);
+  int remaining = count;
+  for (int i = 0; i < count; ++i) {
+    permutation[i] = available[digits[i]];
+    std::copy(available + digits[i] + 1, available + remaining, available + digits[i]);
+    --remaining;
+  }
+}
+}  // namespace
+
+namespace solver {
+const char* getMoveName(Move move) { return moveNames[static_cast<int>(move)]; }
+
+std::vector<Move> parseMoves(std::string_view text) {
+  std::vector<Move> moves;
+  std::size_t begin = 0;
+  while (begin < text.size()) {
+    if (text[begin] == ' ') {
+      ++begin;
+      continue;
+    }
+    std::size_t end = std::min(text.find(' ', begin), text.size());
+    std::string_view token = text.substr(begin, end - begin);
+    auto name = std::find(std::begin(moveNames), std::end(moveNames), token);
+    if (name == std::end(moveNames)) THROW_EXCEPTION(std::invalid_argument, "Unknown move: " + std::string(token));
+    moves.push_back(static_cast<Move>(name - std::begin(moveNames)));
+    begin = end;
+  }
+  return moves;
+}
+
+std::string toString(const std::vector<Move>& moves) {
+  std::string text;
+  for (Move move : moves) {
+    if (!text.empty()) text += ' ';
+    text += getMoveName(move);
+  }
+  return text;
+}
+
+CubeState::CubeState() noexcept {
+  for (int i = 0; i < cornerCount; ++i) corners[i] = static_cast<uint8_t>(i);
+  for (int i = 0; i < edgeCount; ++i) edges[i] = static_cast<uint8_t>(i);
+}
+
+CubeState CubeState::fromFacelets(std::string_view facelets) {
+  if (facelets.size() != faceletCount) THROW_EXCEPTION(std::invalid_argument, "Facelet string must have 54 letters");
+  // Name the colors after the faces of their centers.
+  int colorOf[256];
+  std::fill(std::begin(colorOf), std::end(colorOf), -1);
+  for (int face = 0; face < 6; ++face) {
+    unsigned char center = facelets[face * 9 + 4];
+    if (colorOf[center] != -1) THROW_EXCEPTION(std::invalid_argument, "Two centers have the same color");
+    colorOf[center] = face;
+  }
+  int colors[faceletCount];
+  int colorCount[6] = {};
+  for (int i = 0; i < faceletCount; ++i) {
+    colors[i] = colorOf[static_cast<unsigned char>(facelets[i])];
+    if (colors[i] < 0) THROW_EXCEPTION(std::invalid_argument, "Sticker color does not match any center");
+    ++colorCount[colors[i]];
+  }
+  if (std::any_of(std::begin(colorCount), std::end(colorCount), [](int count) { return count != 9; }))
+    THROW_EXCEPTION(std::invalid_argument, "Every color must appear nine times");
+
+  CubeState state;
+  int twistSum = 0, flipSum = 0;
+  uint16_t cornerSeen = 0, edgeSeen = 0;
+  for (int i = 0; i < cornerCount; ++i) {
+    int twist = 0;
+    while (twist < 3 && colors[cornerFacelets[i][twist]] != U && colors[cornerFacelets[i][twist]] != D) ++twist;
+    if (twist == 3) THROW_EXCEPTION(std::invalid_argument, "Invalid corner stickers");
+    int color1 = colors[cornerFacelets[i][(twist + 1) % 3]], color2 = colors[cornerFacelets[i][(twist + 2) % 3]];
+    int corner = 0;
+    while (corner < cornerCount && (cornerColors[corner][1] != color1 || cornerColors[corner][2] != color2)) ++corner;
+    if (corner == cornerCount) THROW_EXCEPTION(std::invalid_argument, "Invalid corner stickers");
+    state.corners[i] = static_cast<uint8_t>(corner | twist << 3);
+    cornerSeen |= 1 << corner;
+    twistSum += twist;
+  }
+  for (int i = 0; i < edgeCount; ++i) {
+    int color0 = colors[edgeFacelets[i][0]], color1 = colors[edgeFacelets[i][1]];
+    int edge = 0, flip = 0;
+    for (; edge < edgeCount; ++edge) {
+      if (edgeColors[edge][0] == color0 && edgeColors[edge][1] == color1) break;
+      if (edgeColors[edge][0] == color1 && edgeColors[edge][1] == color0) {
+        flip = 1;
+        break;
+      }
+    }
+    if (edge == edgeCount) THROW_EXCEPTION(std::invalid_argument, "Invalid edge stickers");
+    state.edges[i] = static_cast<uint8_t>(edge | flip << 4);
+    edgeSeen |= 1 << edge;
+    flipSum += flip;
+  }
+  if (cornerSeen != 0xFF || edgeSeen != 0xFFF) THROW_EXCEPTION(std::invalid_argument, "Duplicated cubies");
+  if (twistSum % 3 != 0) THROW_EXCEPTION(std::invalid_argument, "Twisted corner");
+  if (flipSum % 2 != 0) THROW_EXCEPTION(std::invalid_argument, "Flipped edge");
+  // A single swap of two pieces changes the parity of one permutation only.
+  auto parity = [](const uint8_t* pieces, int count, int mask) {
+    int inversions = 0;
+    for (int i = 0; i < count; ++i)
+      for (int j = i + 1; j < count; ++j) inversions += (pieces[j] & mask) < (pieces[i] & mask);
+    return inversions % 2;
+  };
+  if (parity(state.corners.data(), cornerCount, 7) != parity(state.edges.data(), edgeCount, 15))
+    THROW_EXCEPTION(std::invalid_argument, "Swapped pieces");
+  return state;
+}
+
+CubeState CubeState::operator*(const CubeState& other) const noexcept {
+  CubeState result;
+  for (int i = 0; i < cornerCount; ++i) {
+    uint8_t moved = other.corners[i];
+    uint8_t corner = corners[moved & 7];
+    int twist = (corner >> 3) + (moved >> 3);
+    if (twist >= 3) twist -= 3;
+    result.corners[i] = static_cast<uint8_t>((corner & 7) | twist << 3);
+  }
+  for (int i = 0; i < edgeCount; ++i) {
+    uint8_t moved = other.edges[i];
+    result.edges[i] = static_cast<uint8_t>(edges[moved & 15] ^ (moved & 16));
+  }
+  return result;
+}
+
+const std::array<CubeState, moveCount>& CubeState::getMoveTable() {
+  static const auto table = [] {
+    std::array<CubeState, moveCount> result;
+    for (int face = 0; face < 6; ++face) {
+      const BasicMove& move = basicMoves[face];
+      CubeState quarter;
+      for (int i = 0; i < cornerCount; ++i)
+        quarter.corners[i] = static_cast<uint8_t>(move.cornerPermutation[i] | move.cornerTwist[i] << 3);
+      for (int i = 0; i < edgeCount; ++i)
+        quarter.edges[i] = static_cast<uint8_t>(move.edgePermutation[i] | move.edgeFlip[i] << 4);
+      result[face * 3] = quarter;
+      result[face * 3 + 1] = quarter * quarter;
+      result[face * 3 + 2] = quarter * quarter * quarter;
+    }
+    return result;
+  }();
+  return table;
+}
+
+CubeState CubeState::apply(Move move) const noexcept { return *this * getMoveTable()[static_cast<int>(move)]; }
+
+CubeState CubeState::apply(const std::vector<Move>& moves) const noexcept {
+  CubeState result = *this;
+  for (Move move : moves) result = result.apply(move);
+  return result;
+}
+
+std::size_t CubeState::hash() const noexcept {
+  uint64_t words[3] = {};
+  std::memcpy(words, corners.data(), cornerCount);
+  std::memcpy(words + 1, edges.data(), edgeCount);
+  uint64_t hash = words[0] * 0x9E3779B97F4A7C15ull;
+  hash = (hash ^ (hash >> 29) ^ words[1]) * 0xBF58476D1CE4E5B9ull;
+  hash = (hash ^ (hash >> 32) ^ words[2]) * 0x94D049BB133111EBull;
+  return static_cast<std::size_t>(hash ^ (hash >> 31));
+}
+
+int CubeState::getTwistCoordinate() const noexcept {
+  int twist = 0;
+  for (int i = URF; i < DRB; ++i) twist = twist * 3 + getTwist(i);
+  return twist;
+}
+
+int CubeState::getFlipCoordinate() const noexcept {
+  int flip = 0;
+  for (int i = UR; i < BR; ++i) flip = flip * 2 + getFlip(i);
+  return flip;
+}
+
+int CubeState::getSliceCoordinate() const noexcept {
+  int slice = 0, found = 0;
+  for (int j = BR; j >= UR; --j) {
+    if (getEdge(j) >= FR) slice += binomial(11 - j, ++found);
+  }
+  return slice;
+}
+
+int CubeState::getCornerPermutation() const noexcept {
+  uint8_t permutation[cornerCount];
+  for (int i = 0; i < cornerCount; ++i) permutation[i] = static_cast<uint8_t>(getCorner(i));
+  return rankPermutation<cornerCount>(permutation);
+}
+
+int CubeState::getEdgePermutation() const noexcept {
+  uint8_t permutation[8];
+  for (int i = 0; i < 8; ++i) permutation[i] = static_cast<uint8_t>(getEdge(i));
+  return rankPermutation<8>(permutation);
+}
+
+int CubeState::getSlicePermutation() const noexcept {
+  uint8_t permutation[4];
+  for (int i = 0; i < 4; ++i) permutation[i] = static_cast<uint8_t>(getEdge(FR + i) - FR);
+  return rankPermutation<4>(permutation);
+}
+
+void CubeState::setTwistCoordinate(int twist) noexcept {
+  int sum = 0;
+  for (int i = DBL; i >= URF; --i) {
+    int value = twist % 3;
+    twist /= 3;
+    sum += value;
+    corners[i] = static_cast<uint8_t>(getCorner(i) | value << 3);
+  }
+  corners[DRB] = static_cast<uint8_t>(getCorner(DRB) | (3 - sum % 3) % 3 << 3);
+}
+
+void CubeState::setFlipCoordinate(int flip) noexcept {
+  int sum = 0;
+  for (int i = BL; i >= UR; --i) {
+    int value = flip & 1;
+    flip >>= 1;
+    sum += value;
+    edges[i] = static_cast<uint8_t>(getEdge(i) | value << 4);
+  }
+  edges[BR] = static_cast<uint8_t>(getEdge(BR) | (sum & 1) << 4);
+}
+
+void CubeState::setSliceCoordinate(int slice) noexcept {
+  // Orientation is kept by position, only the cubies move.
+  int remaining = 4, sliceEdge = FR, otherEdge = UR;
+  for (int j = UR; j <= BR; ++j) {
+    int flip = edges[j] & 16;
+    if (remaining > 0 && slice - binomial(11 - j, remaining) >= 0) {
+      slice -= binomial(11 - j, remaining--);
+      edges[j] = static_cast<uint8_t>(sliceEdge++ | flip);
+    } else {
+      edges[j] = static_cast<uint8_t>(otherEdge++ | flip);
+    }
+  }
+}
+
+void CubeState::setCornerPermutation(int permutation) noexcept {
+  uint8_t pieces[cornerCount];
+  unrankPermutation<cornerCount>(permutation, pieces);
+  for (int i = 0; i < cornerCount; ++i) corners[i] = static_cast<uint8_t>(pieces[i] | (corners[i] & 24));
+}
+
+void CubeState::setEdgePermutation(int permutation) noexcept {
+  uint8_t pieces[8];
+  unrankPermutation<8>(permutation, pieces);
+  for (int i = 0; i < 8; ++i) edges[i] = static_cast<uint8_t>(pieces[i] | (edges[i] & 16));
+}
+
+void CubeState::setSlicePermutation(int permutation) noexcept {
+  uint8_t pieces[4];
+  unrankPermutation<4>(permutation, pieces);
+  for (int i = 0; i < 4; ++i) edges[FR + i] = static_cast<uint8_t>((FR + pieces[i]) | (edges[FR + i] & 16));
+}
+}  // namespace solver
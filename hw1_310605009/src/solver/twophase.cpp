@@ -0,0 +1,265 @@
+#include "solver/twophase.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+using solver::Move;
+using solver::moveCount;
+
+constexpr int twistCount = 2187;
+constexpr int flipCount = 2048;
+constexpr int sliceCount = 495;
+constexpr int cornerPermutationCount = 40320;
+constexpr int edgePermutationCount = 40320;
+constexpr int slicePermutationCount = 24;
+
+constexpr char cacheMagic[4] = {'K', 'O', 'C', 'I'};
+constexpr uint32_t cacheVersion = 1;
+constexpr uint8_t unvisited = 0xFF;
+
+// U, D and half turns of R, F, L, B keep the cube in the phase 2 subgroup.
+constexpr bool isPhase2Move(Move move) {
+  int face = solver::getFace(move);
+  return face == 0 || face == 3 || solver::getPower(move) == 2;
+}
+
+// Skip turning the same face twice, and turn opposite faces (which commute) in one order only.
+constexpr bool isRedundant(int face, int lastFace) { return face == lastFace || face + 3 == lastFace; }
+
+struct CacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t sizes[4];
+};
+
+/**
+ * Breadth-first distances from coordinate pair (0, 0). The table index is first * secondCount + second, the move
+ * tables are [coordinate * moveCount + move].
+ */
+std::vector<uint8_t> generatePruning(const std::vector<uint16_t>& firstMove,
+                                     int firstCount,
+                                     const std::vector<uint16_t>& secondMove,
+                                     int secondCount,
+                                     bool phase2) {
+  std::vector<uint8_t> table(static_cast<std::size_t>(firstCount) * secondCount, unvisited);
+  std::vector<uint32_t> frontier = {0}, next;
+  table[0] = 0;
+  for (uint8_t depth = 0; !frontier.empty(); ++depth) {
+    next.clear();
+    for (uint32_t index : frontier) {
+      int first = index / secondCount, second = index % secondCount;
+      for (int move = 0; move < moveCount; ++move) {
+        if (phase2 && !isPhase2Move(static_cast<Move>(move))) continue;
+        uint32_t target = firstMove[first * moveCount + move] * secondCount + secondMove[second * moveCount + move];
+        if (table[target] != unvisited) continue;
+        table[target] = static_cast<uint8_t>(depth + 1);
+        next.push_back(target);
+      }
+    }
+    frontier.swap(next);
+  }
+  return table;
+}
+
+template <class Getter, class Setter>
+std::vector<uint16_t> generateMoves(int count, bool phase2, Setter set, Getter get) {
+  std::vector<uint16_t> table(static_cast<std::size_t>(count) * moveCount, 0);
+  for (int coordinate = 0; coordinate < count; ++coordinate) {
+    solver::CubeState state;
+    set(state, coordinate);
+    for (int move = 0; move < moveCount; ++move) {
+      if (phase2 && !isPhase2Move(static_cast<Move>(move))) continue;
+      table[coordinate * moveCount + move] = static_cast<uint16_t>(get(state.apply(static_cast<Move>(move))));
+    }
+  }
+  return table;
+}
+}  // namespace
+
+namespace solver {
+struct TwoPhaseSolver::Search {
+  CubeState start;
+  std::vector<Move> moves;
+  // Number of phase 1 moves at the front of moves
+  int phase1Length;
+  int maxLength;
+  std::chrono::steady_clock::time_point deadline;
+  uint32_t nodes = 0;
+  bool timedOut = false;
+
+  bool checkTimeout() {
+    // Reading the clock is slow compared to a node, check it every few thousand nodes.
+    if ((++nodes & 4095) == 0 && std::chrono::steady_clock::now() > deadline) timedOut = true;
+    return timedOut;
+  }
+  int lastFace() const { return moves.empty() ? -1 : getFace(moves.back()); }
+};
+
+TwoPhaseSolver::TwoPhaseSolver(const utils::fs::path& cacheFile) {
+  auto start = std::chrono::steady_clock::now();
+  buildMoveTables();
+  if (!cacheFile.empty() && loadPruningTables(cacheFile)) {
+    statistics.loadedFromCache = true;
+  } else {
+    generatePruningTables();
+    if (!cacheFile.empty()) {
+      try {
+        savePruningTables(cacheFile);
+      } catch (const std::exception& e) {
+        // The cache only saves start-up time, keep running without it.
+        puts(e.what());
+      }
+    }
+  }
+  statistics.tableMilliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void TwoPhaseSolver::buildMoveTables() {
+  twistMove = generateMoves(
+      twistCount, false, [](CubeState& state, int value) { state.setTwistCoordinate(value); },
+      [](const CubeState& state) { return state.getTwistCoordinate(); });
+  flipMove = generateMoves(
+      flipCount, false, [](CubeState& state, int value) { state.setFlipCoordinate(value); },
+      [](const CubeState& state) { return state.getFlipCoordinate(); });
+  sliceMove = generateMoves(
+      sliceCount, false, [](CubeState& state, int value) { state.setSliceCoordinate(value); },
+      [](const CubeState& state) { return state.getSliceCoordinate(); });
+  cornerMove = generateMoves(
+      cornerPermutationCount, true, [](CubeState& state, int value) { state.setCornerPermutation(value); },
+      [](const CubeState& state) { return state.getCornerPermutation(); });
+  edgeMove = generateMoves(
+      edgePermutationCount, true, [](CubeState& state, int value) { state.setEdgePermutation(value); },
+      [](const CubeState& state) { return state.getEdgePermutation(); });
+  slicePermutationMove = generateMoves(
+      slicePermutationCount, true, [](CubeState& state, int value) { state.setSlicePermutation(value); },
+      [](const CubeState& state) { return state.getSlicePermutation(); });
+}
+
+void TwoPhaseSolver::generatePruningTables() {
+  twistSlicePruning = generatePruning(twistMove, twistCount, sliceMove, sliceCount, false);
+  flipSlicePruning = generatePruning(flipMove, flipCount, sliceMove, sliceCount, false);
+  cornerSlicePruning =
+      generatePruning(cornerMove, cornerPermutationCount, slicePermutationMove, slicePermutationCount, true);
+  edgeSlicePruning = generatePruning(edgeMove, edgePermutationCount, slicePermutationMove, slicePermutationCount, true);
+}
+
+bool TwoPhaseSolver::loadPruningTables(const utils::fs::path& cacheFile) {
+  std::ifstream input(cacheFile, std::ios::binary);
+  if (!input) return false;
+  CacheHeader header;
+  input.read(reinterpret_cast<char*>(&header), sizeof(header));
+  const uint32_t sizes[4] = {twistCount * sliceCount, flipCount * sliceCount,
+                             cornerPermutationCount * slicePermutationCount,
+                             edgePermutationCount * slicePermutationCount};
+  if (!input || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion ||
+      !std::equal(sizes, sizes + 4, header.sizes))
+    return false;
+  std::vector<uint8_t>* tables[4] = {&twistSlicePruning, &flipSlicePruning, &cornerSlicePruning, &edgeSlicePruning};
+  for (int i = 0; i < 4; ++i) {
+    tables[i]->resize(sizes[i]);
+    input.read(reinterpret_cast<char*>(tables[i]->data()), sizes[i]);
+  }
+  // A truncated file is regenerated.
+  return static_cast<bool>(input);
+}
+
+void TwoPhaseSolver::savePruningTables(const utils::fs::path& cacheFile) const {
+  CacheHeader header;
+  std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+  header.version = cacheVersion;
+  const std::vector<uint8_t>* tables[4] = {&twistSlicePruning, &flipSlicePruning, &cornerSlicePruning,
+                                           &edgeSlicePruning};
+  for (int i = 0; i < 4; ++i) header.sizes[i] = static_cast<uint32_t>(tables[i]->size());
+
+  // Write a temporary file first, so a crash never leaves a partial cache behind.
+  utils::fs::path temporary = cacheFile;
+  temporary += ".tmp";
+  {
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    if (!output) THROW_EXCEPTION(std::runtime_error, "Cannot write pruning tables: " + temporary.string());
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<uint8_t>* table : tables)
+      output.write(reinterpret_cast<const char*>(table->data()), table->size());
+    if (!output) THROW_EXCEPTION(std::runtime_error, "Cannot write pruning tables: " + temporary.string());
+  }
+  utils::fs::rename(temporary, cacheFile);
+}
+
+std::optional<std::vector<Move>> TwoPhaseSolver::solve(const CubeState& state,
+                                                       int maxLength,
+                                                       std::chrono::milliseconds timeout) const {
+  Search search;
+  search.start = state;
+  search.maxLength = maxLength;
+  search.deadline = std::chrono::steady_clock::now() + timeout;
+  int twist = state.getTwistCoordinate(), flip = state.getFlipCoordinate(), slice = state.getSliceCoordinate();
+  // Iterative deepening on the phase 1 length, each phase 1 solution is completed by the shortest phase 2.
+  for (int depth = 0; depth <= maxLength && !search.timedOut; ++depth) {
+    if (searchPhase1(search, twist, flip, slice, depth)) return search.moves;
+  }
+  return std::nullopt;
+}
+
+bool TwoPhaseSolver::searchPhase1(Search& search, int twist, int flip, int slice, int depth) const {
+  if (depth == 0) {
+    if (twist != 0 || flip != 0 || slice != 0) return false;
+    // A phase 2 move at the end means a shorter phase 1 solution exists, and it was already tried.
+    if (!search.moves.empty() && isPhase2Move(search.moves.back())) return false;
+    return startPhase2(search);
+  }
+  if (search.checkTimeout()) return false;
+  int lastFace = search.lastFace();
+  for (int move = 0; move < moveCount; ++move) {
+    if (isRedundant(getFace(static_cast<Move>(move)), lastFace)) {
+      move += 2;
+      continue;
+    }
+    int nextTwist = twistMove[twist * moveCount + move];
+    int nextFlip = flipMove[flip * moveCount + move];
+    int nextSlice = sliceMove[slice * moveCount + move];
+    int distance = std::max(twistSlicePruning[nextTwist * sliceCount + nextSlice],
+                            flipSlicePruning[nextFlip * sliceCount + nextSlice]);
+    if (distance > depth - 1) continue;
+    search.moves.push_back(static_cast<Move>(move));
+    if (searchPhase1(search, nextTwist, nextFlip, nextSlice, depth - 1)) return true;
+    search.moves.pop_back();
+  }
+  return false;
+}
+
+bool TwoPhaseSolver::startPhase2(Search& search) const {
+  CubeState state = search.start.apply(search.moves);
+  int corner = state.getCornerPermutation(), edge = state.getEdgePermutation(), slice = state.getSlicePermutation();
+  int distance = std::max(cornerSlicePruning[corner * slicePermutationCount + slice],
+                          edgeSlicePruning[edge * slicePermutationCount + slice]);
+  search.phase1Length = static_cast<int>(search.moves.size());
+  for (int depth = distance; depth <= search.maxLength - search.phase1Length; ++depth) {
+    if (searchPhase2(search, corner, edge, slice, depth)) return true;
+    if (search.timedOut) return false;
+  }
+  return false;
+}
+
+bool TwoPhaseSolver::searchPhase2(Search& search, int corner, int edge, int slice, int depth) const {
+  if (depth == 0) return corner == 0 && edge == 0 && slice == 0;
+  if (search.checkTimeout()) return false;
+  int lastFace = search.lastFace();
+  for (int move = 0; move < moveCount; ++move) {
+    if (!isPhase2Move(static_cast<Move>(move)) || isRedundant(getFace(static_cast<Move>(move)), lastFace)) continue;
+    int nextCorner = cornerMove[corner * moveCount + move];
+    int nextEdge = edgeMove[edge * moveCount + move];
+    int nextSlice = slicePermutationMove[slice * moveCount + move];
+    int distance = std::max(cornerSlicePruning[nextCorner * slicePermutationCount + nextSlice],
+                            edgeSlicePruning[nextEdge * slicePermutationCount + nextSlice]);
+    if (distance > depth - 1) continue;
+    search.moves.push_back(static_cast<Move>(move));
+    if (searchPhase2(search, nextCorner, nextEdge, nextSlice, depth - 1)) return true;
+    search.moves.pop_back();
+  }
+  return false;
+}
+}  // namespace solver
@@ -0,0 +1,52 @@
+// CubeState move throughput, TwoPhaseSolver table setup with and without the cache file, and solve time and length
+// over 200 random scrambles (or the first argument).
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "benchmark.h"
+#include "solver/twophase.h"
+
+int main(int argc, char** argv) {
+  using namespace solver;
+  const int scrambles = argc > 1 ? std::atoi(argv[1]) : 200;
+  constexpr int moveCount = 18, applies = 10000000;
+  CubeState state;
+  const double applyMilliseconds = utils::measureMilliseconds(3, [&] {
+    for (int i = 0; i < applies; ++i) state = state.apply(static_cast<Move>(i * 7 % moveCount));
+  });
+  // Printing the state keeps the loop from being optimized away.
+  std::printf("apply: %.1f M moves/s (corner 0 = %d)\n", applies / applyMilliseconds / 1000, state.getCorner(0));
+
+  const utils::fs::path cacheFile = utils::fs::temp_directory_path() / "twophase_benchmark.bin";
+  utils::fs::remove(cacheFile);
+  const double coldMilliseconds = utils::measureMilliseconds(1, [&] { TwoPhaseSolver cold(cacheFile); });
+  std::printf("tables: %.1f ms generated, ", coldMilliseconds);
+  TwoPhaseSolver solver(cacheFile);
+  std::printf("%.1f ms from the cache file (loaded %d)\n", solver.getStatistics().tableMilliseconds,
+              solver.getStatistics().loadedFromCache);
+
+  std::mt19937 random(310605009);
+  double total = 0, slowest = 0;
+  std::size_t totalLength = 0, longest = 0;
+  int failures = 0;
+  for (int i = 0; i < scrambles; ++i) {
+    CubeState scramble;
+    for (int j = 0; j < 40; ++j) scramble = scramble.apply(static_cast<Move>(random() % moveCount));
+    std::optional<std::vector<Move>> solution;
+    const double milliseconds = utils::measureMilliseconds(1, [&] { solution = solver.solve(scramble); });
+    total += milliseconds;
+    slowest = std::max(slowest, milliseconds);
+    if (!solution || !scramble.apply(*solution).isSolved()) {
+      ++failures;
+      continue;
+    }
+    totalLength += solution->size();
+    longest = std::max(longest, solution->size());
+  }
+  std::printf("solve: %d scrambles, %.2f ms average, %.2f ms slowest, %.2f moves average, %zu longest, %d failed\n",
+              scrambles, total / scrambles, slowest, static_cast<double>(totalLength) / scrambles, longest, failures);
+  utils::fs::remove(cacheFile);
+  return failures != 0;
+}
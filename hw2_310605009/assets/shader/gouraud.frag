@@ -0,0 +1,47 @@
+#version 330 core
+layout(location = 0) out vec4 FragColor;
+
+in vec2 TextureCoordinate;
+in vec3 rawPosition;
+in vec3 ambientVec;
+in vec3 specular;
+in vec3 diffuse;
+in float attenuation;
+in vec3 lighting;
+
+#ifdef CUBE_TEXTURE
+uniform samplerCube diffuseCubeTexture;
+#else
+uniform sampler2D diffuseTexture;
+#endif
+// precomputed shadow
+// Hint: You may want to uncomment this to use shader map texture.
+// uniform sampler2DShadow shadowMap;
+
+void main() {
+#ifdef CUBE_TEXTURE
+  vec3 color = texture(diffuseCubeTexture, rawPosition).rgb;
+#else
+  vec3 color = texture(diffuseTexture, TextureCoordinate).rgb;
+#endif
+  // TODO: vertex shader / fragment shader
+  // Hint:
+  //       1. how to write a vertex shader:
+  //          a. The output is gl_Position and anything you want to pass to the fragment shader. (Apply matrix multiplication yourself)
+  //       2. how to write a fragment shader:
+  //          a. The output is FragColor (any var is OK)
+  //       3. colors
+  //          a. For point light & directional light, lighting = ambient + attenuation * shadow * (diffuse + specular)
+  //          b. If you want to implement multiple light sources, you may want to use lighting = shadow * attenuation * (ambient + (diffuse + specular))
+  //       4. attenuation
+  //          a. spotlight & pointlight: see spec
+  //          b. directional light = no
+  //          c. Use formula from slides 'shading.ppt' page 20
+  //       5. spotlight cutoff: inner and outer from coefficients.x and coefficients.y
+  //       6. diffuse = kd * max(normal vector dot light direction, 0.0)
+  //       7. specular = ks * pow(max(normal vector dot halfway direction), 0.0), 8.0);
+  //       8. notice the difference of light direction & distance between directional light & point light
+  //       9. we've set ambient & color for you
+  FragColor = vec4( color* lighting, 1.0);
+  //FragColor = vec4(color, 1.0);
+}
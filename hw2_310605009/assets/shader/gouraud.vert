@@ -0,0 +1,50 @@
+#version 330 core
+layout(location = 0) in vec3 Position_in;
+layout(location = 1) in vec3 Normal_in;
+layout(location = 2) in vec2 TextureCoordinate_in;
+
+out vec2 TextureCoordinate;
+out vec3 rawPosition;
+
+out vec3 ambientVec;
+out vec3 specular;
+out vec3 diffuse;
+out float attenuation;
+out vec3 lighting;
+
+// The model, camera and light uniform blocks are generated from C++, see include/shader/blocks.h.
+#include "lighting.glsl"
+
+void main() {
+  TextureCoordinate = TextureCoordinate_in;
+  rawPosition = mat3(modelMatrix) * Position_in;
+  // TODO: vertex shader / fragment shader
+  // Hint:
+  //       1. how to write a vertex shader:
+  //          a. The output is gl_Position and anything you want to pass to the fragment shader. (Apply matrix multiplication yourself)
+  //       2. how to write a fragment shader:
+  //          a. The output is FragColor (any var is OK)
+  //       3. colors
+  //          a. For point light & directional light, lighting = ambient + attenuation * shadow * (diffuse + specular)
+  //          b. If you want to implement multiple light sources, you may want to use lighting = shadow * attenuation * (ambient + (diffuse + specular))
+  //       4. attenuation
+  //          a. spotlight & pointlight: see spec
+  //          b. directional light = no
+  //          c. Use formula from slides 'shading.ppt' page 20
+  //       5. spotlight cutoff: inner and outer from coefficients.x and coefficients.y
+  //       6. diffuse = kd * max(normal vector dot light direction, 0.0)
+  //       7. specular = ks * pow(max(normal vector dot halfway direction), 0.0), 8.0);
+  //       8. notice the difference of light direction & distance between directional light & point light
+  //       9. we've set ambient & color for you
+  vec4 worldposition = modelMatrix*vec4(Position_in,1.0);
+  vec3 fragToLight = getFragToLight(worldposition.xyz);
+  vec3 fragToView = normalize(worldposition.xyz-viewPosition.xyz);
+  vec3 N = normalize(mat3(normalMatrix) * Normal_in);
+  LightTerms terms = shade(fragToLight, N, fragToView);
+  ambientVec = terms.ambient;
+  diffuse = terms.diffuse;
+  specular = terms.specular;
+  attenuation = terms.attenuation;
+  lighting = combine(terms);
+  gl_Position = viewProjectionMatrix * modelMatrix * vec4(Position_in, 1.0);
+}
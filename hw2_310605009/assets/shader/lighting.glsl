@@ -0,0 +1,66 @@
+#pragma once
+// Lighting shared by Gouraud (per vertex) and Phong (per fragment) shading.
+// The camera and light uniform blocks are generated from C++, see include/shader/blocks.h.
+
+// Terms of one light, the color is ambient + attenuation * (diffuse + specular).
+struct LightTerms {
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+  float attenuation;
+};
+
+// The light is a point light unless SPOT_LIGHT or DIRECTIONAL_LIGHT is defined, see ProgramVariants.
+
+// Direction from the point to the light, the spotlight is at the camera.
+vec3 getFragToLight(vec3 worldPosition) {
+#if defined(DIRECTIONAL_LIGHT)
+  return normalize(lightVector.xyz);
+#elif defined(SPOT_LIGHT)
+  return -normalize(worldPosition - viewPosition.xyz);
+#else
+  return -normalize(worldPosition - lightVector.xyz);
+#endif
+}
+
+// Spotlight cutoff: inner and outer from coefficients.x and coefficients.y.
+LightTerms shade(vec3 fragToLight, vec3 N, vec3 fragToView) {
+  const float ambient = 0.1;
+  const float ks = 0.75;
+  const float kd = 0.75;
+  vec3 R = normalize(reflect(fragToLight, N));
+  float diff = kd * max(dot(N, fragToLight), 0.0);
+  float spec = ks * pow(max(dot(R, fragToView), 0.0), 8.0);
+
+  LightTerms terms;
+  terms.ambient = vec3(ambient);
+  terms.diffuse = vec3(diff);
+  terms.specular = vec3(spec * 0.75);
+#ifdef SPOT_LIGHT
+  float theta = dot(fragToLight, -lightVector.xyz);
+  float intensity = 0.0;
+  if (theta > coefficients.y) intensity = clamp((theta - coefficients.y) / (coefficients.x - coefficients.y), 0.0, 1.0);
+  if (theta > coefficients.x) intensity = 1.0;
+  terms.diffuse *= intensity;
+  terms.specular *= intensity;
+#endif
+
+#ifdef DIRECTIONAL_LIGHT
+  terms.attenuation = 0.65;
+#else
+  // Constant, linear and quadratic attenuation, from 'shading.ppt' page 20
+  float constant = 1.0;
+#ifdef SPOT_LIGHT
+  float linear = 0.014;
+  float quadratic = 0.007;
+#else
+  float linear = 0.027;
+  float quadratic = 0.0028;
+#endif
+  float distance = length(fragToLight);
+  terms.attenuation = 1.0 / (constant + linear * distance + quadratic * (distance * distance));
+#endif
+  return terms;
+}
+
+vec3 combine(LightTerms terms) { return terms.ambient + terms.attenuation * (terms.diffuse + terms.specular); }
@@ -0,0 +1,33 @@
+#version 330 core
+layout(location = 0) out vec4 FragColor;
+
+in vec2 TextureCoordinate;
+in vec3 rawPosition;
+in vec3 fragToLight;
+in vec4  worldposition;
+in vec3 fragToView;
+in vec3 N;
+// in vec3 R;
+
+in vec3 Position_in_new;
+in vec3 Normal_in_new;
+#ifdef CUBE_TEXTURE
+uniform samplerCube diffuseCubeTexture;
+#else
+uniform sampler2D diffuseTexture;
+#endif
+
+// The model, camera and light uniform blocks are generated from C++, see include/shader/blocks.h.
+#include "lighting.glsl"
+
+void main() {
+#ifdef CUBE_TEXTURE
+  vec3 color = texture(diffuseCubeTexture, rawPosition).rgb;
+#else
+  vec3 color = texture(diffuseTexture, TextureCoordinate).rgb;
+#endif
+
+  vec3 lighting = combine(shade(fragToLight, N, fragToView));
+  FragColor = vec4( color* lighting, 1.0);
+  //FragColor = vec4(color, 1.0);
+}
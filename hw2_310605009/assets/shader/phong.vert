@@ -0,0 +1,35 @@
+#version 330 core
+layout(location = 0) in vec3 Position_in;
+layout(location = 1) in vec3 Normal_in;
+layout(location = 2) in vec2 TextureCoordinate_in;
+
+out vec2 TextureCoordinate;
+out vec3 rawPosition;
+out vec3 fragToLight;
+out vec4  worldposition;
+out vec3 fragToView;
+out vec3 N;
+out vec3 R;
+
+
+out vec3 Position_in_new;
+out vec3 Normal_in_new;
+
+// The model, camera and light uniform blocks are generated from C++, see include/shader/blocks.h.
+#include "lighting.glsl"
+
+void main() {
+  TextureCoordinate = TextureCoordinate_in;
+  rawPosition = mat3(modelMatrix) * Position_in;
+  float ambient = 0.1;
+  float ks = 0.75;
+  float kd = 0.75;
+
+  
+   worldposition = modelMatrix*vec4(Position_in,1.0);
+  fragToLight = getFragToLight(worldposition.xyz);
+   fragToView = normalize(worldposition.xyz-viewPosition.xyz);
+   N = normalize(mat3(normalMatrix) * Normal_in);
+  // R = normalize(reflect(fragToLight,N)); 
+  gl_Position = viewProjectionMatrix * modelMatrix * vec4(Position_in, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+layout(location = 0) in vec3 Position_in;
+
+// The model and light uniform blocks are generated from C++, see include/shader/blocks.h.
+
+void main() {
+  gl_Position = lightSpaceMatrix * modelMatrix * vec4(Position_in, 1.0f);
+}
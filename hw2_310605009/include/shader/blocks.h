@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "shader/std140.h"
+
+namespace graphics::shader {
+/// Uniform block "model", one per mesh.
+struct ModelBlock {
+  // Model matrix
+  glm::mat4 modelMatrix;
+  // inverse(transpose(model)), precalculate using CPU for efficiency
+  glm::mat4 normalMatrix;
+};
+
+/// Uniform block "camera", one per camera.
+struct CameraBlock {
+  // Projection * View matrix
+  glm::mat4 viewProjectionMatrix;
+  // Position of the camera
+  glm::vec4 viewPosition;
+};
+
+/// Uniform block "light", one per light.
+struct LightBlock {
+  // Projection * View matrix
+  glm::mat4 lightSpaceMatrix;
+  // Position or direction of the light
+  glm::vec4 lightVector;
+  // inner cutoff, outer cutoff, isSpotlight, isDirectionalLight
+  glm::vec4 coefficients;
+};
+
+namespace std140 {
+template <>
+struct Layout<ModelBlock> {
+  static constexpr std::string_view name = "model";
+  static constexpr Member members[] = {STD140_MEMBER(ModelBlock, modelMatrix), STD140_MEMBER(ModelBlock, normalMatrix)};
+};
+
+template <>
+struct Layout<CameraBlock> {
+  static constexpr std::string_view name = "camera";
+  static constexpr Member members[] = {STD140_MEMBER(CameraBlock, viewProjectionMatrix),
+                                        STD140_MEMBER(CameraBlock, viewPosition)};
+};
+
+template <>
+struct Layout<LightBlock> {
+  static constexpr std::string_view name = "light";
+  static constexpr Member members[] = {STD140_MEMBER(LightBlock, lightSpaceMatrix),
+                                        STD140_MEMBER(LightBlock, lightVector),
+                                        STD140_MEMBER(LightBlock, coefficients)};
+};
+
+static_assert(verify<ModelBlock>() && verify<CameraBlock>() && verify<LightBlock>());
+}  // namespace std140
+}  // namespace graphics::shader
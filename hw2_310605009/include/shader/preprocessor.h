@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "utils.h"
+
+namespace graphics::shader {
+/// A shader file with its includes replaced by their contents.
+struct Expansion {
+  std::string code;
+  // FNV-1a 64 of code
+  uint64_t hash = 0;
+  // Every file read, the expanded file first. The index of a file is its source string number in #line directives.
+  std::vector<utils::fs::path> dependencies;
+};
+
+/**
+ * @brief Expands #include "file" and #include <file> lines of GLSL sources.
+ *
+ * Quoted names are looked up next to the including file first, then in the root; bracketed names only in the root.
+ * A file containing #pragma once is included at most once per expansion. #line directives around every include
+ * keep compile errors at the right line, with the file's index in dependencies as source string number. Include
+ * lines are expanded wherever they are, #if blocks and comments are not evaluated.
+ *
+ * Expansions are cached per file and reused while none of their dependencies was modified, so programs sharing
+ * a stage file do not read and expand it again.
+ */
+class Preprocessor {
+ public:
+  /// @brief Directory includes are resolved from.
+  static void setRoot(const utils::fs::path& path) { root = path; }
+  /// @return The expansion of file, valid until file is expanded again. Missing files are reported and left out.
+  static const Expansion& expand(const utils::fs::path& file);
+
+ private:
+  struct Entry {
+    Expansion expansion;
+    // Write times of the dependencies when they were read
+    std::vector<utils::fs::file_time_type> writeTimes;
+  };
+  /// @brief Append file to entry, stack holds the chain of files including it.
+  static void append(const utils::fs::path& file,
+                     Entry& entry,
+                     std::vector<utils::fs::path>& stack,
+                     std::vector<utils::fs::path>& included);
+  static utils::fs::path resolve(const std::string& name, bool isQuoted, const utils::fs::path& includer);
+
+  static utils::fs::path root;
+  static std::map<utils::fs::path, Entry> cache;
+};
+}  // namespace graphics::shader
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "std140.h"
+#include "utils.h"
+namespace graphics::shader {
+/// @brief FNV-1a of a uniform or block name, array uniforms are stored without their "[0]".
+constexpr uint32_t hashUniformName(std::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  return hash;
+}
+
+/// Uniform or block name hashed at compile time, string literals convert implicitly.
+struct UniformName {
+  CONSTEVAL UniformName(const char* name) : hash(hashUniformName(name)) {}
+  /// @brief Hash a name only known at run time.
+  static constexpr UniformName fromString(std::string_view name) { return UniformName(hashUniformName(name), 0); }
+  uint32_t hash;
+
+ private:
+  constexpr UniformName(uint32_t _hash, int) : hash(_hash) {}
+};
+
+/// One entry of ShaderProgram::setUniforms, a location with an int, float, vector or 4x4 matrix value.
+struct UniformValue {
+  UniformValue(GLint _location, GLint i) : location(_location), type(GL_INT) { value.i = i; }
+  UniformValue(GLint _location, GLfloat f) : location(_location), type(GL_FLOAT) { value.f[0] = f; }
+  UniformValue(GLint _location, const glm::vec2& v) : location(_location), type(GL_FLOAT_VEC2) { set(&v.x, 2); }
+  UniformValue(GLint _location, const glm::vec3& v) : location(_location), type(GL_FLOAT_VEC3) { set(&v.x, 3); }
+  UniformValue(GLint _location, const glm::vec4& v) : location(_location), type(GL_FLOAT_VEC4) { set(&v.x, 4); }
+  UniformValue(GLint _location, const glm::mat4& m) : location(_location), type(GL_FLOAT_MAT4) { set(&m[0][0], 16); }
+
+  GLint location;
+  GLenum type;
+  union {
+    GLint i;
+    GLfloat f[16];
+  } value;
+
+ private:
+  void set(const GLfloat* data, int count) {
+    for (int k = 0; k < count; ++k) value.f[k] = data[k];
+  }
+};
+
+class ShaderProgram final {
+ public:
+  MOVE_ONLY(ShaderProgram)
+  ShaderProgram() noexcept;
+  ~ShaderProgram();
+  void attach(Shader* shader);
+  template <class... Shaders>
+  void attach(Shader* shader, Shaders... shaders) {
+    attach(shader);
+    attach(std::forward<Shaders>(shaders)...);
+  }
+  void detach(Shader* shader);
+  template <class... Shaders>
+  void detach(Shader* shader, Shaders... shaders) {
+    detach(shader);
+    detach(std::forward<Shaders>(shaders)...);
+  }
+
+  /// @brief Link, then reflect the active uniforms and uniform blocks into the lookup tables.
+  void link();
+  bool checkLinkState() const;
+
+  GLuint getHandle() const;
+  void use() const;
+
+  /**
+   * @brief Location of an active uniform found at link time, -1 if there is none (setters ignore -1).
+   *
+   * A binary search without GL calls or allocation, hot paths should still keep the location, it stays valid until
+   * the next link.
+   */
+  GLint getUniformLocation(UniformName name) const;
+  GLuint getUniformBlockIndex(UniformName name) const;
+  void uniformBlockBinding(UniformName name, GLuint binding) const;
+  void uniformBlockBinding(GLuint index, GLuint binding) const;
+  /**
+   * @brief Compare the layout the program linked block T with against std140::Layout<T>, report any difference.
+   *
+   * @return False if an offset differs or the block is larger than T, true also when the program lacks the block.
+   */
+  template <class T>
+  bool checkUniformBlock() const {
+    static_assert(std140::verify<T>());
+    using Layout = std140::Layout<T>;
+    return checkUniformBlock(Layout::name, sizeof(T), std::data(Layout::members), std::size(Layout::members));
+  }
+  bool checkUniformBlock(std::string_view name, GLint size, const std140::Member* members, std::size_t count) const;
+  /// @brief Use the program and set several uniforms, glProgramUniform* may be missing on 3.3 / 4.0 contexts.
+  void setUniforms(std::initializer_list<UniformValue> values) const;
+  void setUniform(UniformName name, GLint i1);
+  void setUniform(GLint location, GLint i1);
+
+ private:
+  static GLuint currentBinding;
+  struct Uniform {
+    uint32_t hash;
+    GLint location;
+    GLenum type;
+    GLint arraySize;
+  };
+  struct UniformBlock {
+    uint32_t hash;
+    GLuint index;
+    GLint dataSize;
+  };
+  /// @brief Fill the uniform and block tables from the linked program.
+  void reflect();
+
+  bool isLinked;
+  GLuint handle;
+  // Sorted by hash, searched by getUniformLocation / getUniformBlockIndex
+  std::vector<Uniform> uniforms;
+  std::vector<UniformBlock> uniformBlocks;
+};
+}  // namespace graphics::shader
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+namespace graphics::shader::std140 {
+/**
+ * @brief GLSL name and std140 base alignment of a C++ member type.
+ *
+ * Only types whose C++ size matches their std140 size are described. glm::mat3 (three vec4 columns in std140) and
+ * arrays of scalars (16 byte stride) are left out on purpose, use vec4 / mat4 instead.
+ */
+template <class T>
+struct Type {
+  static_assert(sizeof(T) == 0, "Type has no std140 equivalent with the same C++ layout");
+};
+
+template <std::size_t Alignment>
+struct TypeInfo {
+  static constexpr std::size_t alignment = Alignment;
+  static constexpr std::size_t arraySize = 0;
+};
+
+template <>
+struct Type<GLfloat> : TypeInfo<4> { static constexpr std::string_view name = "float"; };
+template <>
+struct Type<GLint> : TypeInfo<4> { static constexpr std::string_view name = "int"; };
+template <>
+struct Type<GLuint> : TypeInfo<4> { static constexpr std::string_view name = "uint"; };
+template <>
+struct Type<glm::vec2> : TypeInfo<8> { static constexpr std::string_view name = "vec2"; };
+// Needs alignas(16) in C++, a scalar may follow it in the same 16 bytes.
+template <>
+struct Type<glm::vec3> : TypeInfo<16> { static constexpr std::string_view name = "vec3"; };
+template <>
+struct Type<glm::vec4> : TypeInfo<16> { static constexpr std::string_view name = "vec4"; };
+template <>
+struct Type<glm::ivec4> : TypeInfo<16> { static constexpr std::string_view name = "ivec4"; };
+template <>
+struct Type<glm::uvec4> : TypeInfo<16> { static constexpr std::string_view name = "uvec4"; };
+template <>
+struct Type<glm::mat4> : TypeInfo<16> { static constexpr std::string_view name = "mat4"; };
+
+template <class T, std::size_t N>
+struct Type<T[N]> {
+  static_assert(sizeof(T) % 16 == 0, "std140 array elements are padded to 16 bytes, use vec4 / mat4 elements");
+  static constexpr std::string_view name = Type<T>::name;
+  static constexpr std::size_t alignment = 16;
+  static constexpr std::size_t arraySize = N;
+};
+
+/// One member of a block, built by STD140_MEMBER.
+struct Member {
+  std::string_view name;
+  std::string_view type;
+  std::size_t offset;
+  std::size_t size;
+  std::size_t alignment;
+  std::size_t arraySize;
+};
+
+template <class T>
+constexpr Member member(std::string_view name, std::size_t offset) {
+  return Member{name, Type<T>::name, offset, sizeof(T), Type<T>::alignment, Type<T>::arraySize};
+}
+
+/**
+ * @brief Describes a C++ struct as a std140 uniform block, specialize it next to the struct:
+ *
+ *   template <> struct Layout<CameraBlock> {
+ *     static constexpr std::string_view name = "camera";
+ *     static constexpr Member members[] = {STD140_MEMBER(CameraBlock, viewProjectionMatrix), ...};
+ *   };
+ *
+ * Members are listed in declaration order, GLSL uses the same names.
+ */
+template <class T>
+struct Layout;
+
+#define STD140_MEMBER(Block, member_name) \
+  ::graphics::shader::std140::member<decltype(Block::member_name)>(#member_name, offsetof(Block, member_name))
+
+/// @brief Round offset up to a multiple of alignment.
+constexpr std::size_t alignUp(std::size_t offset, std::size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Check the C++ offsets of T against the std140 rules, fails to compile with the reason otherwise.
+ *
+ * Use as static_assert(std140::verify<T>()), every other function here does.
+ */
+template <class T>
+constexpr bool verify() {
+  std::size_t end = 0;
+  for (const Member& m : Layout<T>::members) {
+    if (m.offset != alignUp(end, m.alignment))
+      throw std::logic_error("Member is not at its std140 offset, reorder members or add alignas(16)");
+    end = m.offset + m.size;
+  }
+  if (sizeof(T) != alignUp(end, 16)) throw std::logic_error("Block size is not the std140 size, is a member missing?");
+  return true;
+}
+
+/// @brief GLSL declaration of the block, "layout (std140) uniform name { ... };".
+template <class T>
+std::string declaration() {
+  static_assert(verify<T>());
+  std::string glsl = "layout (std140) uniform ";
+  glsl.append(Layout<T>::name).append(" {\n");
+  for (const Member& m : Layout<T>::members) {
+    glsl.append("  ").append(m.type).append(" ").append(m.name);
+    if (m.arraySize != 0) glsl.append("[").append(std::to_string(m.arraySize)).append("]");
+    glsl.append(";\n");
+  }
+  return glsl.append("};\n");
+}
+
+/// @brief Declarations of several blocks, meant as a shader preamble.
+template <class... Blocks>
+std::string declarations() {
+  return (declaration<Blocks>() + ...);
+}
+}  // namespace graphics::shader::std140
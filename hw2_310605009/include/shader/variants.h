@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader/program.h"
+#include "utils.h"
+namespace graphics::shader {
+/**
+ * @brief Permutations of one vertex / fragment shader pair, selected by feature bits.
+ *
+ * Bit i of a key defines features[i] (as 1) in both stages, so shaders test features with #ifdef instead of
+ * branching on uniforms. Variants are compiled and linked on first use and kept, their addresses stay valid for the
+ * lifetime of the table.
+ */
+class ProgramVariants {
+ public:
+  using Key = uint32_t;
+  static constexpr std::size_t maxFeatures = 32;
+
+  DELETE_COPY(ProgramVariants)
+  DELETE_MOVE(ProgramVariants)
+  /**
+   * @brief Variants are compiled from the files as they are when the variant is built.
+   *
+   * @param preamble Code every variant gets after the defines, e.g. generated block declarations.
+   */
+  ProgramVariants(const utils::fs::path& vertexFile,
+                  const utils::fs::path& fragmentFile,
+                  std::vector<std::string> features,
+                  std::string preamble = {});
+  /// @brief Run on every newly linked variant, for block bindings, sampler units and other constant uniforms.
+  void setInitializer(std::function<void(ShaderProgram&)> _initializer) { initializer = std::move(_initializer); }
+  /// @return The variant with the features of key, compiled and initialized on the first call.
+  ShaderProgram& get(Key key);
+  /// @return Defines of the features in key, one "#define NAME 1" line each.
+  std::string getDefines(Key key) const;
+  std::size_t getCompiledCount() const { return variants.size(); }
+
+ private:
+  /// @brief Key without bits past the last feature, which would build the same program again.
+  Key mask(Key key) const;
+
+  utils::fs::path vertexFile;
+  utils::fs::path fragmentFile;
+  std::vector<std::string> features;
+  std::string preamble;
+  std::function<void(ShaderProgram&)> initializer;
+  std::unordered_map<Key, std::unique_ptr<ShaderProgram>> variants;
+};
+}  // namespace graphics::shader
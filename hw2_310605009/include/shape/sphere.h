@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "buffer/buffer.h"
+#include "buffer/vertexarray.h"
+#include "shape.h"
+
+namespace graphics::shape {
+class Sphere final : public Shape {
+ public:
+  Sphere();
+  Sphere(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices);
+  void draw() const override;
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Sphere"; }
+  CONSTEXPR_VIRTUAL ShapeType getType() const override { return ShapeType::Sphere; }
+  template <typename... Args>
+  static std::unique_ptr<Sphere> make_unique(Args&&... args) {
+    return std::make_unique<Sphere>(std::forward<Args>(args)...);
+  }
+  static void generateVertices(std::vector<GLfloat>& vertex,
+                               std::vector<GLuint>& index,
+                               int stack = 18,
+                               int slice = 36);
+  /**
+   * @brief Generate the sphere into caller-provided storage, using the SIMD path when available.
+   *
+   * @param vertex At least getVertexCount(stack, slice) * vertexStride floats.
+   * @param index At least getIndexCount(stack, slice) indices.
+   */
+  static void generateVertices(GLfloat* vertex, GLuint* index, int stack = 18, int slice = 36);
+  /// @return Number of vertices of a sphere with given stack and slice.
+  static constexpr std::size_t getVertexCount(int stack, int slice) {
+    return static_cast<std::size_t>(stack + 1) * (slice + 1);
+  }
+  /// @return Number of indices of a sphere with given stack and slice, pole rows have one triangle per sector.
+  static constexpr std::size_t getIndexCount(int stack, int slice) {
+    return stack > 1 ? static_cast<std::size_t>(stack - 1) * slice * 6 : 0;
+  }
+  /// Floats per vertex.
+  static constexpr int vertexStride = 8;
+
+ private:
+  std::shared_ptr<buffer::VertexArray> vao;
+  std::shared_ptr<buffer::ArrayBuffer> vbo;
+  std::shared_ptr<buffer::ElementArrayBuffer> ebo;
+
+  static std::weak_ptr<buffer::VertexArray> vao_weak;
+  static std::weak_ptr<buffer::ArrayBuffer> vbo_weak;
+  static std::weak_ptr<buffer::ElementArrayBuffer> ebo_weak;
+};
+using SpherePTR = std::unique_ptr<Sphere>;
+};  // namespace graphics::shape
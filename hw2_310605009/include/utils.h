@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __APPLE__
+#ifndef HAS_CXX20_SUPPORT
+#define HAS_CXX20_SUPPORT 0
+#endif
+#endif
+
+#ifndef DELETE_COPY
+#define DELETE_COPY(ClassName)           \
+  ClassName(const ClassName &) = delete; \
+  ClassName &operator=(const ClassName &) = delete;
+#endif
+
+#ifndef DEFAULT_COPY
+#define DEFAULT_COPY(ClassName)           \
+  ClassName(const ClassName &) = default; \
+  ClassName &operator=(const ClassName &) = default;
+#endif
+
+#ifndef DELETE_MOVE
+#define DELETE_MOVE(ClassName)      \
+  ClassName(ClassName &&) = delete; \
+  ClassName &operator=(ClassName &&) = delete;
+#endif
+
+#ifndef DEFAULT_MOVE
+#define DEFAULT_MOVE(ClassName)      \
+  ClassName(ClassName &&) = default; \
+  ClassName &operator=(ClassName &&) = default;
+#endif
+
+#ifndef MOVE_ONLY
+#define MOVE_ONLY(ClassName) \
+  DELETE_COPY(ClassName)     \
+  DEFAULT_MOVE(ClassName)
+#endif
+
+#ifndef THROW_EXCEPTION
+#define THROW_EXCEPTION(ExceptionType, message)                                                                      \
+  do {                                                                                                               \
+    throw ExceptionType(std::string("[") + __FILE__ + ":" + std::to_string(__LINE__) + "] " + std::string(message)); \
+  } while (false)
+#endif
+
+#ifndef HAS_CXX20_SUPPORT
+#if __cplusplus >= 202002L
+#define HAS_CXX20_SUPPORT 1
+#include <bit>
+#else
+#define HAS_CXX20_SUPPORT 0
+#endif  // __cplusplus >= 202002L
+#endif  // HAS_CXX20_SUPPORT
+
+// Some useful C++ 20 feature
+#ifndef CONSTEXPR_VIRTUAL
+#if HAS_CXX20_SUPPORT
+#define CONSTEXPR_VIRTUAL constexpr
+#else
+#define CONSTEXPR_VIRTUAL
+#endif  // HAS_CXX20_SUPPORT
+#endif  // CONSTEXPR_VIRTUAL
+
+#ifndef CONSTEVAL
+#if HAS_CXX20_SUPPORT
+#define CONSTEVAL consteval
+#else
+#define CONSTEVAL constexpr
+#endif  // HAS_CXX20_SUPPORT
+#endif  // CONSTEVAL
+// Some useful functions
+namespace utils {
+namespace fs = std::filesystem;
+#if HAS_CXX20_SUPPORT
+constexpr inline uint32_t log2(uint32_t n) { return std::bit_width(n) - 1; }
+#else
+constexpr inline uint32_t log2(uint32_t n) { return (n > 0) ? 1 + log2(n >> 1) : 0; }
+#endif  // HAS_CXX20_SUPPORT
+
+/**
+ * @brief Split [0, count) into contiguous ranges and run function(begin, end) on each of them in parallel.
+ *
+ * @param count Total number of work items.
+ * @param minPerThread Minimal items for a worker, small jobs stay on the calling thread.
+ * @param function Callable with signature void(int begin, int end), ranges never overlap.
+ */
+template <typename Function>
+void parallelFor(int count, int minPerThread, Function&& function) {
+  int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  int threadCount = std::min(hardwareThreads, count / std::max(1, minPerThread));
+  if (threadCount <= 1) {
+    function(0, count);
+    return;
+  }
+  int chunk = (count + threadCount - 1) / threadCount;
+  std::vector<std::thread> workers;
+  workers.reserve(threadCount - 1);
+  for (int begin = chunk; begin < count; begin += chunk) {
+    int end = std::min(count, begin + chunk);
+    workers.emplace_back([&function, begin, end] { function(begin, end); });
+  }
+  function(0, chunk);
+  for (auto& worker : workers) worker.join();
+}
+}  // namespace utils
@@ -17,6 +17,9 @@
 #include <stb_image.h>
 #undef STB_IMAGE_IMPLEMENTATION
 #include "graphics.h"
+#include "shader/blocks.h"
+#include "shader/preprocessor.h"
+#include "shader/variants.h"
 
 // Unnamed namespace for global variables
 namespace {
@@ -34,6 +37,10 @@ constexpr int LIGHT_COUNT = 3;
 constexpr int CAMERA_COUNT = 1;
 constexpr int MESH_COUNT = 3;
 constexpr int SHADER_PROGRAM_COUNT = 3;
+// Feature bits of the Phong and Gouraud variants, in the order of their defines
+constexpr graphics::shader::ProgramVariants::Key spotLightBit = 1 << 0;
+constexpr graphics::shader::ProgramVariants::Key directionalLightBit = 1 << 1;
+constexpr graphics::shader::ProgramVariants::Key cubeTextureBit = 1 << 2;
 }  // namespace
 
 int uboAlign(int i) { return ((i + 1 * (alignSize - 1)) / alignSize) * alignSize; }
@@ -100,17 +107,17 @@ int main() {
   OpenGLContext::enableDebugCallback();
 #endif
   // Initialize shader
-  std::vector<graphics::shader::ShaderProgram> shaderPrograms(SHADER_PROGRAM_COUNT);
   std::string filenames[SHADER_PROGRAM_COUNT] = {"shadow", "phong", "gouraud"};
-  for (int i = 0; i < SHADER_PROGRAM_COUNT; ++i) {
-    graphics::shader::VertexShader vs;
-    graphics::shader::FragmentShader fs;
-    vs.fromFile("../assets/shader/" + filenames[i] + ".vert");
-    fs.fromFile("../assets/shader/" + filenames[i] + ".frag");
-    shaderPrograms[i].attach(&vs, &fs);
-    shaderPrograms[i].link();
-    shaderPrograms[i].detach(&vs, &fs);
-    shaderPrograms[i].use();
+  // Uniform blocks are declared from their C++ structs, not in the shader files.
+  using graphics::shader::CameraBlock, graphics::shader::LightBlock, graphics::shader::ModelBlock;
+  const std::string blocks = graphics::shader::std140::declarations<ModelBlock, CameraBlock, LightBlock>();
+  // Shared GLSL, e.g. the lighting of the Phong and Gouraud shaders, is included from the shader directory.
+  graphics::shader::Preprocessor::setRoot("../assets/shader");
+  auto initializeProgram = [](graphics::shader::ShaderProgram& program, const std::string& filename) {
+    if (!program.checkUniformBlock<ModelBlock>() || !program.checkUniformBlock<CameraBlock>() ||
+        !program.checkUniformBlock<LightBlock>())
+      THROW_EXCEPTION(std::runtime_error, "Uniform block layout of " + filename + " differs from C++");
+    program.use();
     // TODO: bind the uniform variables
     // Hint:
     //       1. you can set other uniforms you want in this for-loop
@@ -128,22 +135,46 @@ int main() {
     //        https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glGetUniformBlockIndex.xhtml
     //       5. Check uniformBlockBinding and setUniform member function of ShaderProgram class
     //       We only set some variables here, you need more when you're lighting
-    shaderPrograms[i].uniformBlockBinding("model", 0);
-    shaderPrograms[i].uniformBlockBinding("camera", 1);
-    shaderPrograms[i].uniformBlockBinding("light", 2);
+    program.uniformBlockBinding("model", 0);
+    program.uniformBlockBinding("camera", 1);
+    program.uniformBlockBinding("light", 2);
     // Maybe light here or other uniform you set :)
 
-    shaderPrograms[i].setUniform("diffuseTexture", 0);
-    shaderPrograms[i].setUniform("shadowMap", 1);
-    shaderPrograms[i].setUniform("diffuseCubeTexture", 2);
-    shaderPrograms[i].setUniform("isCube", 0);
+    program.setUniform("diffuseTexture", 0);
+    program.setUniform("shadowMap", 1);
+    program.setUniform("diffuseCubeTexture", 2);
+  };
+  graphics::shader::ShaderProgram shadowProgram;
+  {
+    graphics::shader::VertexShader vs;
+    graphics::shader::FragmentShader fs;
+    vs.fromFile("../assets/shader/" + filenames[0] + ".vert", blocks);
+    fs.fromFile("../assets/shader/" + filenames[0] + ".frag", blocks);
+    shadowProgram.attach(&vs, &fs);
+    shadowProgram.link();
+    shadowProgram.detach(&vs, &fs);
+    initializeProgram(shadowProgram, filenames[0]);
+  }
+  // Phong and Gouraud shading test the light type and the kind of diffuse texture with #ifdef, a program each.
+  const std::vector<std::string> lightingFeatures = {"SPOT_LIGHT", "DIRECTIONAL_LIGHT", "CUBE_TEXTURE"};
+  graphics::shader::ProgramVariants phongVariants("../assets/shader/phong.vert", "../assets/shader/phong.frag",
+                                                  lightingFeatures, blocks);
+  graphics::shader::ProgramVariants gouraudVariants("../assets/shader/gouraud.vert",
+                                                    "../assets/shader/gouraud.frag", lightingFeatures, blocks);
+  graphics::shader::ProgramVariants* lightingVariants[SHADER_PROGRAM_COUNT] = {nullptr, &phongVariants,
+                                                                              &gouraudVariants};
+  for (int i = 1; i < SHADER_PROGRAM_COUNT; ++i) {
+    lightingVariants[i]->setInitializer(
+        [&initializeProgram, &filename = filenames[i]](graphics::shader::ShaderProgram& program) {
+          initializeProgram(program, filename);
+        });
   }
   graphics::buffer::UniformBuffer meshUBO, cameraUBO, lightUBO;
   // Calculate UBO alignment size
   glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignSize);
-  constexpr int perMeshSize = 2 * sizeof(glm::mat4);
-  constexpr int perCameraSize = sizeof(glm::mat4) + sizeof(glm::vec4);
-  constexpr int perLightSize = sizeof(glm::mat4) + 2 * sizeof(glm::vec4);
+  constexpr int perMeshSize = sizeof(ModelBlock);
+  constexpr int perCameraSize = sizeof(CameraBlock);
+  constexpr int perLightSize = sizeof(LightBlock);
   int perMeshOffset = uboAlign(perMeshSize);
   int perCameraOffset = uboAlign(perCameraSize);
   int perLightOffset = uboAlign(perLightSize);
@@ -173,8 +204,8 @@ int main() {
   for (int i = 0; i < CAMERA_COUNT; ++i) {
     int offset = i * perCameraOffset;
     cameras[i]->initialize(OpenGLContext::getAspectRatio());
-    cameraUBO.load(offset, sizeof(glm::mat4), cameras[i]->getViewProjectionMatrixPTR());
-    cameraUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), cameras[i]->getPositionPTR());
+    CameraBlock block{cameras[i]->getViewProjectionMatrix(), cameras[i]->getPosition()};
+    cameraUBO.load(offset, sizeof(block), &block);
   }
   currentCamera = cameras[0].get();
   // Lights
@@ -186,17 +217,13 @@ int main() {
   assert(lights.size() == LIGHT_COUNT);
   // TODO: Bind light object's buffer
   // Hint: look what we did when binding other UBO
+  // Whole light block in one load, the spotlight points where the camera looks.
+  auto loadLight = [&lightUBO, &lights, perLightOffset](int i, const glm::vec4& lightVector) {
+    LightBlock block{lights[i]->getLightSpaceMatrix(), lightVector, lights[i]->getLightCoefficients()};
+    lightUBO.load(i * perLightOffset, sizeof(block), &block);
+  };
   for (int i = 0; i < LIGHT_COUNT; ++i) {
-    int offset = i * perLightOffset;
-    glm::vec4 front = currentCamera->getFront();
-    lightUBO.load(offset, sizeof(glm::mat4), lights[i]->getLightSpaceMatrixPTR());
-    //lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(front));
-    if (i != 2) {
-      lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), lights[i]->getLightVectorPTR());
-    } else {
-      lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(front));  
-    }
-    lightUBO.load(offset + sizeof(glm::mat4) + sizeof(glm::vec4), sizeof(glm::vec4),lights[i]->getLightCoefficientsPTR());
+    loadLight(i, i != 2 ? lights[i]->getLightVector() : currentCamera->getFront());
   }
   // Texture
   graphics::texture::ShadowMap shadow(maxTextureSize);
@@ -248,12 +275,17 @@ int main() {
   assert(meshes.size() == MESH_COUNT);
   assert(diffuseTextures.size() == MESH_COUNT);
   for (int i = 0; i < MESH_COUNT; ++i) {
-    int offset = i * perMeshOffset;
-    meshUBO.load(offset, sizeof(glm::mat4), meshes[i]->getModelMatrixPTR());
-    meshUBO.load(offset + sizeof(glm::mat4), sizeof(glm::mat4), meshes[i]->getNormalMatrixPTR());
+    ModelBlock block{meshes[i]->getModelMatrix(), meshes[i]->getNormalMatrix()};
+    meshUBO.load(i * perMeshOffset, sizeof(block), &block);
   }
   shadow.bind(1);
   dice.bind(2);
+  // Cubes sample the cube map
+  graphics::shader::ProgramVariants::Key meshFeatures[MESH_COUNT];
+  for (int i = 0; i < MESH_COUNT; ++i)
+    meshFeatures[i] = meshes[i]->getType() == graphics::shape::ShapeType::Cube ? cubeTextureBit : 0;
+  // Of the current light, set when it changes
+  graphics::shader::ProgramVariants::Key lightFeatures = 0;
   // Main rendering loop
   while (!glfwWindowShouldClose(window)) {
     // Polling events.
@@ -262,14 +294,11 @@ int main() {
     bool isCameraMove = currentCamera->move(window);
     if (isCameraMove || isWindowSizeChanged) {
       isWindowSizeChanged = false;
-      cameraUBO.load(0, sizeof(glm::mat4), currentCamera->getViewProjectionMatrixPTR());
-      cameraUBO.load(sizeof(glm::mat4), sizeof(glm::vec4), currentCamera->getPositionPTR());
+      CameraBlock block{currentCamera->getViewProjectionMatrix(), currentCamera->getPosition()};
+      cameraUBO.load(0, sizeof(block), &block);
       if (lights[currentLight]->getType() == graphics::light::LightType::Spot) {
         lights[currentLight]->update(currentCamera->getViewMatrix());
-        int offset = currentLight * perLightOffset;
-        glm::vec4 front = currentCamera->getFront();
-        lightUBO.load(offset, sizeof(glm::mat4), lights[currentLight]->getLightSpaceMatrixPTR());
-        lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(front));
+        loadLight(currentLight, currentCamera->getFront());
       }
     }
 
@@ -283,15 +312,14 @@ int main() {
       // Note: You can do this by a single line of lightUBO.bindUniformBlockIndex call
       if (lights[currentLight]->getType() == graphics::light::LightType::Spot) {
         lights[currentLight]->update(currentCamera->getViewMatrix());
-        glm::vec4 front = currentCamera->getFront();
-        lightUBO.load(offset, sizeof(glm::mat4), lights[currentLight]->getLightSpaceMatrixPTR());
-        //lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), glm::value_ptr(front));
-        lightUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), lights[currentLight]->getLightVectorPTR());
-        lightUBO.load(offset + sizeof(glm::mat4) + sizeof(glm::vec4), sizeof(glm::vec4),
-                      lights[currentLight]->getLightCoefficientsPTR());
-        
+        loadLight(currentLight, lights[currentLight]->getLightVector());
       }
        lightUBO.bindUniformBlockIndex(2,offset, perLightSize);
+      switch (lights[currentLight]->getType()) {
+        case graphics::light::LightType::Spot: lightFeatures = spotLightBit; break;
+        case graphics::light::LightType::Directional: lightFeatures = directionalLightBit; break;
+        default: lightFeatures = 0; break;
+      }
       isLightChanged = false;
     }
     // TODO (If you want to implement shadow): Render shadow to texture first
@@ -306,14 +334,9 @@ int main() {
     // GL_XXX_BIT can simply "OR" together to use.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     // Render all objects
-    shaderPrograms[currentShader].use();
     for (int i = 0; i < MESH_COUNT; ++i) {
-      // Change uniform if it is a cube (We want to use cubemap texture)
-      if (meshes[i]->getType() == graphics::shape::ShapeType::Cube) {
-        shaderPrograms[currentShader].setUniform("isCube", 1);
-      } else {
-        shaderPrograms[currentShader].setUniform("isCube", 0);
-      }
+      // Variant of the current shading for the light and the mesh's texture, built on first use
+      lightingVariants[currentShader]->get(lightFeatures | meshFeatures[i]).use();
       // Bind current object's model matrix
       meshUBO.bindUniformBlockIndex(0, i * perMeshOffset, perMeshSize);
       // Bind current object's texture
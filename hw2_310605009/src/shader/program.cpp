@@ -1,7 +1,45 @@
 #include "shader/program.h"
 
+#include <algorithm>
+#include <string>
+
 #include <glm/gtc/type_ptr.hpp>
 
+namespace {
+/// @brief Binary search of a table sorted by hash, nullptr if not found.
+template <class T>
+const T* findByHash(const std::vector<T>& table, uint32_t hash) {
+  auto it = std::lower_bound(table.begin(), table.end(), hash, [](const T& entry, uint32_t value) {
+    return entry.hash < value;
+  });
+  return it != table.end() && it->hash == hash ? &*it : nullptr;
+}
+
+/// @brief Sort a table by hash, warning about names that hash alike (the later one is unreachable by name).
+template <class T>
+void sortByHash(std::vector<T>& table, const std::vector<std::string>& names) {
+  std::vector<uint32_t> order(table.size());
+  for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return table[a].hash < table[b].hash; });
+  std::vector<T> sorted;
+  sorted.reserve(table.size());
+  for (uint32_t i : order) {
+    if (!sorted.empty() && sorted.back().hash == table[i].hash) {
+      const std::string message = "Uniform name hash collision, " + names[i] + " is only reachable by location";
+      if (glDebugMessageInsert) {
+        glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                             message.c_str());
+      } else {
+        puts(message.c_str());
+      }
+      continue;
+    }
+    sorted.push_back(table[i]);
+  }
+  table.swap(sorted);
+}
+}  // namespace
+
 namespace graphics::shader {
 GLuint ShaderProgram::currentBinding = 0;
 
@@ -15,6 +53,50 @@ void ShaderProgram::detach(Shader* shader) { glDetachShader(handle, shader->getH
 void ShaderProgram::link() {
   glLinkProgram(handle);
   isLinked = checkLinkState();
+  uniforms.clear();
+  uniformBlocks.clear();
+  if (isLinked) reflect();
+}
+
+void ShaderProgram::reflect() {
+  // glGetProgramResourceiv needs 4.3, these queries work on the 3.3 fallback context too.
+  GLint uniformCount = 0, blockCount = 0, uniformNameLength = 0, blockNameLength = 0;
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &uniformCount);
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &uniformNameLength);
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &blockNameLength);
+  std::string name(std::max(uniformNameLength, blockNameLength), '\0');
+  std::vector<std::string> names;
+
+  for (GLint i = 0; i < uniformCount; ++i) {
+    GLuint uniformIndex = i;
+    GLint blockIndex = -1;
+    glGetActiveUniformsiv(handle, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+    // Block members have no location, they are set through buffers.
+    if (blockIndex != -1) continue;
+    GLsizei length = 0;
+    GLint arraySize = 0;
+    GLenum type = GL_NONE;
+    glGetActiveUniform(handle, i, static_cast<GLsizei>(name.size()), &length, &arraySize, &type, name.data());
+    GLint location = glGetUniformLocation(handle, name.c_str());
+    std::string_view view(name.data(), length);
+    if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") view.remove_suffix(3);
+    uniforms.push_back(Uniform{hashUniformName(view), location, type, arraySize});
+    names.emplace_back(view);
+  }
+  sortByHash(uniforms, names);
+
+  names.clear();
+  for (GLint i = 0; i < blockCount; ++i) {
+    GLint dataSize = 0;
+    glGetActiveUniformBlockiv(handle, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+    GLsizei length = 0;
+    glGetActiveUniformBlockName(handle, i, static_cast<GLsizei>(name.size()), &length, name.data());
+    std::string_view view(name.data(), length);
+    uniformBlocks.push_back(UniformBlock{hashUniformName(view), static_cast<GLuint>(i), dataSize});
+    names.emplace_back(view);
+  }
+  sortByHash(uniformBlocks, names);
 }
 
 bool ShaderProgram::checkLinkState() const {
@@ -44,25 +126,17 @@ void ShaderProgram::use() const {
   }
 }
 
-GLint ShaderProgram::getUniformLocation(const char* name) const {
-  // Cache the location since glGetUniformLocation calls are expensive
-  auto it = uniforms.find(name);
-  if (it != uniforms.end()) return it->second;
-  GLint location = glGetUniformLocation(handle, name);
-  uniforms.insert(std::make_pair(std::string(name), location));
-  return location;
+GLint ShaderProgram::getUniformLocation(UniformName name) const {
+  const Uniform* uniform = findByHash(uniforms, name.hash);
+  return uniform ? uniform->location : -1;
 }
 
-GLuint ShaderProgram::getUniformBlockIndex(const char* name) const {
-  // Cache the location since glGetUniformBlockIndex calls are expensive
-  auto it = uniformBlocks.find(name);
-  if (it != uniformBlocks.end()) return it->second;
-  GLint location = glGetUniformBlockIndex(handle, name);
-  uniformBlocks.insert(std::make_pair(std::string(name), location));
-  return location;
+GLuint ShaderProgram::getUniformBlockIndex(UniformName name) const {
+  const UniformBlock* block = findByHash(uniformBlocks, name.hash);
+  return block ? block->index : GL_INVALID_INDEX;
 }
 
-void ShaderProgram::uniformBlockBinding(const char* name, GLuint uniformBlockBinding) const {
+void ShaderProgram::uniformBlockBinding(UniformName name, GLuint uniformBlockBinding) const {
   GLuint blockindex = getUniformBlockIndex(name);
   if (blockindex != GL_INVALID_INDEX) glUniformBlockBinding(handle, blockindex, uniformBlockBinding);
 }
@@ -70,6 +144,64 @@ void ShaderProgram::uniformBlockBinding(const char* name, GLuint uniformBlockBin
 void ShaderProgram::uniformBlockBinding(GLuint uniformBlockIndex, GLuint uniformBlockBinding) const {
   if (uniformBlockIndex != GL_INVALID_INDEX) glUniformBlockBinding(handle, uniformBlockIndex, uniformBlockBinding);
 }
-void ShaderProgram::setUniform(const char* name, int i1) { glUniform1i(getUniformLocation(name), i1); }
+
+bool ShaderProgram::checkUniformBlock(std::string_view name, GLint size, const std140::Member* members,
+                                      std::size_t count) const {
+  const UniformBlock* block = findByHash(uniformBlocks, UniformName::fromString(name).hash);
+  if (block == nullptr) return true;
+  std::string errors;
+  if (block->dataSize > size) {
+    errors += "size " + std::to_string(block->dataSize) + " is larger than " + std::to_string(size) + "; ";
+  }
+  GLint activeCount = 0, nameLength = 0;
+  glGetActiveUniformBlockiv(handle, block->index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &activeCount);
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &nameLength);
+  std::vector<GLint> indices(activeCount);
+  glGetActiveUniformBlockiv(handle, block->index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+  std::string memberName(nameLength, '\0');
+  for (GLint index : indices) {
+    GLuint uniformIndex = index;
+    GLint offset = -1;
+    GLsizei length = 0;
+    glGetActiveUniformsiv(handle, 1, &uniformIndex, GL_UNIFORM_OFFSET, &offset);
+    glGetActiveUniformName(handle, uniformIndex, nameLength, &length, memberName.data());
+    std::string_view view(memberName.data(), length);
+    if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") view.remove_suffix(3);
+    const std140::Member* end = members + count;
+    const std140::Member* member = std::find_if(members, end, [view](const auto& m) { return m.name == view; });
+    if (member == end) {
+      errors.append(view).append(" is not in the C++ struct; ");
+    } else if (static_cast<std::size_t>(offset) != member->offset) {
+      errors.append(view).append(" is at " + std::to_string(offset) + ", not " + std::to_string(member->offset) + "; ");
+    }
+  }
+  if (errors.empty()) return true;
+  errors = "Uniform block " + std::string(name) + " differs from its C++ layout: " + errors;
+  if (glDebugMessageInsert) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                         errors.c_str());
+  } else {
+    puts(errors.c_str());
+  }
+  return false;
+}
+
+void ShaderProgram::setUniforms(std::initializer_list<UniformValue> values) const {
+  use();
+  for (const UniformValue& uniform : values) {
+    const GLfloat* f = uniform.value.f;
+    switch (uniform.type) {
+      case GL_INT: glUniform1i(uniform.location, uniform.value.i); break;
+      case GL_FLOAT: glUniform1f(uniform.location, f[0]); break;
+      case GL_FLOAT_VEC2: glUniform2fv(uniform.location, 1, f); break;
+      case GL_FLOAT_VEC3: glUniform3fv(uniform.location, 1, f); break;
+      case GL_FLOAT_VEC4: glUniform4fv(uniform.location, 1, f); break;
+      case GL_FLOAT_MAT4: glUniformMatrix4fv(uniform.location, 1, GL_FALSE, f); break;
+      default: break;
+    }
+  }
+}
+
+void ShaderProgram::setUniform(UniformName name, GLint i1) { glUniform1i(getUniformLocation(name), i1); }
 void ShaderProgram::setUniform(GLint location, GLint i1) { glUniform1i(location, i1); }
 }  // namespace graphics::shader
@@ -1,7 +1,35 @@
 #include "shader/shader.h"
+#include <algorithm>
 #include <fstream>
 #include <string>
+
+#include "shader/preprocessor.h"
 namespace {
+/**
+ * @brief Find the #version directive, which may follow blank lines and comments.
+ *
+ * @param nextLine Receives the number of the line after it, 1 if there is none.
+ * @return Offset just past the directive's line, 0 if there is none.
+ */
+std::size_t findVersionEnd(std::string_view code, int& nextLine) {
+  constexpr std::string_view blank = " \t\r";
+  nextLine = 1;
+  for (std::size_t begin = 0, lineNumber = 1; begin < code.size(); ++lineNumber) {
+    const std::size_t end = std::min(code.find('\n', begin), code.size());
+    std::string_view line = code.substr(begin, end - begin);
+    begin = end + 1;
+    line.remove_prefix(std::min(line.find_first_not_of(blank), line.size()));
+    if (line.empty() || line.front() != '#') continue;
+    line.remove_prefix(1);
+    line.remove_prefix(std::min(line.find_first_not_of(blank), line.size()));
+    if (line.compare(0, 7, "version") != 0) continue;
+    nextLine = static_cast<int>(lineNumber) + 1;
+    return std::min(begin, code.size());
+  }
+  return 0;
+}
+}  // namespace
+namespace graphics::shader {
 std::string readFile(const utils::fs::path& filename) {
   std::ifstream shaderFile(filename);
   if (!shaderFile) {
@@ -16,9 +44,6 @@ std::string readFile(const utils::fs::path& filename) {
   auto shaderCode = std::string(std::istreambuf_iterator<char>(shaderFile), std::istreambuf_iterator<char>());
   return shaderCode;
 }
-}  // namespace
-
-namespace graphics::shader {
 
 Shader::Shader(GLenum shaderType) noexcept : handle(glCreateShader(shaderType)) {}
 Shader::~Shader() { glDeleteShader(handle); }
@@ -41,11 +66,25 @@ bool Shader::checkCompileState() const {
   return success;
 }
 
-void Shader::fromFile(const utils::fs::path& filename) const { this->fromString(readFile(filename)); }
+void Shader::fromFile(const utils::fs::path& filename, std::string_view preamble) const {
+  this->fromString(Preprocessor::expand(filename).code, preamble);
+}
 
-void Shader::fromString(const std::string& shaderCode) const {
-  auto shaderCodePointer = shaderCode.c_str();
-  glShaderSource(handle, 1, &shaderCodePointer, nullptr);
+void Shader::fromString(const std::string& shaderCode, std::string_view preamble) const {
+  if (preamble.empty()) {
+    auto shaderCodePointer = shaderCode.c_str();
+    glShaderSource(handle, 1, &shaderCodePointer, nullptr);
+  } else {
+    // #version must come first, #line keeps error messages pointing at the lines of the file, which is source 0.
+    std::string_view code = shaderCode;
+    int nextLine;
+    const std::size_t split = findVersionEnd(code, nextLine);
+    const std::string line = "\n#line " + std::to_string(nextLine) + " 0\n";
+    const GLchar* sources[] = {code.data(), preamble.data(), line.data(), code.data() + split};
+    const GLint lengths[] = {static_cast<GLint>(split), static_cast<GLint>(preamble.size()),
+                             static_cast<GLint>(line.size()), static_cast<GLint>(code.size() - split)};
+    glShaderSource(handle, 4, sources, lengths);
+  }
   glCompileShader(handle);
 }
 }  // namespace graphics::shader
@@ -0,0 +1,47 @@
+#include "shader/variants.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "shader/shader.h"
+
+namespace graphics::shader {
+ProgramVariants::ProgramVariants(const utils::fs::path& _vertexFile,
+                                 const utils::fs::path& _fragmentFile,
+                                 std::vector<std::string> _features,
+                                 std::string _preamble) :
+    vertexFile(_vertexFile),
+    fragmentFile(_fragmentFile),
+    features(std::move(_features)),
+    preamble(std::move(_preamble)) {
+  if (features.size() > maxFeatures) THROW_EXCEPTION(std::length_error, "Too many shader features");
+}
+
+std::string ProgramVariants::getDefines(Key key) const {
+  std::string defines;
+  for (std::size_t i = 0; i < features.size(); ++i)
+    if (key & (Key{1} << i)) defines += "#define " + features[i] + " 1\n";
+  return defines;
+}
+
+ProgramVariants::Key ProgramVariants::mask(Key key) const {
+  return features.size() < maxFeatures ? key & ((Key{1} << features.size()) - 1) : key;
+}
+
+ShaderProgram& ProgramVariants::get(Key key) {
+  key = mask(key);
+  std::unique_ptr<ShaderProgram>& variant = variants[key];
+  if (variant) return *variant;
+  variant = std::make_unique<ShaderProgram>();
+  const std::string variantPreamble = getDefines(key) + preamble;
+  VertexShader vs;
+  FragmentShader fs;
+  vs.fromFile(vertexFile, variantPreamble);
+  fs.fromFile(fragmentFile, variantPreamble);
+  variant->attach(&vs, &fs);
+  variant->link();
+  variant->detach(&vs, &fs);
+  if (initializer) initializer(*variant);
+  return *variant;
+}
+}  // namespace graphics::shader
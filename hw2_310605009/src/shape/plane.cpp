@@ -77,34 +77,58 @@ void Plane::generateVertices(std::vector<GLfloat>& vertices,
                              float width,
                              float height,
                              bool scaleTexture) {
-  vertices.reserve((subdivision + 1) * (subdivision + 1) * 8);
-  indices.reserve((subdivision) * (2 * subdivision + 3));
+  // Exact sizes, every element is overwritten below.
+  vertices.resize(getVertexCount(subdivision) * vertexStride);
+  indices.resize(getIndexCount(subdivision));
+  generateVertices(vertices.data(), indices.data(), subdivision, width, height, scaleTexture);
+}
+
+void Plane::generateVertices(GLfloat* vertices,
+                             GLuint* indices,
+                             int subdivision,
+                             float width,
+                             float height,
+                             bool scaleTexture) {
+  // Spawning threads only pays off for large grids.
+  constexpr int minVerticesPerThread = 1 << 15;
+  const int rowSize = subdivision + 1;
+  const int minRowsPerThread = minVerticesPerThread / rowSize + 1;
 
   float wStep = 2.0f * width / subdivision;
   float hStep = 2.0f * height / subdivision;
   float wTexStep = scaleTexture ? 1.0f / subdivision : width / subdivision;
   float hTexStep = scaleTexture ? 1.0f / subdivision : height / subdivision;
-  for (int i = 0; i < subdivision + 1; ++i) {
-    for (int j = 0; j < subdivision + 1; ++j) {
-      vertices.insert(vertices.end(), {-width + j * wStep, 0, -height + i * hStep, 0, 1, 0});
-      if (scaleTexture)
-        vertices.insert(vertices.end(), {0 + j * wTexStep, 1 - i * hTexStep});
-      else
-        vertices.insert(vertices.end(), {0 + j * wTexStep, height - i * hTexStep});
+  float texTop = scaleTexture ? 1.0f : height;
+  utils::parallelFor(subdivision + 1, minRowsPerThread, [=](int first, int last) {
+    GLfloat* vertex = vertices + static_cast<std::size_t>(first) * rowSize * vertexStride;
+    for (int i = first; i < last; ++i) {
+      for (int j = 0; j < rowSize; ++j, vertex += vertexStride) {
+        vertex[0] = -width + j * wStep;
+        vertex[1] = 0;
+        vertex[2] = -height + i * hStep;
+        vertex[3] = 0;
+        vertex[4] = 1;
+        vertex[5] = 0;
+        vertex[6] = 0 + j * wTexStep;
+        vertex[7] = texTop - i * hTexStep;
+      }
     }
-  }
-
-  for (int i = 0; i < subdivision; ++i) {
-    int offset = i * (subdivision + 1);
-    for (int j = 0; j < subdivision; ++j) {
-      indices.emplace_back(offset + j);
-      indices.emplace_back(offset + j + subdivision + 1);
-      indices.emplace_back(offset + j + 1);
-
-      indices.emplace_back(offset + j + 1);
-      indices.emplace_back(offset + j + subdivision + 1);
-      indices.emplace_back(offset + j + subdivision + 2);
+  });
+
+  utils::parallelFor(subdivision, minRowsPerThread, [=](int first, int last) {
+    GLuint* index = indices + static_cast<std::size_t>(first) * subdivision * 6;
+    for (int i = first; i < last; ++i) {
+      GLuint offset = static_cast<GLuint>(i) * rowSize;
+      for (int j = 0; j < subdivision; ++j, index += 6) {
+        index[0] = offset + j;
+        index[1] = offset + j + subdivision + 1;
+        index[2] = offset + j + 1;
+
+        index[3] = offset + j + 1;
+        index[4] = offset + j + subdivision + 1;
+        index[5] = offset + j + subdivision + 2;
+      }
     }
-  }
+  });
 }
 }  // namespace graphics::shape
@@ -1,4 +1,40 @@
 #include "shape/sphere.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SPHERE_USE_SSE 1
+#define SPHERE_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPHERE_USE_SSE 1
+#endif
+
+namespace {
+#ifdef SPHERE_USE_SSE
+// Interleave 4 vertices of one stack into {x, y, z, x, y, z, s, t} layout.
+inline void storeVertices(float* out, __m128 x, __m128 y, __m128 z, __m128 s, __m128 t) {
+  __m128 xyLow = _mm_unpacklo_ps(x, y);   // x0 y0 x1 y1
+  __m128 xyHigh = _mm_unpackhi_ps(x, y);  // x2 y2 x3 y3
+  __m128 zxLow = _mm_unpacklo_ps(z, x);   // z x0 z x1
+  __m128 zxHigh = _mm_unpackhi_ps(z, x);  // z x2 z x3
+  __m128 yzLow = _mm_unpacklo_ps(y, z);   // y0 z y1 z
+  __m128 yzHigh = _mm_unpackhi_ps(y, z);  // y2 z y3 z
+  __m128 stLow = _mm_unpacklo_ps(s, t);   // s0 t s1 t
+  __m128 stHigh = _mm_unpackhi_ps(s, t);  // s2 t s3 t
+  _mm_storeu_ps(out + 0, _mm_shuffle_ps(xyLow, zxLow, _MM_SHUFFLE(1, 0, 1, 0)));
+  _mm_storeu_ps(out + 4, _mm_shuffle_ps(yzLow, stLow, _MM_SHUFFLE(1, 0, 1, 0)));
+  _mm_storeu_ps(out + 8, _mm_shuffle_ps(xyLow, zxLow, _MM_SHUFFLE(3, 2, 3, 2)));
+  _mm_storeu_ps(out + 12, _mm_shuffle_ps(yzLow, stLow, _MM_SHUFFLE(3, 2, 3, 2)));
+  _mm_storeu_ps(out + 16, _mm_shuffle_ps(xyHigh, zxHigh, _MM_SHUFFLE(1, 0, 1, 0)));
+  _mm_storeu_ps(out + 20, _mm_shuffle_ps(yzHigh, stHigh, _MM_SHUFFLE(1, 0, 1, 0)));
+  _mm_storeu_ps(out + 24, _mm_shuffle_ps(xyHigh, zxHigh, _MM_SHUFFLE(3, 2, 3, 2)));
+  _mm_storeu_ps(out + 28, _mm_shuffle_ps(yzHigh, stHigh, _MM_SHUFFLE(3, 2, 3, 2)));
+}
+#endif
+}  // namespace
+
 namespace graphics::shape {
 
 std::weak_ptr<buffer::VertexArray> Sphere::vao_weak;
@@ -72,49 +108,100 @@ void Sphere::draw() const {
 }
 
 void Sphere::generateVertices(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, int stack, int slice) {
-  // See http://www.songho.ca/opengl/gl_sphere.html#sphere if you don't know how to create a sphere.
-  vertices.reserve(8 * (stack + 1) * (slice + 1));
-  indices.reserve(6 * stack * slice);
+  // Exact sizes, every element is overwritten below.
+  vertices.resize(getVertexCount(stack, slice) * vertexStride);
+  indices.resize(getIndexCount(stack, slice));
+  generateVertices(vertices.data(), indices.data(), stack, slice);
+}
 
-  float x, y, z, xy;  //  position
-  float s, t;         //  texCoord
+void Sphere::generateVertices(GLfloat* vertices, GLuint* indices, int stack, int slice) {
+  // See http://www.songho.ca/opengl/gl_sphere.html#sphere if you don't know how to create a sphere.
+  // Spawning threads only pays off for large spheres.
+  constexpr int minVerticesPerThread = 1 << 15;
+  const int rowSize = slice + 1;
+  const int minRowsPerThread = minVerticesPerThread / rowSize + 1;
 
   float sectorStep = glm::two_pi<float>() / slice;
   float stackStep = glm::pi<float>() / stack;
-  float sectorAngle, stackAngle;
-
-  for (int i = 0; i <= stack; ++i) {
-    stackAngle = static_cast<float>(glm::half_pi<float>() - i * stackStep);  // [pi/2, -pi/2]
-    xy = cosf(stackAngle);                                                   // r * cos(u)
-    z = sinf(stackAngle);                                                    // r * sin(u)
-
-    for (int j = 0; j <= slice; ++j) {
-      sectorAngle = j * sectorStep;  // [0, 2pi]
-
-      x = xy * cosf(sectorAngle);  // r * cos(u) * cos(v)
-      y = xy * sinf(sectorAngle);  // r * cos(u) * sin(v)
-
-      // vertex tex coord (s, t) range between [0, 1]
-      s = static_cast<float>(j) / slice;
-      t = static_cast<float>(i) / stack;
-
-      vertices.insert(vertices.end(), {x, y, z, x, y, z, s, t});
-    }
+  // Every stack shares the same sectors, so evaluate their trigonometry and s coordinate once.
+  std::vector<float> sectorTable(3 * static_cast<std::size_t>(rowSize));
+  float* sectorCos = sectorTable.data();
+  float* sectorSin = sectorCos + rowSize;
+  float* sectorS = sectorSin + rowSize;
+  for (int j = 0; j <= slice; ++j) {
+    float sectorAngle = j * sectorStep;  // [0, 2pi]
+    sectorCos[j] = cosf(sectorAngle);
+    sectorSin[j] = sinf(sectorAngle);
+    sectorS[j] = static_cast<float>(j) / slice;
   }
 
-  unsigned int k1, k2;  // EBO index
-  for (int i = 0; i < stack; ++i) {
-    k1 = i * (slice + 1);  // beginning of current stack
-    k2 = k1 + slice + 1;   // beginning of next stack
-    for (int j = 0; j < slice; ++j, ++k1, ++k2) {
-      if (i != 0) {
-        indices.insert(indices.end(), {k1, k2, k1 + 1});
+  utils::parallelFor(stack + 1, minRowsPerThread, [=](int first, int last) {
+    GLfloat* vertex = vertices + static_cast<std::size_t>(first) * rowSize * vertexStride;
+    for (int i = first; i < last; ++i) {
+      float stackAngle = static_cast<float>(glm::half_pi<float>() - i * stackStep);  // [pi/2, -pi/2]
+      float xy = cosf(stackAngle);                                                   // r * cos(u)
+      float z = sinf(stackAngle);                                                    // r * sin(u)
+      float t = static_cast<float>(i) / stack;
+      int j = 0;
+#ifdef SPHERE_USE_AVX
+      __m256 xy8 = _mm256_set1_ps(xy);
+      for (; j + 8 <= rowSize; j += 8, vertex += 8 * vertexStride) {
+        __m256 x = _mm256_mul_ps(xy8, _mm256_loadu_ps(sectorCos + j));  // r * cos(u) * cos(v)
+        __m256 y = _mm256_mul_ps(xy8, _mm256_loadu_ps(sectorSin + j));  // r * cos(u) * sin(v)
+        __m256 s = _mm256_loadu_ps(sectorS + j);
+        storeVertices(vertex, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm_set1_ps(z),
+                      _mm256_castps256_ps128(s), _mm_set1_ps(t));
+        storeVertices(vertex + 4 * vertexStride, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+                      _mm_set1_ps(z), _mm256_extractf128_ps(s, 1), _mm_set1_ps(t));
       }
-      // k1+1 => k2 => k2+1
-      if (i != (stack - 1)) {
-        indices.insert(indices.end(), {k1 + 1, k2, k2 + 1});
+#endif
+#ifdef SPHERE_USE_SSE
+      __m128 xy4 = _mm_set1_ps(xy);
+      for (; j + 4 <= rowSize; j += 4, vertex += 4 * vertexStride) {
+        __m128 x = _mm_mul_ps(xy4, _mm_loadu_ps(sectorCos + j));  // r * cos(u) * cos(v)
+        __m128 y = _mm_mul_ps(xy4, _mm_loadu_ps(sectorSin + j));  // r * cos(u) * sin(v)
+        storeVertices(vertex, x, y, _mm_set1_ps(z), _mm_loadu_ps(sectorS + j), _mm_set1_ps(t));
+      }
+#endif
+      for (; j < rowSize; ++j, vertex += vertexStride) {
+        float x = xy * sectorCos[j];  // r * cos(u) * cos(v)
+        float y = xy * sectorSin[j];  // r * cos(u) * sin(v)
+        // vertex tex coord (s, t) range between [0, 1]
+        vertex[0] = vertex[3] = x;
+        vertex[1] = vertex[4] = y;
+        vertex[2] = vertex[5] = z;
+        vertex[6] = sectorS[j];
+        vertex[7] = t;
       }
     }
-  }
+  });
+
+  if (stack < 2) return;
+  // The first and the last stack only have one triangle per sector.
+  auto stackIndexOffset = [slice](int i) -> std::size_t {
+    return i == 0 ? 0 : static_cast<std::size_t>(3 * slice) + static_cast<std::size_t>(i - 1) * slice * 6;
+  };
+  utils::parallelFor(stack, minRowsPerThread, [=](int first, int last) {
+    GLuint* index = indices + stackIndexOffset(first);
+    for (int i = first; i < last; ++i) {
+      GLuint k1 = i * rowSize;   // beginning of current stack
+      GLuint k2 = k1 + rowSize;  // beginning of next stack
+      for (int j = 0; j < slice; ++j, ++k1, ++k2) {
+        if (i != 0) {
+          index[0] = k1;
+          index[1] = k2;
+          index[2] = k1 + 1;
+          index += 3;
+        }
+        // k1+1 => k2 => k2+1
+        if (i != (stack - 1)) {
+          index[0] = k1 + 1;
+          index[1] = k2;
+          index[2] = k2 + 1;
+          index += 3;
+        }
+      }
+    }
+  });
 }
 }  // namespace graphics::shape
@@ -0,0 +1,7 @@
+#version 330 core
+layout(location = 0) in vec3 position_in;
+#include "common/quantization.glsl"
+void main() {
+  vec3 position = decodePosition(position_in);
+  gl_Position = vec4(position.x, -position.z, 0.0, 1.0);
+}
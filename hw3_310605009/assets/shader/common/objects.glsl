@@ -0,0 +1,12 @@
+#pragma once
+struct Object {
+  // Model matrix
+  mat4 modelMatrix;
+  // inverse(transpose(model)), precalculate using CPU for efficiency
+  mat4 normalMatrix;
+};
+
+// One entry per object drawn in the frame, see RenderQueue's indirect submission.
+layout (std430, binding = 0) readonly buffer objects {
+  Object object[];
+};
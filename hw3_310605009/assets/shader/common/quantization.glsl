@@ -0,0 +1,6 @@
+#pragma once
+// Decode of 16-bit normalized positions, identity for float positions.
+uniform vec3 positionScale = vec3(1.0);
+uniform vec3 positionBias = vec3(0.0);
+
+vec3 decodePosition(vec3 position) { return position * positionScale + positionBias; }
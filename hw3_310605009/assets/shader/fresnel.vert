@@ -0,0 +1,24 @@
+#version 430 core
+layout(location = 0) in vec3 position_in;
+layout(location = 1) in vec3 normal_in;
+// Base instance of the draw, indexes objects
+layout(location = 7) in uint objectIndex_in;
+
+out VS_OUT {
+  vec3 position;
+  vec3 normal;
+  flat vec3 viewPosition;
+} vs_out;
+
+#include "common/objects.glsl"
+
+// The camera uniform block is generated from C++, see include/shader/blocks.h.
+
+void main() {
+  mat4 modelMatrix = object[objectIndex_in].modelMatrix;
+  mat4 normalMatrix = object[objectIndex_in].normalMatrix;
+  vs_out.position = vec3(modelMatrix * vec4(position_in, 1.0));
+  vs_out.normal = normalize(mat3(normalMatrix) * normal_in);
+  vs_out.viewPosition = viewPosition.xyz;
+  gl_Position = viewProjectionMatrix * modelMatrix * vec4(position_in, 1.0);
+}
@@ -0,0 +1,60 @@
+#version 430 core
+layout(location = 0) in vec3 position_in;
+layout(location = 1) in vec3 normal_in;
+layout(location = 2) in vec2 textureCoordinate_in;
+// w is the bitangent sign, 1 when the buffer only holds xyz.
+layout(location = 3) in vec4 tangent_in;
+// Base instance of the draw, indexes objects
+layout(location = 7) in uint objectIndex_in;
+
+out VS_OUT {
+  vec3 position;
+  vec3 lightDirection;
+  vec2 textureCoordinate;
+  mat3 TBN;
+  flat vec3 viewPosition;
+} vs_out;
+
+
+
+#include "common/quantization.glsl"
+
+// DISPLACEMENT_MAPPING is defined by the program variant, see include/shader/variants.h.
+// TODO (Bonus-Displacement): You may need these if you want to implement displacement mapping.
+uniform sampler2D heightTexture;
+float depthScale = 0.01;
+
+#include "common/objects.glsl"
+
+// The camera uniform block is generated from C++, see include/shader/blocks.h.
+
+void main() {
+  mat4 modelMatrix = object[objectIndex_in].modelMatrix;
+  mat4 normalMatrix = object[objectIndex_in].normalMatrix;
+  // Direction of light, hard coded here for convinience.
+  const vec3 lightDirection = normalize(vec3(-11.1, -24.9, 14.8));
+  vs_out.textureCoordinate = textureCoordinate_in;
+  // TODO:
+  //   1. Calculate the inverse of tangent space transform matrix (TBN matrix)
+  //   2. Transform light direction, viewPosition, and position to the tangent space.
+  //   3. (Bonus-Displacement) Query height from heightTexture.
+  vec3 position = decodePosition(position_in);
+  vec4 worldposition = modelMatrix*vec4(position,0.0);
+  vec3 bitangent = cross(normal_in, tangent_in.xyz) * sign(tangent_in.w);
+  vec3 T = normalize(vec3(modelMatrix * vec4(tangent_in.xyz, 0.0)));
+  vec3 B = normalize(vec3(modelMatrix * vec4(bitangent,      0.0)));
+  vec3 N = normalize(vec3(modelMatrix * vec4(normal_in,      0.0)));
+  mat3 TBN = transpose(mat3(T, B, N));
+  vs_out.TBN = transpose(mat3(T, B, N));
+  vs_out.lightDirection = TBN* lightDirection;
+  vs_out.position =TBN * (worldposition.xyz);
+  vs_out.viewPosition = TBN* (viewPosition.xyz);
+
+
+
+  vec3 displacementVector = vec3(0);
+#ifdef DISPLACEMENT_MAPPING
+  // TODO (Bonus-Displacement): Set displacementVector, you should scale the height query from heightTexture by depthScale.
+#endif
+  gl_Position = viewProjectionMatrix * (modelMatrix * vec4(position + displacementVector, 1.0));
+}
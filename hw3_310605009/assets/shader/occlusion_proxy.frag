@@ -0,0 +1,3 @@
+#version 330 core
+// Only samples passing the depth test are counted, nothing is written.
+void main() {}
@@ -0,0 +1,8 @@
+#version 330 core
+// Unit cube corner, scaled onto the object's bounds by boxMatrix
+layout(location = 0) in vec3 position_in;
+
+// Projection * View * Model * bounds
+uniform mat4 boxMatrix;
+
+void main() { gl_Position = boxMatrix * vec4(position_in, 1.0); }
@@ -0,0 +1,19 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace utils {
+/// @return Milliseconds of the fastest of repeats calls to function, the others absorb cold caches and page faults.
+template <typename Function>
+double measureMilliseconds(int repeats, Function&& function) {
+  double fastest = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    fastest = std::min(fastest,
+                       std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  return fastest;
+}
+}  // namespace utils
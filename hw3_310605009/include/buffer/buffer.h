@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "utils.h"
+namespace graphics::buffer {
+/**
+ * @brief Buffer object, edited by name with direct state access and through GL_COPY_WRITE_BUFFER otherwise.
+ *
+ * Editing never binds the buffer's own target, e.g. the element array binding of the current vertex array is kept.
+ */
+class Buffer {
+ public:
+  MOVE_ONLY(Buffer)
+  Buffer() noexcept;
+  virtual ~Buffer();
+
+  void bind() const noexcept;
+  void allocate(GLsizeiptr _size, GLenum usage = GL_STATIC_DRAW) noexcept;
+  void load(GLintptr offset, GLsizeiptr _size, const void* data) noexcept;
+  void allocate_load(GLsizeiptr _size, const void* data, GLenum usage = GL_STATIC_DRAW) noexcept;
+  /**
+   * @brief Grow or shrink the storage, keeping the data that fits.
+   *
+   * The buffer gets a new handle, vertex arrays referring to it must be set up again.
+   */
+  void resize(GLsizeiptr _size, GLenum usage = GL_STATIC_DRAW) noexcept;
+  /// @brief Copy size bytes from source on the GPU, without touching any binding but the copy targets.
+  void copy(const Buffer& source, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr _size) noexcept;
+
+  CONSTEXPR_VIRTUAL virtual const char* getTypeName() const noexcept = 0;
+  CONSTEXPR_VIRTUAL virtual GLenum getType() const noexcept = 0;
+  GLuint getHandle() const noexcept { return handle; }
+  GLsizeiptr getSize() const noexcept { return size; }
+
+ protected:
+  GLuint handle;
+  GLsizeiptr size;
+};
+
+class ArrayBuffer final : public Buffer {
+ public:
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Array buffer"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const noexcept override { return GL_ARRAY_BUFFER; }
+};
+
+class ElementArrayBuffer final : public Buffer {
+ public:
+  /// Marks a strip restart in 32-bit input indices, uploaded as the maximum value of the chosen index type.
+  static constexpr GLuint restartIndex = std::numeric_limits<GLuint>::max();
+
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Element array buffer"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const noexcept override { return GL_ELEMENT_ARRAY_BUFFER; }
+  using Buffer::allocate_load;
+  /// @brief Upload indices using the narrowest index type that can hold them (and the restart index).
+  void allocate_load(const std::vector<GLuint>& indices, GLenum usage = GL_STATIC_DRAW);
+  void allocate_load(const std::vector<GLushort>& indices, GLenum usage = GL_STATIC_DRAW) noexcept;
+  void allocate_load(const std::vector<GLubyte>& indices, GLenum usage = GL_STATIC_DRAW) noexcept;
+  /// @brief Upload count indices already stored as type, e.g. straight from a mapped file.
+  void allocate_load(GLenum type, GLsizei count, const void* indices, GLenum usage = GL_STATIC_DRAW) noexcept;
+
+  /// @return Index type to pass to glDrawElements.
+  GLenum getIndexType() const noexcept { return indexType; }
+  /// @return Number of indices stored in the buffer.
+  GLsizei getIndexCount() const noexcept { return static_cast<GLsizei>(size / getIndexSize(indexType)); }
+
+  /// @return Narrowest index type whose maximum value is still free for primitive restart.
+  static constexpr GLenum getIndexType(GLuint maxIndex) noexcept {
+    if (maxIndex < std::numeric_limits<GLubyte>::max()) return GL_UNSIGNED_BYTE;
+    if (maxIndex < std::numeric_limits<GLushort>::max()) return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+  }
+  static constexpr GLsizeiptr getIndexSize(GLenum type) noexcept {
+    switch (type) {
+      case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+      case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+      default: return sizeof(GLuint);
+    }
+  }
+  /// @return Primitive restart index of the given index type.
+  static constexpr GLuint getRestartIndex(GLenum type) noexcept {
+    switch (type) {
+      case GL_UNSIGNED_BYTE: return std::numeric_limits<GLubyte>::max();
+      case GL_UNSIGNED_SHORT: return std::numeric_limits<GLushort>::max();
+      default: return std::numeric_limits<GLuint>::max();
+    }
+  }
+  /// @return indices stored as T, restartIndex becomes the restart index of T. Indices must fit in T.
+  template <typename T>
+  static std::vector<T> narrowIndices(const std::vector<GLuint>& indices) {
+    std::vector<T> narrowed(indices.size());
+    std::transform(indices.begin(), indices.end(), narrowed.begin(), [](GLuint index) {
+      return index == restartIndex ? std::numeric_limits<T>::max() : static_cast<T>(index);
+    });
+    return narrowed;
+  }
+
+ private:
+  GLenum indexType = GL_UNSIGNED_INT;
+};
+
+class UniformBuffer final : public Buffer {
+ public:
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Uniform buffer"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const noexcept override { return GL_UNIFORM_BUFFER; }
+  void bindUniformBlockIndex(GLuint index, GLuint offset, GLuint _size) const noexcept;
+  void bindUniformBlockIndex(GLuint index) const noexcept;
+};
+
+class ShaderStorageBuffer final : public Buffer {
+ public:
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Shader storage buffer"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const noexcept override { return GL_SHADER_STORAGE_BUFFER; }
+  void bindBase(GLuint index) const noexcept;
+};
+
+class DrawIndirectBuffer final : public Buffer {
+ public:
+  CONSTEXPR_VIRTUAL const char* getTypeName() const noexcept override { return "Draw indirect buffer"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const noexcept override { return GL_DRAW_INDIRECT_BUFFER; }
+};
+}  // namespace graphics::buffer
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "utils.h"
+namespace graphics::buffer {
+/**
+ * @brief Ring of per-frame partitions for data rewritten every frame, e.g. uniforms and draw commands.
+ *
+ * Storage is created with glBufferStorage and mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, so
+ * writes need no bind or glBufferSubData. Frame n writes partition n % frameCount, and beginFrame waits on the fence
+ * endFrame placed frameCount frames ago, so the GPU is never reading what the CPU overwrites. Without GL 4.4 or
+ * ARB_buffer_storage, allocations go to client memory and flush uploads them into the partition.
+ *
+ * Per frame: beginFrame, allocate and write, flush, bind the ranges and draw, endFrame after the last GL call that
+ * reads the frame's data.
+ */
+class StreamBuffer {
+ public:
+  struct Allocation {
+    // Bytes from the start of the buffer, for glBindBufferRange or indirect offsets
+    GLintptr offset;
+    // Write-only, valid until endFrame
+    void* pointer;
+  };
+  struct Statistics {
+    // beginFrame calls that had to block on the GPU
+    std::size_t fenceWaits = 0;
+    double waitMilliseconds = 0;
+    // Bytes allocated in the current and the previous frame
+    std::size_t frameBytes = 0;
+    std::size_t lastFrameBytes = 0;
+  };
+
+  DELETE_COPY(StreamBuffer)
+  DELETE_MOVE(StreamBuffer)
+  explicit StreamBuffer(int _frameCount = 3) noexcept : frameCount(_frameCount) {}
+  ~StreamBuffer();
+  /**
+   * @brief Make partitions at least frameSize bytes, call outside of beginFrame / endFrame.
+   *
+   * Growing replaces the storage, GL keeps the old one alive for commands already issued.
+   */
+  void reserve(GLsizeiptr frameSize);
+  /// @brief Switch to the next partition, waiting until the GPU finished the frame that used it.
+  void beginFrame();
+  /**
+   * @brief Reserve size bytes of the current partition.
+   *
+   * @param alignment Power of two, e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform block ranges.
+   * Throws std::length_error when the partition is full, see reserve.
+   */
+  Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+  /// @brief Make writes since the last flush visible to GL, a no-op for coherent mapped storage.
+  void flush();
+  /// @brief Fence the current partition.
+  void endFrame();
+
+  void bind(GLenum target) const noexcept;
+  void bindRange(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size) const noexcept;
+  GLuint getHandle() const noexcept { return handle; }
+  /// @return Whether storage is persistently mapped, false on the glBufferSubData fallback.
+  bool isPersistent() const noexcept { return persistent; }
+  const Statistics& getStatistics() const noexcept { return statistics; }
+
+ private:
+  void release() noexcept;
+
+  int frameCount;
+  int frame = 0;
+  GLuint handle = 0;
+  GLsizeiptr partitionSize = 0;
+  // Current partition's start, write head and first byte not yet flushed
+  GLintptr partitionStart = 0;
+  GLintptr head = 0;
+  GLintptr flushed = 0;
+  bool persistent = false;
+  // Mapped storage, or client memory on the fallback
+  unsigned char* memory = nullptr;
+  std::vector<unsigned char> fallback;
+  std::vector<GLsync> fences;
+  Statistics statistics;
+};
+}  // namespace graphics::buffer
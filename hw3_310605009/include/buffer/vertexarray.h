@@ -0,0 +1,46 @@
+#pragma once
+#include <glad/gl.h>
+
+#include "buffer/buffer.h"
+#include "utils.h"
+namespace graphics::buffer {
+/**
+ * @brief Vertex array described with separate attribute formats and buffer binding points.
+ *
+ * With direct state access everything is set by name. Otherwise each setter binds the vertex array and leaves it
+ * bound, call unbind() once done so later element array buffer binds do not land in it.
+ */
+class VertexArray {
+ public:
+  MOVE_ONLY(VertexArray)
+  VertexArray();
+  ~VertexArray();
+
+  void enable(int index);
+  /// @brief Float attribute of the bound GL_ARRAY_BUFFER, stride and offset are counted in floats.
+  void setAttributePointer(int index, int size, int stride, int offset);
+  /// @brief Source of binding point binding, stride bytes per vertex (or per instance, see setDivisor).
+  void setVertexBuffer(GLuint binding, const Buffer& buffer, GLintptr offset, GLsizei stride);
+  void setElementBuffer(const Buffer& buffer);
+  /**
+   * @brief Attribute of any vertex type (e.g. GL_HALF_FLOAT, GL_UNSIGNED_SHORT, GL_INT_2_10_10_10_REV), read as
+   * float in the shader.
+   *
+   * @param normalized Map integer types to [0, 1] (unsigned) or [-1, 1] (signed).
+   * @param offset Bytes from the start of the vertex.
+   * @param binding Binding point the attribute reads from, see setVertexBuffer.
+   */
+  void setAttributeFormat(int index, int size, GLenum type, bool normalized, GLuint offset, GLuint binding = 0);
+  /// @brief Integer attribute (e.g. GL_UNSIGNED_INT), read as int / uint in the shader. Offset in bytes.
+  void setIntegerAttributeFormat(int index, int size, GLenum type, GLuint offset, GLuint binding = 0);
+  /// @brief Advance the attributes of a binding point once per divisor instances instead of once per vertex.
+  void setDivisor(GLuint binding, GLuint divisor);
+  void bind();
+  /// @brief Unbind after setup, nothing to do with direct state access.
+  static void unbind();
+  GLuint getHandle() const { return handle; }
+
+ private:
+  GLuint handle;
+};
+}  // namespace graphics::buffer
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "utils.h"
+
+namespace utils {
+/**
+ * @brief Reports changes to a set of files from a thread of its own.
+ *
+ * On Linux the parent directories are watched with inotify, so files replaced by rename (as many editors save) are
+ * seen as well. Elsewhere, or when inotify is unavailable, the thread compares modification times every
+ * pollInterval instead; so it does for files whose directory inotify cannot watch, e.g. past the watch limit.
+ */
+class FileWatcher final {
+ public:
+  DELETE_COPY(FileWatcher)
+  DELETE_MOVE(FileWatcher)
+  /// @param useNotify Whether to use inotify where available, polling otherwise.
+  explicit FileWatcher(std::chrono::milliseconds _pollInterval = std::chrono::milliseconds(250),
+                       bool useNotify = true);
+  ~FileWatcher();
+  /// @brief Start reporting changes to file, the thread starts with the first file.
+  void watch(const fs::path& file);
+  /// @return Files changed since the last call, each once, as absolute normalized paths.
+  std::vector<fs::path> takeChanges();
+  /// @return Whether changes come from inotify rather than polling, except for files it failed to watch.
+  bool isNotifying() const { return notifyHandle >= 0; }
+  /// @return The path watch and takeChanges compare by.
+  static fs::path normalize(const fs::path& file);
+
+ private:
+  void run();
+  /// @brief Compare the modification times of every file, or while notifying of the files inotify cannot watch.
+  void poll();
+  void readEvents();
+
+  std::chrono::milliseconds pollInterval;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::atomic<bool> isStopping{false};
+  std::thread thread;
+  // Guarded by mutex: watched files with their last modification time, and changes not taken yet
+  std::map<fs::path, fs::file_time_type> files;
+  std::set<fs::path> changes;
+  // Guarded by mutex: files polled although notifying
+  std::set<fs::path> polledFiles;
+  // inotify descriptor, -1 when polling, and the directory of each watch descriptor
+  int notifyHandle = -1;
+  std::map<int, fs::path> directories;
+};
+}  // namespace utils
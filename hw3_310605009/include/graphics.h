@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+
+#include "buffer/buffer.h"
+#include "buffer/streambuffer.h"
+#include "camera/quat_camera.h"
+#include "context_manager.h"
+#include "mesh.h"
+#include "render/geometrypool.h"
+#include "render/occlusion.h"
+#include "render/renderqueue.h"
+#include "scene/bvh.h"
+#include "scene/culling.h"
+#include "shader/program.h"
+#include "shader/preprocessor.h"
+#include "shader/programcache.h"
+#include "shader/reloader.h"
+#include "shader/shader.h"
+#include "shader/variants.h"
+#include "shape/cube.h"
+#include "shape/geometry.h"
+#include "shape/meshfile.h"
+#include "shape/model.h"
+#include "shape/plane.h"
+#include "shape/sphere.h"
+#include "texture/cubemap.h"
+#include "texture/framebuffertexture.h"
+#include "texture/texture2d.h"
+#include "utils.h"
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <ostream>
+
+#include "utils.h"
+
+namespace utils {
+/// Read-only memory mapping of a whole file (mmap on POSIX, MapViewOfFile on Windows).
+class MappedFile final {
+ public:
+  DELETE_COPY(MappedFile)
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  /// @brief Map the file, throws std::runtime_error if it cannot be opened or mapped.
+  explicit MappedFile(const fs::path& path);
+  ~MappedFile();
+
+  const unsigned char* data() const noexcept { return static_cast<const unsigned char*>(address); }
+  std::size_t size() const noexcept { return length; }
+
+ private:
+  void release() noexcept;
+
+  void* address = nullptr;
+  std::size_t length = 0;
+#ifdef _WIN32
+  void* mapping = nullptr;
+#endif
+};
+
+/**
+ * @brief Write a cache file with write(output), to a temporary file renamed over path so readers never see partial
+ * files. Creates the directory on demand.
+ *
+ * Caches are only an optimization: failures are reported as debug messages (or printed without a context), not thrown.
+ * @return Whether the file was written.
+ */
+bool writeCacheFile(const fs::path& path, const std::function<void(std::ostream& output)>& write);
+}  // namespace utils
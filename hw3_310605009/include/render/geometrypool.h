@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "buffer/buffer.h"
+#include "buffer/vertexarray.h"
+#include "shape/geometry.h"
+#include "shape/vertexformat.h"
+#include "utils.h"
+
+namespace graphics::render {
+/// Where a geometry lives in its GeometryPool batch, the fields of a DrawElementsIndirectCommand.
+struct PoolRange {
+  uint32_t batch;
+  GLuint firstIndex;
+  GLuint indexCount;
+  GLint baseVertex;
+};
+
+/**
+ * @brief Geometry copied into shared buffers, one batch per vertex layout, index type and primitive.
+ *
+ * All meshes of a batch draw from one vertex array, so any number of them go into one glMultiDrawElementsIndirect.
+ * Each batch vertex array also reads attribute objectIndexAttribute (uint, divisor 1) from an identity buffer, with
+ * baseInstance = i a draw sees objectIndex = i, which GL 4.3 shaders use to index per-object data (gl_DrawID needs
+ * GL 4.6). Geometry is copied on the GPU the first time it is requested, memory is only released by clear().
+ */
+class GeometryPool {
+ public:
+  static constexpr GLuint objectIndexAttribute = 7;
+  /// Vertex buffer binding point of the identity buffer, binding 0 holds the vertices.
+  static constexpr GLuint objectIndexBinding = 1;
+
+  DELETE_COPY(GeometryPool)
+  DELETE_MOVE(GeometryPool)
+  GeometryPool() = default;
+  /// @brief Range of geometry, copied into its batch on the first call.
+  const PoolRange& get(const shape::Geometry& geometry);
+  /// @brief Make objectIndex valid for base instances below count.
+  void reserveObjects(GLuint count);
+  /// @brief Bind the vertex array of a batch.
+  void bind(uint32_t batch) { batches[batch]->vao.bind(); }
+  GLenum getPrimitive(uint32_t batch) const { return batches[batch]->primitive; }
+  GLenum getIndexType(uint32_t batch) const { return batches[batch]->indexType; }
+  std::size_t getBatchCount() const { return batches.size(); }
+  /// @return Bytes of vertex and index data held by all batches.
+  std::size_t getSize() const;
+  void clear();
+
+ private:
+  struct Batch {
+    shape::VertexLayout layout;
+    GLenum indexType;
+    GLenum primitive;
+    buffer::VertexArray vao;
+    buffer::ArrayBuffer vbo;
+    buffer::ElementArrayBuffer ebo;
+    // Bytes in use, the buffers grow geometrically
+    GLsizeiptr vertexBytes = 0;
+    GLsizeiptr indexBytes = 0;
+  };
+  /// @return Index of the batch geometry belongs to, created if needed.
+  uint32_t findBatch(const shape::Geometry& geometry);
+  void setupVertexArray(Batch& batch);
+
+  // Held by pointer, buffers must not move
+  std::vector<std::unique_ptr<Batch>> batches;
+  // Keyed by Geometry::getId
+  std::unordered_map<uint64_t, PoolRange> ranges;
+  buffer::ArrayBuffer objectIndices;
+  GLuint objectCapacity = 0;
+};
+}  // namespace graphics::render
@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include "buffer/buffer.h"
+#include "buffer/vertexarray.h"
+#include "shader/program.h"
+#include "shape/shape.h"
+#include "utils.h"
+
+namespace graphics::render {
+/**
+ * HierarchicalZ culls the opaque draws of indirect submission on the GPU in two phases. Phase 1 tests them against a
+ * depth pyramid of the previous frame, the survivors are drawn and a new pyramid is built from their depth. Phase 2
+ * retests what phase 1 culled against it and draws what turns out visible, so nothing pops in late.
+ *
+ * Queries needs no compute shaders: after the opaque pass each tested mesh's bounding box is drawn inside an occlusion
+ * query, and the next frames skip the mesh while its last finished query saw nothing, or draw it under conditional
+ * rendering while the query is in flight. Indirect submission draws tested meshes one by one in this mode.
+ */
+enum class Occlusion : uint8_t { Off, HierarchicalZ, Queries };
+
+/// std430 element of the bounds array read by the culling shader, the local box of the object at the same index.
+struct ObjectBounds {
+  // w is 1 for objects that may be culled, 0 for ones always drawn
+  glm::vec4 minimum;
+  glm::vec4 maximum;
+};
+
+/// @brief Occlusion culling for RenderQueue, see Occlusion. Only Pass::Opaque items are tested.
+class OcclusionCuller {
+ public:
+  struct Statistics {
+    // Opaque items tested this frame
+    std::size_t tested = 0;
+    // Hierarchical-Z, read back without waiting so from a few frames ago: culled by phase 1, drawn after all by phase 2
+    std::size_t culled = 0;
+    std::size_t recovered = 0;
+    // Queries: items skipped on a hidden result, and items drawn under conditional rendering
+    std::size_t skipped = 0;
+    std::size_t conditional = 0;
+  };
+  // Storage block bindings of the culling shader, objects stay at RenderQueue::objectStorageBinding.
+  static constexpr GLuint boundsStorageBinding = 1;
+  static constexpr GLuint commandStorageBinding = 2;
+  static constexpr GLuint lateCommandStorageBinding = 3;
+  static constexpr GLuint counterStorageBinding = 4;
+  // Texture unit the pyramid is read from
+  static constexpr GLuint pyramidUnit = 15;
+
+  DELETE_COPY(OcclusionCuller)
+  DELETE_MOVE(OcclusionCuller)
+  /// @brief Compile hiz_reduce.comp, hiz_cull.comp and occlusion_proxy.vert / .frag from the directory.
+  explicit OcclusionCuller(const utils::fs::path& shaderDirectory);
+  ~OcclusionCuller();
+  /// @brief HierarchicalZ is ignored by direct submission.
+  void setMode(Occlusion _mode);
+  Occlusion getMode() const { return mode; }
+  /// @brief Start a frame drawn with viewProjection, collect finished results of earlier frames.
+  void beginFrame(const glm::mat4& viewProjection);
+  /// @brief Fence the frame's readback, after the last draw of the frame.
+  void endFrame();
+
+  /**
+   * @brief Phase 1, with the objects, bounds and both command arrays bound at the storage bindings above.
+   *
+   * @return False when there is no pyramid yet and nothing was culled.
+   */
+  bool cullEarly(GLuint objectCount);
+  /// @brief Build the pyramid from the read framebuffer's depth, then run phase 2 if retest is set.
+  void cullLate(GLuint objectCount, bool retest);
+
+  /// @return False to skip the shape, hidden at its last finished query. Otherwise draw it, then call endDraw.
+  bool beginDraw(const shape::Shape& shape);
+  void endDraw();
+  /// @brief Draw the bounding boxes of the shapes passed to beginDraw this frame inside occlusion queries.
+  void issueQueries();
+
+  const Statistics& getStatistics() const { return statistics; }
+
+ private:
+  struct Query {
+    GLuint handle = 0;
+    // Issued and not read back yet
+    bool isPending = false;
+    bool isVisible = true;
+    uint64_t lastFrame = 0;
+  };
+  /// @brief (Re)create the pyramid and the depth copy at the framebuffer size.
+  void resizePyramid(int width, int height);
+  void releasePyramid();
+
+  Occlusion mode = Occlusion::Off;
+  uint64_t frame = 0;
+  glm::mat4 viewProjection{1};
+  // Hierarchical-Z
+  shader::ShaderProgram reduceProgram;
+  shader::ShaderProgram cullProgram;
+  GLint sourceLevelLocation = -1;
+  GLint viewProjectionLocation = -1;
+  GLint objectCountLocation = -1;
+  GLint phaseLocation = -1;
+  GLuint depthCopy = 0;
+  GLuint pyramid = 0;
+  int pyramidWidth = 0;
+  int pyramidHeight = 0;
+  int pyramidLevels = 0;
+  bool hasPyramid = false;
+  // The matrix the pyramid was built with
+  glm::mat4 pyramidViewProjection{1};
+  // Two counters per frame in flight, each slot read back once its fence passed
+  static constexpr int counterSlots = 3;
+  buffer::ShaderStorageBuffer counters;
+  GLsizeiptr counterStride = 0;
+  std::array<GLsync, counterSlots> counterFences{};
+  // A culling dispatch wrote this frame's slot
+  bool isCounting = false;
+  // Queries
+  shader::ShaderProgram proxyProgram;
+  GLint boxMatrixLocation = -1;
+  buffer::VertexArray proxyVertexArray;
+  buffer::ArrayBuffer proxyVertices;
+  buffer::ElementArrayBuffer proxyIndices;
+  std::unordered_map<const shape::Shape*, Query> queries;
+  // Shapes to query this frame, and whether beginDraw started conditional rendering
+  std::vector<const shape::Shape*> queriedShapes;
+  bool isConditional = false;
+  Statistics statistics;
+};
+}  // namespace graphics::render
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+#include "buffer/buffer.h"
+#include "buffer/streambuffer.h"
+#include "mesh.h"
+#include "render/geometrypool.h"
+#include "render/occlusion.h"
+#include "shader/program.h"
+#include "shape/geometry.h"
+#include "shape/shape.h"
+#include "texture/texture.h"
+#include "utils.h"
+
+namespace graphics::render {
+/// Passes are drawn in this order, opaque and background front to back, transparent back to front.
+enum class Pass : uint8_t { Opaque, Background, Transparent };
+/**
+ * Direct binds a range of the object uniform buffer and draws every item on its own. Indirect uploads the model and
+ * normal matrices of all items to a storage buffer and merges consecutive items with the same program, textures and
+ * pool batch (vertex layout, index type, primitive) into one glMultiDrawElementsIndirect.
+ */
+enum class Submission : uint8_t { Direct, Indirect };
+
+/// std430 element of the per-object storage block in indirect submission, indexed by the objectIndex attribute.
+struct ObjectData {
+  glm::mat4 modelMatrix;
+  glm::mat4 normalMatrix;
+};
+
+/**
+ * @brief Collects the meshes of a frame and draws them sorted by state.
+ *
+ * Each item gets a 64-bit key, from the most significant bits: pass (4), program (12), texture set (12), vertex array
+ * (12, the pool batch in indirect submission) and depth (24). Transparent items put the inverted depth right after
+ * the pass instead, so they are drawn back to front whatever their state. Keys are radix sorted and only state that
+ * differs from the previous item is submitted. The program, texture and vertex array fields are truncated handles
+ * and hashes, collisions cost extra switches but never wrong state. Pre / post draw callbacks of shapes run around
+ * their draw and must not change program, texture, vertex array or uniform buffer bindings, shapes with callbacks are
+ * never merged with others.
+ */
+class RenderQueue {
+ public:
+  struct Statistics {
+    // Items pushed this frame
+    std::size_t items = 0;
+    // Draw calls issued, one per merged run in indirect submission
+    std::size_t drawCalls = 0;
+    std::size_t programSwitches = 0;
+    // Texture units rebound
+    std::size_t textureSwitches = 0;
+    std::size_t vertexArraySwitches = 0;
+    // Per-object uniform ranges rebound
+    std::size_t objectBufferSwitches = 0;
+    // Object data, draw commands and occlusion bounds streamed in indirect submission
+    std::size_t uploadedBytes = 0;
+    double sortMilliseconds = 0;
+    double submitMilliseconds = 0;
+  };
+
+  /// Storage block binding of the ObjectData array in indirect submission.
+  static constexpr GLuint objectStorageBinding = 0;
+
+  DELETE_COPY(RenderQueue)
+  DELETE_MOVE(RenderQueue)
+  explicit RenderQueue(Submission _submission = Submission::Direct) : submission(_submission) {}
+  /// @brief Per-object uniform block of direct submission, items bind [offset, offset + size) of buffer to binding.
+  void setObjectBuffer(const buffer::UniformBuffer* buffer, GLuint binding, GLuint size);
+  /// @brief Cull opaque items with culler in its current mode, nullptr to draw them all.
+  void setOcclusionCuller(OcclusionCuller* culler) { occlusion = culler; }
+  /// @brief Start a frame, depth is the distance of the model origin to eye, quantized over [0, farPlane].
+  void begin(const glm::vec3& eye, float farPlane);
+  /// @param objectOffset Offset of the mesh's block in the object buffer, unused in indirect submission.
+  void push(const utils::Mesh& mesh, Pass pass = Pass::Opaque, GLuint objectOffset = 0);
+  /// @brief Sort and draw everything pushed since begin.
+  void submit();
+  /// @return Sort key of an item, depth quantized to 24 bits as begin() describes.
+  static uint64_t makeKey(Pass pass, GLuint program, uint64_t textureHash, GLuint vertexArray, uint32_t depth);
+  /// @return Statistics of the last frame.
+  const Statistics& getStatistics() const { return statistics; }
+  /// @return Shared buffers of indirect submission.
+  const GeometryPool& getPool() const { return pool; }
+  /// @return Ring buffer the object data and draw commands of indirect submission are written to.
+  const buffer::StreamBuffer& getStream() const { return stream; }
+
+ private:
+  struct Item {
+    const shape::Shape* shape;
+    const shader::ShaderProgram* program;
+    const std::vector<texture::Texture*>* textures;
+    shape::Geometry* geometry;
+    // Indirect submission only
+    const PoolRange* range;
+    GLuint objectOffset;
+  };
+  /// Layout of DrawElementsIndirectCommand.
+  struct DrawCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+  void submitDirect();
+  void submitIndirect();
+  /// @brief Draw sorted items [begin, count) with their commands at commandOffset in the stream, merged into runs.
+  void drawRuns(GLintptr commandOffset, uint32_t begin, uint32_t count, bool queries);
+  /// @brief Forget the bound program and textures, the next bindMaterial binds them again.
+  void resetBindings();
+  /// @brief Use the program and bind the textures of item, if they differ from the current ones.
+  void bindMaterial(const Item& item);
+
+  Submission submission;
+  std::vector<Item> items;
+  std::vector<uint64_t> keys, sortedKeys;
+  std::vector<uint32_t> order, sortedOrder;
+  // Radix sort counts, kept to avoid an allocation per frame
+  std::vector<uint32_t> histograms;
+  const buffer::UniformBuffer* objectBuffer = nullptr;
+  GLuint objectBinding = 0;
+  GLuint objectSize = 0;
+  glm::vec3 eye{0};
+  float depthScale = 0;
+  // Bound state while submitting
+  const shader::ShaderProgram* currentProgram = nullptr;
+  const std::vector<texture::Texture*>* currentTextureSet = nullptr;
+  // Handle bound per texture unit, sized to GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS on the first submit
+  std::vector<GLuint> currentTextures;
+  // Indirect submission
+  GeometryPool pool;
+  buffer::StreamBuffer stream;
+  GLint storageAlignment = 0;
+  OcclusionCuller* occlusion = nullptr;
+  Statistics statistics;
+};
+}  // namespace graphics::render
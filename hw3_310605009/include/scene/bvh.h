@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "scene/culling.h"
+#include "shape/bounds.h"
+#include "shape/shape.h"
+#include "utils.h"
+
+namespace graphics::scene {
+/// World-space axis-aligned box.
+struct Box {
+  glm::vec3 min = glm::vec3(0);
+  glm::vec3 max = glm::vec3(0);
+
+  glm::vec3 getCenter() const { return 0.5f * (min + max); }
+  glm::vec3 getExtent() const { return 0.5f * (max - min); }
+  /// @return Half the surface area, enough for the surface area heuristic's ratios.
+  float getHalfArea() const {
+    glm::vec3 size = max - min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+  }
+  bool overlaps(const Box& box) const {
+    return glm::all(glm::lessThanEqual(min, box.max)) && glm::all(glm::lessThanEqual(box.min, max));
+  }
+  static Box merge(const Box& a, const Box& b) { return {glm::min(a.min, b.min), glm::max(a.max, b.max)}; }
+  /// @brief Box around local bounds transformed by a model matrix.
+  static Box fromBounds(const shape::Bounds& bounds, const glm::mat4& modelMatrix);
+};
+
+struct Ray {
+  glm::vec3 origin = glm::vec3(0);
+  glm::vec3 direction = glm::vec3(0, 0, -1);
+  /// @brief Ray through a point in normalized device coordinates, from the near plane to the far plane.
+  static Ray fromScreen(const glm::mat4& viewProjection, const glm::vec2& ndc);
+};
+
+struct RayHit {
+  int object;
+  // Distance along the ray's (unit) direction to where it enters the object's box, 0 when it starts inside
+  float distance;
+};
+
+/**
+ * @brief Dynamic bounding volume hierarchy over object boxes, one object per leaf.
+ *
+ * update() builds the tree top-down with a binned surface area heuristic. Objects added or removed afterwards are
+ * inserted next to the sibling that grows the tree least and removed by collapsing their parent; moved objects
+ * only refit the boxes of their ancestors. Once this has made the tree's SAH cost rebuildRatio times that of the
+ * last build, update() builds it again.
+ *
+ * When more than 1 / flatCullDivisor of the objects moved, update() leaves the tree unfitted instead, as refitting
+ * it costs more than the query saves. queryFrustum() then tests every object with a FrustumCuller, which mirrors
+ * the objects by id, and the tree is refit by the next update() with fewer moves or the next ray or overlap query.
+ */
+class BoundingVolumeHierarchy {
+ public:
+  struct Statistics {
+    std::size_t objects = 0;
+    std::size_t nodes = 0;
+    // Of the last build
+    int depth = 0;
+    // SAH cost relative to the one right after the last build
+    float costRatio = 1;
+    std::size_t builds = 0;
+    double buildMilliseconds = 0;
+    std::size_t refitLeaves = 0;
+    double refitMilliseconds = 0;
+    // Whether the tree is left unfitted and frustum queries test every object
+    bool isFlatCull = false;
+    // Of the last query
+    std::size_t nodesVisited = 0;
+    double queryMilliseconds = 0;
+  };
+  static constexpr float rebuildRatio = 1.5f;
+  // update() stops refitting the tree once more than 1 / flatCullDivisor of the objects moved.
+  static constexpr std::size_t flatCullDivisor = 32;
+
+  // Shapes added with add(shape) keep a pointer back to this tree.
+  DELETE_COPY(BoundingVolumeHierarchy)
+  DELETE_MOVE(BoundingVolumeHierarchy)
+  BoundingVolumeHierarchy() = default;
+  ~BoundingVolumeHierarchy();
+  /// @return Object id, stable until the object is removed and reused afterwards.
+  int add(const shape::Bounds& bounds, const glm::mat4& modelMatrix);
+  /// @brief Add a shape, its setModelMatrix refits the tree until it is removed.
+  int add(shape::Shape* shape);
+  void remove(int id);
+  void setModelMatrix(int id, const glm::mat4& modelMatrix);
+  /// @brief Apply moved objects and rebuild if the tree has degraded or was never built.
+  void update();
+  /// @brief Build the whole tree from the current objects.
+  void build();
+
+  // Queries see moved objects after the next update().
+  /// @brief Append objects whose box intersects the frustum.
+  void queryFrustum(const Frustum& frustum, std::vector<int>& objects);
+  /// @brief Append objects whose box overlaps the given one.
+  void queryOverlap(const Box& box, std::vector<int>& objects);
+  /// @return Closest object whose box the ray enters within maxDistance.
+  std::optional<RayHit> queryRay(const Ray& ray, float maxDistance = 1e30f);
+
+  const Box& getBox(int id) const { return objects[id].box; }
+  /// @return Shape of an object added with add(shape), otherwise nullptr.
+  shape::Shape* getShape(int id) const { return objects[id].shape; }
+  std::size_t size() const { return objectCount; }
+  const Statistics& getStatistics() const { return statistics; }
+
+ private:
+  struct Node {
+    Box box;
+    int parent = -1;
+    // Both -1 for leaves
+    int children[2] = {-1, -1};
+    // Object of a leaf, -1 for internal nodes
+    int object = -1;
+    bool isLeaf() const { return children[0] < 0; }
+  };
+  struct Object {
+    shape::Bounds bounds;
+    Box box;
+    // Leaf in the tree, -1 when not in it yet or removed
+    int leaf = -1;
+    shape::Shape* shape = nullptr;
+    bool isAlive = false;
+    bool isMoved = false;
+  };
+  struct BuildItem {
+    Box box;
+    glm::vec3 center;
+    int object;
+  };
+
+  int allocateNode();
+  void freeNode(int node);
+  /// @brief Build the subtree over items[first, last) and return its root.
+  int buildRange(std::vector<BuildItem>& items, int first, int last, int parent, int depth);
+  void insertLeaf(int leaf);
+  void removeLeaf(int leaf);
+  /// @brief Recompute boxes from node up to the root, stopping where a box stops changing.
+  void refitAncestors(int node);
+  void refitAll();
+  /// @brief Refit the tree if update() left it unfitted.
+  void refitUnfitted();
+  /// @return SAH cost of the tree, the summed internal node areas over the root's.
+  float computeCost() const;
+
+  std::vector<Node> nodes;
+  std::vector<Object> objects;
+  std::vector<int> freeNodes;
+  std::vector<int> freeObjects;
+  // Objects waiting to be inserted, and inserted objects moved since the last update()
+  std::vector<int> pendingObjects;
+  std::vector<int> movedObjects;
+  // Traversal stacks, kept to avoid allocating per query
+  std::vector<std::pair<int, unsigned>> nodeStack;
+  std::vector<std::pair<int, float>> rayStack;
+  // Object boxes by id for the flat frustum test
+  FrustumCuller culler;
+  int root = -1;
+  std::size_t objectCount = 0;
+  float buildCost = 0;
+  bool isBuilt = false;
+  bool isUnfitted = false;
+  Statistics statistics;
+};
+}  // namespace graphics::scene
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "shape/bounds.h"
+#include "utils.h"
+
+namespace graphics::scene {
+/// Six planes (left, right, bottom, top, near, far) facing inwards, normalized so w is a distance.
+struct Frustum {
+  std::array<glm::vec4, 6> planes;
+  /// @brief Planes of a projection * view matrix with OpenGL's [-1, 1] clip depth.
+  static Frustum fromMatrix(const glm::mat4& viewProjection);
+  /// @brief Scalar reference test of a world-space box given by center and half extent.
+  bool intersects(const glm::vec3& center, const glm::vec3& extent) const;
+};
+
+/**
+ * @brief Frustum culling of many objects, bounds are kept as structure of arrays.
+ *
+ * Each cull transforms the local boxes by their model matrices and tests them against the frustum four at a time
+ * with SSE (one at a time without it). Object counts above threadThreshold are split across threads.
+ */
+class FrustumCuller {
+ public:
+  struct Statistics {
+    std::size_t tested = 0;
+    std::size_t culled = 0;
+    double milliseconds = 0;
+    int threads = 0;
+  };
+  // Objects per thread before cull() splits the work
+  static constexpr int threadThreshold = 1 << 14;
+
+  MOVE_ONLY(FrustumCuller)
+  FrustumCuller() = default;
+  /// @brief Remove all objects, storage is kept.
+  void clear();
+  /// @return Index of the object for isVisible.
+  std::size_t add(const shape::Bounds& bounds, const glm::mat4& modelMatrix);
+  /// @brief Replace the bounds and model matrix of an added object.
+  void set(std::size_t index, const shape::Bounds& bounds, const glm::mat4& modelMatrix);
+  /// @brief Replace the model matrix of an added object.
+  void setModelMatrix(std::size_t index, const glm::mat4& modelMatrix);
+  void cull(const glm::mat4& viewProjection) { cull(Frustum::fromMatrix(viewProjection)); }
+  void cull(const Frustum& frustum);
+  /// @return Whether the object intersected the frustum in the last cull().
+  bool isVisible(std::size_t index) const { return visible[index] != 0; }
+  std::size_t size() const { return count; }
+  const Statistics& getStatistics() const { return statistics; }
+
+ private:
+  /// @brief Cull objects [first, last), first is a multiple of 4, returns the number culled.
+  std::size_t cullRange(const Frustum& frustum, std::size_t first, std::size_t last);
+
+  std::size_t count = 0;
+  // Local box center and half extent
+  std::array<std::vector<float>, 3> center, extent;
+  // Rows 0 ~ 2 of the model matrices, model[row * 4 + column]
+  std::array<std::vector<float>, 12> model;
+  std::vector<uint8_t> visible;
+  Statistics statistics;
+};
+}  // namespace graphics::scene
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "shader/std140.h"
+
+namespace graphics::shader {
+/// Uniform block "camera", streamed once per frame.
+struct CameraBlock {
+  // Projection * View matrix
+  glm::mat4 viewProjectionMatrix;
+  // Position of the camera
+  glm::vec4 viewPosition;
+};
+
+namespace std140 {
+template <>
+struct Layout<CameraBlock> {
+  static constexpr std::string_view name = "camera";
+  static constexpr Member members[] = {STD140_MEMBER(CameraBlock, viewProjectionMatrix),
+                                        STD140_MEMBER(CameraBlock, viewPosition)};
+};
+
+static_assert(verify<CameraBlock>());
+}  // namespace std140
+}  // namespace graphics::shader
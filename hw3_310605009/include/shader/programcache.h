@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "shader/program.h"
+#include "utils.h"
+
+namespace graphics::shader {
+constexpr uint32_t programFileVersion = 1;
+
+/// Header of a program file, followed by the binary, stored in native byte order.
+struct ProgramFileHeader {
+  char magic[4];
+  uint32_t version;
+  // Cache key the binary was linked from
+  uint64_t key;
+  uint32_t format;
+  uint32_t size;
+};
+
+/// One stage of a program, the whole source of a shader file.
+struct ShaderSource {
+  GLenum type;
+  std::string code;
+  // Of code, so keys need not hash it again. 0 has build() hash code.
+  uint64_t hash = 0;
+
+  /// @return The stage compiled from file, with its includes expanded.
+  static ShaderSource fromFile(GLenum type, const utils::fs::path& file);
+};
+
+/**
+ * @brief Builds programs from source and keeps their linked binaries on disk.
+ *
+ * Keys hash the stage sources, the preamble and the driver's vendor, renderer and version strings, so an edited
+ * shader or an updated driver selects another file. Binaries the driver rejects are compiled again and replaced.
+ * build() first loads what it can, then compiles and links every remaining program before asking for the first
+ * status, so drivers compile them in parallel (KHR_parallel_shader_compile is given all threads when available).
+ */
+class ProgramCache {
+ public:
+  struct Statistics {
+    // Programs loaded from binaries
+    std::size_t hits = 0;
+    // Programs compiled from source, including when the cache is disabled
+    std::size_t misses = 0;
+    // Reading and loading binaries, rejected ones included
+    double loadMilliseconds = 0;
+    // From the first compile to the last link status of the misses, writing binaries excluded
+    double compileMilliseconds = 0;
+  };
+
+  /// @brief Directory of the binaries, created on demand. Empty (the default) disables the cache.
+  static void setDirectory(const utils::fs::path& path) { directory = path; }
+  /// @brief Queue program to be built from stages by the next build(), preamble goes after each #version line.
+  static void add(ShaderProgram* program, std::vector<ShaderSource> stages, std::string preamble = {});
+  /// @brief Build every queued program. Programs that fail to link report it and stay unlinked.
+  static void build();
+  static const Statistics& getStatistics() { return statistics; }
+
+ private:
+  struct Request {
+    ShaderProgram* program;
+    std::vector<ShaderSource> stages;
+    std::string preamble;
+  };
+  static uint64_t makeKey(const Request& request, const std::string& driver);
+  static bool load(ShaderProgram& program, uint64_t key);
+  static void store(const ShaderProgram& program, uint64_t key);
+
+  static utils::fs::path directory;
+  static std::vector<Request> requests;
+  static Statistics statistics;
+};
+}  // namespace graphics::shader
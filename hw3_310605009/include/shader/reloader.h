@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "file_watcher.h"
+#include "shader/program.h"
+#include "shader/shader.h"
+#include "utils.h"
+
+namespace graphics::shader {
+/**
+ * @brief Rebuilds programs whose shader files, or files they include, change on disk, without stalling the render loop.
+ *
+ * update(), called once per frame, compiles the programs of changed files and starts linking them. A later update()
+ * finds the link done (each frame, with KHR_parallel_shader_compile; otherwise the first update waits for it) and
+ * swaps the new program into the registered ShaderProgram object, so everything pointing at it draws with it from
+ * then on. The old program's uniform values and block bindings are copied over first, then the entry's callback
+ * runs, e.g. to look up moved uniform locations. A program that fails to build is reported and the old one stays.
+ */
+class ShaderReloader {
+ public:
+  struct Statistics {
+    std::size_t reloads = 0;
+    std::size_t failures = 0;
+    // From the file change being seen to the swap, of the last reload
+    double lastMilliseconds = 0;
+  };
+  using Callback = std::function<void(ShaderProgram&)>;
+
+  DELETE_COPY(ShaderReloader)
+  DELETE_MOVE(ShaderReloader)
+  ShaderReloader() = default;
+  /**
+   * @brief Rebuild program from the stage files when any of them changes.
+   *
+   * @param preamble Passed to Shader::fromString, as when the program was first built.
+   * @param onReload Run after the swap.
+   */
+  void add(ShaderProgram* program,
+           std::vector<std::pair<GLenum, utils::fs::path>> stages,
+           std::string preamble = {},
+           Callback onReload = {});
+  /// @brief Stop watching program, e.g. before it is destroyed.
+  void remove(const ShaderProgram* program);
+  /// @brief Start rebuilds of changed programs and swap in the finished ones. Call on the GL thread.
+  void update();
+  const Statistics& getStatistics() const { return statistics; }
+  /// @return Whether changes come from inotify rather than polling.
+  bool isNotifying() const { return watcher.isNotifying(); }
+
+ private:
+  struct Entry {
+    ShaderProgram* program;
+    std::vector<std::pair<GLenum, utils::fs::path>> stages;
+    std::string preamble;
+    Callback onReload;
+    // Stage files and their includes, as of the last build
+    std::vector<utils::fs::path> dependencies;
+    // Set when a file changed, cleared when the rebuild starts
+    bool isDirty = false;
+    std::chrono::steady_clock::time_point changeTime;
+    // Rebuild in flight
+    std::unique_ptr<ShaderProgram> candidate;
+    std::vector<std::unique_ptr<Shader>> shaders;
+  };
+  /// @brief Expand the stage files, and watch and record what they include. @return The expanded stages.
+  std::vector<std::string> expand(Entry& entry);
+  void start(Entry& entry);
+  void finish(Entry& entry);
+
+  utils::FileWatcher watcher;
+  std::vector<Entry> entries;
+  Statistics statistics;
+};
+}  // namespace graphics::shader
@@ -0,0 +1,79 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <glad/gl.h>
+
+#include "utils.h"
+namespace graphics::shader {
+/// @return Contents of a shader file, empty (and reported) if it cannot be opened.
+std::string readFile(const utils::fs::path& filename);
+
+class Shader {
+ public:
+  MOVE_ONLY(Shader)
+  explicit Shader(GLenum shaderType) noexcept;
+  virtual ~Shader();
+  CONSTEXPR_VIRTUAL virtual const char* getTypeName() const = 0;
+  CONSTEXPR_VIRTUAL virtual GLenum getType() const = 0;
+  GLuint getHandle() const;
+  bool checkCompileState() const;
+  /**
+   * @brief Compile the file with its includes expanded, preamble goes right after its #version line.
+   *
+   * The preamble is where generated block declarations and the #define lines of permutations are injected.
+   */
+  void fromFile(const utils::fs::path& filename, std::string_view preamble = {}) const;
+  void fromString(const std::string& shadercode, std::string_view preamble = {}) const;
+
+ protected:
+  GLuint handle;
+};
+
+class ComputeShader final : public Shader {
+ public:
+  ComputeShader() noexcept : Shader(GL_COMPUTE_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Compute shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_COMPUTE_SHADER; }
+};
+
+class VertexShader final : public Shader {
+ public:
+  VertexShader() noexcept : Shader(GL_VERTEX_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Vertex shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_VERTEX_SHADER; }
+};
+
+class TessControlShader final : public Shader {
+ public:
+  TessControlShader() noexcept : Shader(GL_TESS_CONTROL_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Tessellation control shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_TESS_CONTROL_SHADER; }
+};
+
+class TessEvaluationShader final : public Shader {
+ public:
+  TessEvaluationShader() noexcept : Shader(GL_TESS_EVALUATION_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Tessellation evaluation shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_TESS_EVALUATION_SHADER; }
+};
+
+class GeometryShader final : public Shader {
+ public:
+  GeometryShader() noexcept : Shader(GL_GEOMETRY_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Geometry shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_GEOMETRY_SHADER; }
+};
+
+class FragmentShader final : public Shader {
+ public:
+  MOVE_ONLY(FragmentShader)
+  FragmentShader() noexcept : Shader(GL_FRAGMENT_SHADER) {}
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Fragment shader"; }
+  CONSTEXPR_VIRTUAL GLenum getType() const override { return GL_FRAGMENT_SHADER; }
+};
+
+/// @return A shader of the GL shader type, throws std::invalid_argument for unknown types.
+std::unique_ptr<Shader> createShader(GLenum type);
+}  // namespace graphics::shader
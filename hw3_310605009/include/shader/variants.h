@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "shader/program.h"
+#include "shader/reloader.h"
+#include "utils.h"
+namespace graphics::shader {
+/**
+ * @brief Permutations of one vertex / fragment shader pair, selected by feature bits.
+ *
+ * Bit i of a key defines features[i] (as 1) in both stages, so shaders test features with #ifdef instead of
+ * branching on uniforms. Variants are built through ProgramCache on first use and kept, their addresses stay valid
+ * for the lifetime of the table, so switching features only swaps the program a mesh points to.
+ */
+class ProgramVariants {
+ public:
+  using Key = uint32_t;
+  static constexpr std::size_t maxFeatures = 32;
+
+  DELETE_COPY(ProgramVariants)
+  DELETE_MOVE(ProgramVariants)
+  /**
+   * @brief Variants are compiled from the files as they are when the variant is built.
+   *
+   * @param preamble Code every variant gets after the defines, e.g. generated block declarations.
+   */
+  ProgramVariants(const utils::fs::path& vertexFile,
+                  const utils::fs::path& fragmentFile,
+                  std::vector<std::string> features,
+                  std::string preamble = {});
+  /// @brief Run on every newly linked variant, for block bindings, sampler units and other constant uniforms.
+  void setInitializer(std::function<void(ShaderProgram&)> _initializer) { initializer = std::move(_initializer); }
+  /// @brief Register variants built from now on with reloader, which runs the initializer after each reload.
+  void setReloader(ShaderReloader* _reloader) { reloader = _reloader; }
+  /// @return The variant with the features of key, compiled and initialized on the first call.
+  ShaderProgram& get(Key key);
+  /// @brief Build the variants of keys not built yet in one ProgramCache::build, with anything else queued there.
+  void prepare(std::initializer_list<Key> keys);
+  /// @return Defines of the features in key, one "#define NAME 1" line each.
+  std::string getDefines(Key key) const;
+  /// @brief Call f on every variant compiled so far.
+  void forEach(const std::function<void(Key, ShaderProgram&)>& f);
+  std::size_t getCompiledCount() const { return variants.size(); }
+
+ private:
+  /// @brief Key without bits past the last feature, which would build the same program again.
+  Key mask(Key key) const;
+
+  utils::fs::path vertexFile;
+  utils::fs::path fragmentFile;
+  std::vector<std::string> features;
+  std::string preamble;
+  std::function<void(ShaderProgram&)> initializer;
+  ShaderReloader* reloader = nullptr;
+  std::unordered_map<Key, std::unique_ptr<ShaderProgram>> variants;
+};
+}  // namespace graphics::shader
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "vertexformat.h"
+
+namespace graphics::shape {
+/// Axis-aligned box and bounding sphere of a mesh in its local space.
+struct Bounds {
+  glm::vec3 min = glm::vec3(0);
+  glm::vec3 max = glm::vec3(0);
+  // The sphere is centered on the box, its radius reaches the farthest vertex.
+  glm::vec3 center = glm::vec3(0);
+  float radius = 0;
+
+  glm::vec3 getExtent() const { return 0.5f * (max - min); }
+  /// @brief Bounds of a box, the sphere is the one through its corners.
+  static Bounds fromBox(const glm::vec3& min, const glm::vec3& max);
+  /// @brief Bounds larger than any scene, for meshes whose positions cannot be read back.
+  static Bounds unbounded() { return fromBox(glm::vec3(-1e18f), glm::vec3(1e18f)); }
+  /**
+   * @brief Bounds of the positions (attribute 0) of vertex data in the given layout.
+   *
+   * Float positions and normalized unsigned short ones (QuantizedVertex, in [0, 1] before the positionScale /
+   * positionBias decode) are read, other formats are unbounded.
+   */
+  static Bounds fromVertices(const void* vertices, std::size_t size, const VertexLayout& layout);
+};
+}  // namespace graphics::shape
@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "geometry.h"
+#include "shape.h"
+
+namespace graphics::shape {
+class Cube final : public Shape {
+ public:
+  Cube();
+  /// Shapes built from identical data share one copy on the GPU.
+  Cube(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices);
+  static void generateVertices(std::vector<GLfloat>& vertex, std::vector<GLubyte>& index);
+
+  void draw() const override;
+  Geometry* getGeometry() const override { return geometry.get(); }
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Cube"; }
+  CONSTEXPR_VIRTUAL ShapeType getType() const override { return ShapeType::Cube; }
+  template <typename... Args>
+  static std::unique_ptr<Cube> make_unique(Args&&... args) {
+    return std::make_unique<Cube>(std::forward<Args>(args)...);
+  }
+
+ private:
+  GeometryPTR geometry;
+};
+using CubePTR = std::unique_ptr<Cube>;
+};  // namespace graphics::shape
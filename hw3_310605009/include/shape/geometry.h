@@ -0,0 +1,196 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "buffer/buffer.h"
+#include "buffer/vertexarray.h"
+#include "bounds.h"
+#include "utils.h"
+#include "vertexformat.h"
+
+namespace graphics::shape {
+/// GPU buffers of one mesh, shared by every shape drawn with it.
+class Geometry {
+ public:
+  DELETE_COPY(Geometry)
+  DELETE_MOVE(Geometry)
+  /**
+   * @param size Bytes of vertex data.
+   * @param primitive GL_TRIANGLE_STRIP enables primitive restart on draw.
+   */
+  template <typename Index>
+  Geometry(const void* vertices,
+           std::size_t size,
+           const std::vector<Index>& indices,
+           const VertexLayout& _layout,
+           GLenum _primitive = GL_TRIANGLES)
+      : layout(_layout), bounds(Bounds::fromVertices(vertices, size, _layout)), primitive(_primitive), id(++lastId) {
+    vbo.allocate_load(size, vertices);
+    ebo.allocate_load(indices);
+    bindAttributes();
+  }
+
+  /// @brief Upload indices already stored as indexType, e.g. from a mapped MeshFile.
+  Geometry(const void* vertices,
+           std::size_t size,
+           const void* indices,
+           GLsizei indexCount,
+           GLenum indexType,
+           const VertexLayout& _layout,
+           GLenum _primitive = GL_TRIANGLES);
+
+  void draw();
+  /// @brief Bind the vertex array for drawBound, lets renderers skip rebinding it between draws of one mesh.
+  void bind() { vao.bind(); }
+  /// @brief Draw with the vertex array already bound by bind(), leaves it bound.
+  void drawBound();
+  GLuint getVertexArrayHandle() const { return vao.getHandle(); }
+  /// @return Bytes of vertex and index data on the GPU.
+  std::size_t getSize() const { return vbo.getSize() + ebo.getSize(); }
+  const VertexLayout& getLayout() const { return layout; }
+  /// @return Local-space bounds of the vertices, computed once when the geometry is created.
+  const Bounds& getBounds() const { return bounds; }
+  GLenum getPrimitive() const { return primitive; }
+  const buffer::ArrayBuffer& getVertexBuffer() const { return vbo; }
+  const buffer::ElementArrayBuffer& getIndexBuffer() const { return ebo; }
+  /// @return Unique among all geometry ever created, unlike addresses it is never reused.
+  uint64_t getId() const { return id; }
+
+ private:
+  void bindAttributes();
+
+  buffer::VertexArray vao;
+  buffer::ArrayBuffer vbo;
+  buffer::ElementArrayBuffer ebo;
+  VertexLayout layout;
+  Bounds bounds;
+  GLenum primitive;
+  uint64_t id;
+  static uint64_t lastId;
+};
+using GeometryPTR = std::shared_ptr<Geometry>;
+using GeometryKey = uint64_t;
+
+/// @brief 64-bit FNV-1a, pass the previous result as hash to chain.
+inline GeometryKey hashBytes(const void* data, std::size_t size, GeometryKey hash = 14695981039346656037ull) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+/// @brief Key of generated geometry, e.g. makeGeometryKey(ShapeType::Sphere, stack, slice).
+template <typename... Params>
+GeometryKey makeGeometryKey(Params... params) {
+  static_assert(((std::is_arithmetic_v<Params> || std::is_enum_v<Params>) && ...),
+                "Only arithmetic and enum parameters can be hashed");
+  GeometryKey hash = 14695981039346656037ull;
+  ((hash = hashBytes(&params, sizeof(Params), hash)), ...);
+  return hash;
+}
+/**
+ * @brief Cache of live geometry, each unique mesh is generated and uploaded once while some shape holds it.
+ *
+ * Entries are weak, geometry is freed with the last shape using it. Must be used on the OpenGL context thread.
+ */
+class GeometryRegistry {
+ public:
+  struct Statistics {
+    // Calls to get
+    std::size_t requests = 0;
+    // Meshes generated and uploaded
+    std::size_t uploads = 0;
+    // Bytes uploaded in total
+    std::size_t uploadedBytes = 0;
+    // Time spent in create, i.e. generation and upload
+    double uploadMilliseconds = 0;
+  };
+
+  /**
+   * @brief Find the geometry of key, or build it with create() when no shape holds it anymore.
+   *
+   * @param create Callable returning GeometryPTR.
+   */
+  template <typename Create>
+  static GeometryPTR get(GeometryKey key, Create&& create) {
+    ++statistics.requests;
+    if (GeometryPTR geometry = find(key, nullptr)) return geometry;
+    auto start = std::chrono::steady_clock::now();
+    GeometryPTR geometry = create();
+    add(key, nullptr, geometry, start);
+    return geometry;
+  }
+  /**
+   * @brief Find geometry of the same content, or build it with create().
+   *
+   * The content is hashed for the lookup and compared byte for byte on a hit, so colliding meshes never share
+   * geometry. Entries keep a copy of it while they are in the table.
+   * @param size Bytes of vertex data.
+   * @param tag Separates layouts and primitives with the same bytes.
+   */
+  template <typename Index, typename Create>
+  static GeometryPTR get(const void* vertices,
+                         std::size_t size,
+                         const std::vector<Index>& indices,
+                         uint64_t tag,
+                         Create&& create) {
+    ++statistics.requests;
+    const Content content = {tag, sizeof(Index), vertices, size, indices.data(), indices.size() * sizeof(Index)};
+    const GeometryKey key = hashContent(content);
+    if (GeometryPTR geometry = find(key, &content)) return geometry;
+    auto start = std::chrono::steady_clock::now();
+    GeometryPTR geometry = create();
+    add(key, &content, geometry, start);
+    return geometry;
+  }
+
+  static const Statistics& getStatistics() { return statistics; }
+  /// @return Number of unique meshes alive.
+  static std::size_t getLiveCount();
+  /// @return Bytes of vertex and index data held by live meshes.
+  static std::size_t getLiveSize();
+
+ private:
+  // Geometry given by its data rather than by generator parameters
+  struct Content {
+    uint64_t tag;
+    std::size_t indexSize;
+    const void* vertices;
+    std::size_t vertexBytes;
+    const void* indices;
+    std::size_t indexBytes;
+  };
+  struct Entry {
+    std::weak_ptr<Geometry> geometry;
+    // Unset for geometry keyed by makeGeometryKey, else its Content with the pointers cleared
+    std::optional<Content> content;
+    // Copy of the vertices, then the indices
+    std::vector<unsigned char> bytes;
+  };
+
+  static GeometryKey hashContent(const Content& content);
+  /// @return Live geometry of key created from the same content (nullptr for makeGeometryKey), or nullptr.
+  static GeometryPTR find(GeometryKey key, const Content* content);
+  /// @brief Count the upload started at start and store geometry under key.
+  static void add(GeometryKey key,
+                  const Content* content,
+                  const GeometryPTR& geometry,
+                  std::chrono::steady_clock::time_point start);
+  /// @brief Erase entries whose geometry was freed.
+  static void prune();
+
+  static std::unordered_map<GeometryKey, Entry> registry;
+  // Table size that triggers the next prune
+  static std::size_t pruneSize;
+  static Statistics statistics;
+};
+}  // namespace graphics::shape
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "utils.h"
+
+namespace graphics::shape {
+/// Floats per imported vertex: position, normal, texture coordinate (same layout as Sphere).
+constexpr int importedVertexStride = 8;
+
+struct ImportStatistics {
+  // Bytes of the source files
+  std::size_t bytes = 0;
+  std::size_t vertices = 0;
+  std::size_t triangles = 0;
+  double milliseconds = 0;
+};
+
+/**
+ * @brief Import a Wavefront OBJ file as an indexed triangle list.
+ *
+ * The file is memory-mapped and its lines are parsed by all cores, polygons are fan-triangulated and identical
+ * position / texture coordinate / normal triplets become one vertex. Missing normals are smoothed from the faces.
+ * Materials, groups and line elements are ignored. Throws std::runtime_error on malformed files.
+ */
+ImportStatistics importOBJ(const utils::fs::path& filename,
+                           std::vector<GLfloat>& vertices,
+                           std::vector<GLuint>& indices);
+/**
+ * @brief Import every triangle primitive of a glTF 2.0 file (.gltf with external buffers, or .glb).
+ *
+ * Buffers are memory-mapped and accessors are read in place. Meshes are placed by the nodes of the default scene
+ * (or of every root node without scenes) and merged, files without nodes keep them in their local space. Materials
+ * and embedded (data URI) buffers are not supported. Throws std::runtime_error on malformed files.
+ */
+ImportStatistics importGLTF(const utils::fs::path& filename,
+                            std::vector<GLfloat>& vertices,
+                            std::vector<GLuint>& indices);
+/// @brief Pick importOBJ or importGLTF by file extension.
+ImportStatistics importMesh(const utils::fs::path& filename,
+                            std::vector<GLfloat>& vertices,
+                            std::vector<GLuint>& indices);
+}  // namespace graphics::shape
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "buffer/vertexarray.h"
+#include "geometry.h"
+#include "mapped_file.h"
+#include "vertexformat.h"
+#include "utils.h"
+
+namespace graphics::shape {
+constexpr uint32_t meshFileVersion = 2;
+/// Revision of the shape generators, the importer and optimizeMesh. Bump it when their output changes, cached meshes
+/// of older revisions are regenerated.
+constexpr uint32_t meshGeneratorRevision = 2;
+/// Vertex and index blobs start at multiples of this, relative to the (page-aligned) mapping.
+constexpr std::size_t meshFileAlignment = 64;
+
+/// Header at offset 0 of a mesh file, stored in native byte order.
+struct MeshFileHeader {
+  char magic[4];
+  uint32_t version;
+  // Revision of the code that generated the mesh
+  uint32_t revision;
+  // Cache key the mesh was generated from
+  uint64_t key;
+  VertexLayout layout;
+  uint32_t primitive;
+  uint32_t indexType;
+  uint64_t vertexCount;
+  uint64_t indexCount;
+  uint64_t vertexOffset;
+  uint64_t indexOffset;
+  // Bounds of attribute 0, zero if it is not 3 floats
+  float boundsMin[3];
+  float boundsMax[3];
+};
+
+/// Versioned binary mesh, mapped read-only so its blobs can be uploaded without parsing or copying.
+class MeshFile {
+ public:
+  MOVE_ONLY(MeshFile)
+  /// @brief Map and validate a mesh file, throws std::runtime_error on bad magic, version or truncated data.
+  explicit MeshFile(const utils::fs::path& path);
+  /**
+   * @brief Write a mesh file, indices are stored in the narrowest type (restart indices are kept).
+   *
+   * Written with utils::writeCacheFile, readers never see partial files and failures are reported, not thrown.
+   * @return Whether the file was written.
+   */
+  static bool write(const utils::fs::path& path,
+                    GeometryKey key,
+                    uint32_t revision,
+                    const VertexLayout& layout,
+                    const void* vertices,
+                    std::size_t vertexCount,
+                    const std::vector<GLuint>& indices,
+                    GLenum primitive = GL_TRIANGLES);
+
+  const MeshFileHeader& getHeader() const { return *reinterpret_cast<const MeshFileHeader*>(file.data()); }
+  const void* getVertices() const { return file.data() + getHeader().vertexOffset; }
+  const void* getIndices() const { return file.data() + getHeader().indexOffset; }
+  /// @brief Upload the blobs straight from the mapping.
+  GeometryPTR upload() const;
+
+ private:
+  utils::MappedFile file;
+};
+
+/**
+ * @brief Mesh files of generated geometry, named by cache key.
+ *
+ * Keys come from makeGeometryKey over the generator parameters, so changing any parameter selects another file.
+ * Entries written by another format version, generator revision, layout or primitive are regenerated and replaced.
+ */
+class MeshCache {
+ public:
+  struct Statistics {
+    // Meshes loaded from the cache
+    std::size_t hits = 0;
+    // Meshes generated, including when the cache is disabled
+    std::size_t misses = 0;
+    // Map and upload time of hits
+    double loadMilliseconds = 0;
+    // Generation and upload time of misses, writing the cache excluded
+    double generateMilliseconds = 0;
+  };
+  using Generator = std::function<void(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices)>;
+
+  /// @brief Directory of the cache files, created on demand. Empty (the default) disables the cache.
+  static void setDirectory(const utils::fs::path& path) { directory = path; }
+  /**
+   * @brief Upload the mesh of key from its cache file, or from generate() and write the cache file.
+   *
+   * @param layout Layout of the generated floats.
+   */
+  static GeometryPTR load(GeometryKey key,
+                          const VertexLayout& layout,
+                          const Generator& generate,
+                          GLenum primitive = GL_TRIANGLES);
+  static const Statistics& getStatistics() { return statistics; }
+
+ private:
+  static utils::fs::path directory;
+  static Statistics statistics;
+};
+}  // namespace graphics::shape
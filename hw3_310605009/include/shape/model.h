@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <utility>
+
+#include <glad/gl.h>
+
+#include "geometry.h"
+#include "importer.h"
+#include "shape.h"
+
+namespace graphics::shape {
+class Model final : public Shape {
+ public:
+  /**
+   * @brief Import an OBJ or glTF file, see importMesh.
+   *
+   * Models of the same file share one mesh on the GPU. Imports go through MeshCache keyed by path, size and
+   * modification time, so unchanged files are mapped from the cache on later runs (glTF .bin edits alone are not
+   * noticed).
+   */
+  explicit Model(const utils::fs::path& filename);
+  void draw() const override;
+  Geometry* getGeometry() const override { return geometry.get(); }
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Model"; }
+  CONSTEXPR_VIRTUAL ShapeType getType() const override { return ShapeType::Model; }
+  template <typename... Args>
+  static std::unique_ptr<Model> make_unique(Args&&... args) {
+    return std::make_unique<Model>(std::forward<Args>(args)...);
+  }
+  /// @return Statistics of the import, all zero when the mesh was shared or loaded from the cache.
+  const ImportStatistics& getImportStatistics() const { return statistics; }
+
+ private:
+  GeometryPTR geometry;
+  ImportStatistics statistics;
+};
+using ModelPTR = std::unique_ptr<Model>;
+}  // namespace graphics::shape
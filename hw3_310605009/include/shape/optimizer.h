@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace graphics::shape {
+/// Post-transform vertex cache behaviour of an indexed triangle list.
+struct VertexCacheStatistics {
+  // Vertex shader invocations, i.e. cache misses
+  std::size_t transformedVertices = 0;
+  // Average cache miss ratio: transformed vertices per triangle, 0.5 is the optimum for large grids.
+  float acmr = 0;
+  // Average transformed vertex ratio: transformed vertices per referenced vertex, 1.0 is the optimum.
+  float atvr = 0;
+};
+
+struct MeshOptimizationReport {
+  VertexCacheStatistics before;
+  VertexCacheStatistics after;
+};
+
+/**
+ * @brief Simulate a FIFO post-transform vertex cache over a triangle list.
+ *
+ * @param cacheSize Entries of the simulated cache, 16 is a conservative estimate for current GPUs.
+ */
+VertexCacheStatistics analyzeVertexCache(const std::vector<GLuint>& indices,
+                                         std::size_t vertexCount,
+                                         int cacheSize = 16);
+/// @brief Reorder triangles for post-transform cache locality (Tom Forsyth's linear-speed algorithm).
+void optimizeVertexCache(std::vector<GLuint>& indices, std::size_t vertexCount);
+/**
+ * @brief Reorder vertices in order of first use so that fetches are sequential, unreferenced vertices are dropped.
+ *
+ * @param stride Floats per vertex.
+ * @return Number of vertices left.
+ */
+std::size_t optimizeVertexFetch(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, int stride);
+/// @brief Run both optimizations on a triangle list and report the cache statistics before and after.
+MeshOptimizationReport optimizeMesh(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, int stride);
+}  // namespace graphics::shape
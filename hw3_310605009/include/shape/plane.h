@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "geometry.h"
+#include "shape.h"
+#include "vertexformat.h"
+
+namespace graphics::shape {
+class Plane final : public Shape {
+ public:
+  /// Planes with the same parameters share one mesh on the GPU.
+  explicit Plane(int subdivision = 1, float width = 1, float height = 1, bool scaleTexture = true);
+  /**
+   * @brief Shapes built from identical data (same format and primitive) share one copy on the GPU.
+   *
+   * @param primitive GL_TRIANGLES for indices from generateVertices, GL_TRIANGLE_STRIP for indices from
+   * generateStripIndices.
+   */
+  Plane(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices, GLenum primitive = GL_TRIANGLES);
+  Plane(const std::vector<PackedVertex>& vertices,
+        const std::vector<GLuint>& indices,
+        GLenum primitive = GL_TRIANGLES);
+  /// Positions are decoded by the positionScale / positionBias uniforms, see generateVertices.
+  Plane(const std::vector<QuantizedVertex>& vertices,
+        const std::vector<GLuint>& indices,
+        GLenum primitive = GL_TRIANGLES);
+  static void generateVertices(std::vector<GLfloat>& vertex,
+                               std::vector<GLuint>& index,
+                               int subdivision = 1,
+                               float width = 1,
+                               float height = 1,
+                               bool scaleTexture = true);
+  /**
+   * @brief Generate the grid into caller-provided storage (e.g. a mapped buffer), rows are split across threads.
+   *
+   * @param vertex At least getVertexCount(subdivision) * vertexStride floats.
+   * @param index At least getIndexCount(subdivision) indices.
+   */
+  static void generateVertices(GLfloat* vertex,
+                               GLuint* index,
+                               int subdivision = 1,
+                               float width = 1,
+                               float height = 1,
+                               bool scaleTexture = true);
+  /// @brief Generate the grid as PackedVertex, 24 instead of 56 bytes per vertex.
+  static void generateVertices(std::vector<PackedVertex>& vertex,
+                               std::vector<GLuint>& index,
+                               int subdivision = 1,
+                               float width = 1,
+                               float height = 1,
+                               bool scaleTexture = true);
+  /**
+   * @brief Generate the grid as QuantizedVertex, 20 instead of 56 bytes per vertex.
+   *
+   * @param quantization Receives the position decode, the grid spans exactly the unorm16 range.
+   */
+  static void generateVertices(std::vector<QuantizedVertex>& vertex,
+                               std::vector<GLuint>& index,
+                               PositionQuantization& quantization,
+                               int subdivision = 1,
+                               float width = 1,
+                               float height = 1,
+                               bool scaleTexture = true);
+  /**
+   * @brief Encode the grid as one triangle strip per row, separated by ElementArrayBuffer::restartIndex.
+   *
+   * Same triangles and winding as generateVertices, in about a third of the indices.
+   */
+  static void generateStripIndices(std::vector<GLuint>& index, int subdivision = 1);
+  /// @return Number of vertices of a grid with given subdivision.
+  static constexpr std::size_t getVertexCount(int subdivision) {
+    return static_cast<std::size_t>(subdivision + 1) * (subdivision + 1);
+  }
+  /// @return Number of indices of a grid with given subdivision.
+  static constexpr std::size_t getIndexCount(int subdivision) {
+    return static_cast<std::size_t>(subdivision) * subdivision * 6;
+  }
+  /// @return Number of strip indices (restart indices included) of a grid with given subdivision.
+  static constexpr std::size_t getStripIndexCount(int subdivision) {
+    return subdivision > 0 ? static_cast<std::size_t>(subdivision) * (2 * subdivision + 3) - 1 : 0;
+  }
+  /// Floats per vertex.
+  static constexpr int vertexStride = 14;
+
+  void draw() const override;
+  Geometry* getGeometry() const override { return geometry.get(); }
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Plane"; }
+  CONSTEXPR_VIRTUAL ShapeType getType() const override { return ShapeType::Plane; }
+  template <typename... Args>
+  static std::unique_ptr<Plane> make_unique(Args&&... args) {
+    return std::make_unique<Plane>(std::forward<Args>(args)...);
+  }
+
+ private:
+  static GeometryPTR makeGeometry(const void* vertices,
+                                 std::size_t size,
+                                 const std::vector<GLuint>& indices,
+                                 VertexFormat format,
+                                 GLenum primitive);
+  void acquireGeometry(const void* vertices,
+                       std::size_t size,
+                       const std::vector<GLuint>& indices,
+                       VertexFormat format);
+
+  GeometryPTR geometry;
+  GLenum primitive;
+};
+using PlanePTR = std::unique_ptr<Plane>;
+};  // namespace graphics::shape
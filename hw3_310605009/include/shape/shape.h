@@ -0,0 +1,65 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "bounds.h"
+#include "utils.h"
+namespace graphics::shape {
+class Geometry;
+enum class ShapeType : uint8_t { Cube, Sphere, Plane, Model };
+class Shape {
+ public:
+  Shape() noexcept : modelMatrix(1), normalMatrix(1) {}
+  virtual ~Shape() = default;
+  void registerPreDrawFunction(std::function<void()> callback) { preDrawCallback = std::move(callback); }
+  void registerPostDrawFunction(std::function<void()> callback) { postDrawCallback = std::move(callback); }
+  /// @brief Called by setModelMatrix, e.g. to refit a scene hierarchy holding the shape.
+  void registerTransformFunction(std::function<void()> callback) { transformCallback = std::move(callback); }
+  virtual void draw() const = 0;
+  /// @return GPU mesh drawn by draw(), for renderers that sort and batch draws themselves.
+  virtual Geometry* getGeometry() const = 0;
+  /// @brief Run the registered pre draw callback, draw() does this around getGeometry()->draw().
+  void preDraw() const {
+    if (preDrawCallback) preDrawCallback();
+  }
+  /// @brief Run the registered post draw callback.
+  void postDraw() const {
+    if (postDrawCallback) postDrawCallback();
+  }
+  bool hasDrawCallbacks() const { return preDrawCallback || postDrawCallback; }
+  CONSTEXPR_VIRTUAL virtual const char* getTypeName() const = 0;
+  CONSTEXPR_VIRTUAL virtual ShapeType getType() const = 0;
+
+  void setModelMatrix(const glm::mat4& _modelMatrix) {
+    modelMatrix = _modelMatrix;
+    normalMatrix = glm::mat4(glm::inverseTranspose(glm::mat3(modelMatrix)));
+    if (transformCallback) transformCallback();
+  }
+
+  glm::mat4 getModelMatrix() const { return modelMatrix; }
+  const float* getModelMatrixPTR() const { return glm::value_ptr(modelMatrix); }
+  glm::mat4 getNormalMatrix() const { return normalMatrix; }
+  const float* getNormalMatrixPTR() const { return glm::value_ptr(normalMatrix); }
+  /// @return Local-space bounds, those of the geometry unless replaced with setLocalBounds.
+  const Bounds& getLocalBounds() const { return localBounds; }
+  /// @brief Replace the bounds, e.g. for positions decoded or displaced in the vertex shader.
+  void setLocalBounds(const Bounds& bounds) { localBounds = bounds; }
+
+ protected:
+  std::function<void()> preDrawCallback;
+  std::function<void()> postDrawCallback;
+  std::function<void()> transformCallback;
+  Bounds localBounds;
+
+ private:
+  glm::mat4 modelMatrix;
+  glm::mat4 normalMatrix;
+};
+using ShapePTR = std::unique_ptr<Shape>;
+}  // namespace graphics::shape
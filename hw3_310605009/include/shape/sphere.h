@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include "geometry.h"
+#include "shape.h"
+
+namespace graphics::shape {
+class Sphere final : public Shape {
+ public:
+  /// Spheres with the same stack and slice share one mesh on the GPU.
+  explicit Sphere(int stack = 180, int slice = 360);
+  /// Shapes built from identical data share one copy on the GPU.
+  Sphere(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices);
+  void draw() const override;
+  Geometry* getGeometry() const override { return geometry.get(); }
+  CONSTEXPR_VIRTUAL const char* getTypeName() const override { return "Sphere"; }
+  CONSTEXPR_VIRTUAL ShapeType getType() const override { return ShapeType::Sphere; }
+  template <typename... Args>
+  static std::unique_ptr<Sphere> make_unique(Args&&... args) {
+    return std::make_unique<Sphere>(std::forward<Args>(args)...);
+  }
+  static void generateVertices(std::vector<GLfloat>& vertex,
+                               std::vector<GLuint>& index,
+                               int stack = 180,
+                               int slice = 360);
+  /**
+   * @brief Generate the sphere into caller-provided storage, using the SIMD path when available.
+   *
+   * @param vertex At least getVertexCount(stack, slice) * vertexStride floats.
+   * @param index At least getIndexCount(stack, slice) indices.
+   */
+  static void generateVertices(GLfloat* vertex, GLuint* index, int stack = 180, int slice = 360);
+  /// @return Number of vertices of a sphere with given stack and slice.
+  static constexpr std::size_t getVertexCount(int stack, int slice) {
+    return static_cast<std::size_t>(stack + 1) * (slice + 1);
+  }
+  /// @return Number of indices of a sphere with given stack and slice, pole rows have one triangle per sector.
+  static constexpr std::size_t getIndexCount(int stack, int slice) {
+    return stack > 1 ? static_cast<std::size_t>(stack - 1) * slice * 6 : 0;
+  }
+  /// Floats per vertex.
+  static constexpr int vertexStride = 8;
+
+ private:
+  GeometryPTR geometry;
+};
+using SpherePTR = std::unique_ptr<Sphere>;
+};  // namespace graphics::shape
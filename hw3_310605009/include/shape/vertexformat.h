@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "buffer/buffer.h"
+#include "buffer/vertexarray.h"
+
+namespace graphics::shape {
+/**
+ * Vertex layouts understood by the shapes, bound to attribute 0 (position), 1 (normal), 2 (texture coordinate),
+ * 3 (tangent) and 4 (bitangent, Float only).
+ */
+enum class VertexFormat : uint8_t { Float, Packed, Quantized };
+
+/**
+ * @brief 24 bytes: float position, GL_INT_2_10_10_10_REV normal and tangent, half-float texture coordinate.
+ *
+ * Decoded normal / tangent components are within 1/511 of the source under the GL 4.2 snorm conversion rule, and
+ * within 3/1023 under the GL 3.3 rule, (2c + 1) / 1023. The bitangent is cross(normal, tangent.xyz) * sign(tangent.w).
+ * Texture coordinates carry half precision, i.e. a relative error of at most 2^-11.
+ */
+struct PackedVertex {
+  GLfloat position[3];
+  GLuint normal;
+  GLuint tangent;
+  GLhalf textureCoordinate[2];
+};
+static_assert(sizeof(PackedVertex) == 24, "PackedVertex must be tightly packed");
+
+/**
+ * @brief 20 bytes: PackedVertex with unorm16 positions, decoded as position * scale + bias.
+ *
+ * Positions are within 0.5 / 65535 of the mesh extent on each axis.
+ */
+struct QuantizedVertex {
+  GLushort position[3];
+  GLushort padding;
+  GLuint normal;
+  GLuint tangent;
+  GLhalf textureCoordinate[2];
+};
+static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex must be tightly packed");
+
+/// Per-mesh decode of QuantizedVertex::position, uploaded as the positionScale / positionBias uniforms.
+struct PositionQuantization {
+  glm::vec3 scale = glm::vec3(1);
+  glm::vec3 bias = glm::vec3(0);
+};
+
+/// @brief Pack a unit vector (w = bitangent sign for tangents) to GL_INT_2_10_10_10_REV.
+inline GLuint packDirection(const glm::vec4& direction) { return glm::packSnorm3x10_1x2(direction); }
+/// @brief Map position to unorm16 with the given decode, axes with zero scale encode as 0.
+inline GLushort quantizePosition(float position, float scale, float bias) {
+  return scale == 0.0f ? 0 : glm::packUnorm1x16((position - bias) / scale);
+}
+
+/// @brief Bytes per vertex of the given format.
+constexpr int getVertexSize(VertexFormat format) {
+  switch (format) {
+    case VertexFormat::Packed:
+      return sizeof(PackedVertex);
+    case VertexFormat::Quantized:
+      return sizeof(QuantizedVertex);
+    default:
+      return 14 * sizeof(GLfloat);
+  }
+}
+
+/// Arguments of one VertexArray::setAttributeFormat call, fixed-size for the file format.
+struct VertexAttribute {
+  uint32_t index;
+  uint32_t size;
+  uint32_t type;
+  uint32_t normalized;
+  // Bytes from the start of the vertex
+  uint32_t offset;
+};
+
+/// Vertex-layout descriptor of a Geometry, also stored in mesh files.
+struct VertexLayout {
+  static constexpr int maxAttributes = 8;
+  // Bytes per vertex
+  uint32_t stride = 0;
+  uint32_t attributeCount = 0;
+  VertexAttribute attributes[maxAttributes] = {};
+
+  /// @brief Enable and describe the attributes, reading vertices from binding point 0 of vao, sourced from vbo.
+  void apply(buffer::VertexArray& vao, const buffer::ArrayBuffer& vbo) const;
+  bool operator==(const VertexLayout& other) const;
+  bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+};
+/// @brief Consecutive float attributes 0, 1, ... with the given sizes, e.g. makeFloatLayout({3, 3, 2}) for spheres.
+VertexLayout makeFloatLayout(std::initializer_list<int> sizes);
+/// @brief Layout of attributes 0 ~ 4 for the format.
+const VertexLayout& getVertexLayout(VertexFormat format);
+}  // namespace graphics::shape
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/gl.h>
+
+#include "utils.h"
+
+/**
+ * @brief Shadow copy of the GL state the wrappers change, calls that would not change anything are skipped.
+ *
+ * Owned by OpenGLContext, see OpenGLContext::getStateCache. Bindings are kept in flat arrays indexed by unit and
+ * target. Objects must be deleted through the cache so a reused name is never mistaken for a bound one, and
+ * invalidate() must be called after code that changes state behind its back (ImGui restores what it changes).
+ * GL_ELEMENT_ARRAY_BUFFER belongs to the bound vertex array and is never skipped.
+ */
+class OpenGLStateCache final {
+ public:
+  static constexpr int textureUnitCount = 16;
+  static constexpr int indexedBindingCount = 16;
+  struct Counters {
+    std::size_t issued = 0;
+    std::size_t skipped = 0;
+  };
+
+  DELETE_COPY(OpenGLStateCache)
+  DELETE_MOVE(OpenGLStateCache)
+  OpenGLStateCache() noexcept { invalidate(); }
+  /// @brief Forget everything, the next call of each kind is issued.
+  void invalidate() noexcept;
+  /// @brief Start counting a new frame.
+  void beginFrame() noexcept;
+  /// @return Calls issued and skipped in the previous frame.
+  const Counters& getFrameCounters() const noexcept { return lastFrame; }
+
+  void useProgram(GLuint program) noexcept;
+  void bindVertexArray(GLuint vertexArray) noexcept;
+  void bindBuffer(GLenum target, GLuint buffer) noexcept;
+  /// @brief glBindBufferRange of uniform and shader storage buffers, size 0 binds the whole buffer.
+  void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) noexcept;
+  /// @brief Bind to a unit, with glBindTextureUnit when direct state access is available.
+  void bindTexture(GLuint unit, GLenum target, GLuint texture) noexcept;
+  /// @brief GL_FRAMEBUFFER binds both the draw and the read framebuffer.
+  void bindFramebuffer(GLenum target, GLuint framebuffer) noexcept;
+
+  void setDepthTest(bool enable) noexcept;
+  void setDepthFunc(GLenum func) noexcept;
+  void setDepthMask(bool enable) noexcept;
+  void setCullFace(bool enable) noexcept;
+  void setCullMode(GLenum mode) noexcept;
+  void setFrontFace(GLenum mode) noexcept;
+  void setBlend(bool enable) noexcept;
+  void setBlendFunc(GLenum source, GLenum destination) noexcept;
+  /// @brief Enable primitive restart with the given index, or disable it.
+  void setPrimitiveRestart(bool enable, GLuint index = 0) noexcept;
+  void setViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept;
+
+  void deleteProgram(GLuint program) noexcept;
+  void deleteVertexArray(GLuint vertexArray) noexcept;
+  void deleteBuffer(GLuint buffer) noexcept;
+  void deleteTexture(GLuint texture) noexcept;
+  void deleteFramebuffer(GLuint framebuffer) noexcept;
+
+ private:
+  /// @brief Store value and count an issued call if it differs from cached, count a skipped one otherwise.
+  template <class T>
+  bool update(T& cached, const T& value) noexcept {
+    if (cached == value) {
+      ++frame.skipped;
+      return false;
+    }
+    cached = value;
+    ++frame.issued;
+    return true;
+  }
+  /// @brief glEnable / glDisable of capability through its cached flag.
+  void setCapability(GLenum capability, int8_t& cached, bool enable) noexcept;
+
+  // Cached targets, others are always issued
+  static constexpr int bufferTargetCount = 6;
+  static constexpr int textureTargetCount = 4;
+  struct BufferRange {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+    bool operator==(const BufferRange& other) const noexcept {
+      return buffer == other.buffer && offset == other.offset && size == other.size;
+    }
+  };
+  // Unknown state, never equal to a value passed in
+  static constexpr GLuint unknown = ~0u;
+
+  GLuint program;
+  GLuint vertexArray;
+  std::array<GLuint, bufferTargetCount> buffers;
+  std::array<BufferRange, indexedBindingCount> uniformRanges, storageRanges;
+  GLuint activeTextureUnit;
+  std::array<std::array<GLuint, textureTargetCount>, textureUnitCount> textures;
+  GLuint drawFramebuffer, readFramebuffer;
+  // Capabilities are 0 / 1, or -1 when unknown
+  int8_t depthTest, cullFace, blend, primitiveRestart;
+  int8_t depthMask;
+  GLenum depthFunc, cullMode, frontFace;
+  std::array<GLenum, 2> blendFunc;
+  GLuint restartIndex;
+  std::array<GLint, 4> viewport;
+  Counters frame, lastFrame;
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdio>
+
+namespace utils {
+/// @return Number of failed EXPECTs so far, tests return it from main so ctest sees the failure.
+inline int& testFailures() {
+  static int failures = 0;
+  return failures;
+}
+/// @brief Print a failed check with its location and count it.
+inline bool expect(bool condition, const char* text, const char* file, int line) {
+  if (!condition) {
+    std::printf("%s:%d: EXPECT(%s) failed\n", file, line, text);
+    ++testFailures();
+  }
+  return condition;
+}
+}  // namespace utils
+
+#define EXPECT(condition) utils::expect(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
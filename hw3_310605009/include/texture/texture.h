@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+
+#include <glad/gl.h>
+#include "utils.h"
+
+namespace graphics::texture {
+constexpr GLenum getColorFormat(int channels) {
+  switch (channels) {
+    case 1: return GL_RED;
+    case 2: return GL_RG;
+    case 3: return GL_RGB;
+    case 4: return GL_RGBA;
+    default:
+      std::cout << "Unknown color format!" << std::endl;
+      std::cout << "Guess color: RGB." << std::endl;
+      return GL_RGB;
+  }
+}
+/// @brief Sized internal format for immutable storage, e.g. GL_RGB to GL_RGB8, sized formats are kept.
+constexpr GLenum getSizedFormat(GLenum format) {
+  switch (format) {
+    case GL_RED: return GL_R8;
+    case GL_RG: return GL_RG8;
+    case GL_RGB: return GL_RGB8;
+    case GL_RGBA: return GL_RGBA8;
+    case GL_DEPTH_COMPONENT: return GL_DEPTH_COMPONENT24;
+    default: return format;
+  }
+}
+/// @brief Levels of a full mipmap chain down to 1 x 1.
+constexpr GLsizei getMipmapLevels(int width, int height) {
+  return static_cast<GLsizei>(utils::log2(static_cast<uint32_t>(std::max(width, height)))) + 1;
+}
+class Texture {
+ public:
+  MOVE_ONLY(Texture)
+  /// @param target Type of the texture, with direct state access it is fixed at creation.
+  explicit Texture(GLenum target) noexcept;
+  virtual ~Texture();
+  CONSTEXPR_VIRTUAL virtual const char* getTypeName() const = 0;
+  CONSTEXPR_VIRTUAL virtual GLenum getType() const = 0;
+  /// @brief Bind to unit index, skipped if already bound there.
+  void bind(GLuint index = 0) const;
+  GLuint getHandle() const;
+
+ protected:
+  GLuint handle;
+};
+}  // namespace graphics::texture
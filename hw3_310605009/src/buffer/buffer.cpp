@@ -1,33 +1,105 @@
 #include "buffer/buffer.h"
 
-namespace graphics::buffer {
-Buffer::Buffer() noexcept : handle(0), size(0) { glGenBuffers(1, &handle); }
-Buffer::~Buffer() { glDeleteBuffers(1, &handle); }
-void Buffer::bind() const noexcept { glBindBuffer(getType(), handle); }
+#include <algorithm>
 
-void Buffer::allocate(GLsizeiptr _size, GLenum usage) noexcept {
-  bind();
-  size = _size;
-  glBufferData(getType(), size, nullptr, usage);
+#include "context_manager.h"
+
+namespace graphics::buffer {
+Buffer::Buffer() noexcept : handle(0), size(0) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateBuffers(1, &handle);
+  } else {
+    glGenBuffers(1, &handle);
+  }
 }
+Buffer::~Buffer() { OpenGLContext::getStateCache().deleteBuffer(handle); }
+void Buffer::bind() const noexcept { OpenGLContext::getStateCache().bindBuffer(getType(), handle); }
+
+void Buffer::allocate(GLsizeiptr _size, GLenum usage) noexcept { allocate_load(_size, nullptr, usage); }
 
 void Buffer::load(GLintptr offset, GLsizeiptr _size, const void* data) noexcept {
-  bind();
-  glBufferSubData(getType(), offset, _size, data);
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glNamedBufferSubData(handle, offset, _size, data);
+    return;
+  }
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, offset, _size, data);
 }
 void Buffer::allocate_load(GLsizeiptr _size, const void* data, GLenum usage) noexcept {
-  bind();
   size = _size;
-  glBufferData(getType(), size, data, usage);
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glNamedBufferData(handle, size, data, usage);
+    return;
+  }
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+  glBufferData(GL_COPY_WRITE_BUFFER, size, data, usage);
+}
+
+void Buffer::resize(GLsizeiptr _size, GLenum usage) noexcept {
+  GLuint previous = handle;
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateBuffers(1, &handle);
+    glNamedBufferData(handle, _size, nullptr, usage);
+    if (size > 0) glCopyNamedBufferSubData(previous, handle, 0, 0, std::min(size, _size));
+  } else {
+    glGenBuffers(1, &handle);
+    OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, _size, nullptr, usage);
+    if (size > 0) {
+      OpenGLContext::getStateCache().bindBuffer(GL_COPY_READ_BUFFER, previous);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, std::min(size, _size));
+    }
+  }
+  OpenGLContext::getStateCache().deleteBuffer(previous);
+  size = _size;
+}
+
+void Buffer::copy(const Buffer& source, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr _size) noexcept {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCopyNamedBufferSubData(source.handle, handle, readOffset, writeOffset, _size);
+    return;
+  }
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_READ_BUFFER, source.handle);
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, _size);
 }
+
+void ElementArrayBuffer::allocate_load(const std::vector<GLuint>& indices, GLenum usage) {
+  GLuint maxIndex = 0;
+  for (GLuint index : indices)
+    if (index != restartIndex) maxIndex = std::max(maxIndex, index);
+  switch (getIndexType(maxIndex)) {
+    case GL_UNSIGNED_BYTE: allocate_load(narrowIndices<GLubyte>(indices), usage); break;
+    case GL_UNSIGNED_SHORT: allocate_load(narrowIndices<GLushort>(indices), usage); break;
+    default:
+      allocate_load(indices.size() * sizeof(GLuint), indices.data(), usage);
+      indexType = GL_UNSIGNED_INT;
+      break;
+  }
+}
+
+void ElementArrayBuffer::allocate_load(const std::vector<GLushort>& indices, GLenum usage) noexcept {
+  allocate_load(indices.size() * sizeof(GLushort), indices.data(), usage);
+  indexType = GL_UNSIGNED_SHORT;
+}
+
+void ElementArrayBuffer::allocate_load(const std::vector<GLubyte>& indices, GLenum usage) noexcept {
+  allocate_load(indices.size() * sizeof(GLubyte), indices.data(), usage);
+  indexType = GL_UNSIGNED_BYTE;
+}
+
+void ElementArrayBuffer::allocate_load(GLenum type, GLsizei count, const void* indices, GLenum usage) noexcept {
+  allocate_load(count * getIndexSize(type), indices, usage);
+  indexType = type;
+}
+
 void UniformBuffer::bindUniformBlockIndex(GLuint index, GLuint offset, GLuint _size) const noexcept {
-  bind();
-  glBindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, _size);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  OpenGLContext::getStateCache().bindBufferRange(GL_UNIFORM_BUFFER, index, handle, offset, _size);
 }
 void UniformBuffer::bindUniformBlockIndex(GLuint index) const noexcept {
-  bind();
-  glBindBufferBase(GL_UNIFORM_BUFFER, index, handle);
-  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  OpenGLContext::getStateCache().bindBufferRange(GL_UNIFORM_BUFFER, index, handle, 0, 0);
+}
+void ShaderStorageBuffer::bindBase(GLuint index) const noexcept {
+  OpenGLContext::getStateCache().bindBufferRange(GL_SHADER_STORAGE_BUFFER, index, handle, 0, 0);
 }
 }  // namespace graphics::buffer
@@ -0,0 +1,51 @@
+// Index type selection and narrowing of ElementArrayBuffer, which only needs a GL context for the upload itself.
+#include <algorithm>
+#include <vector>
+
+#include "buffer/buffer.h"
+#include "shape/plane.h"
+#include "testing.h"
+
+namespace {
+using graphics::buffer::ElementArrayBuffer;
+
+template <typename T>
+void testNarrowIndices(GLenum type) {
+  const GLuint restart = ElementArrayBuffer::getRestartIndex(type);
+  EXPECT(restart == std::numeric_limits<T>::max());
+  EXPECT(ElementArrayBuffer::getIndexSize(type) == sizeof(T));
+  // The largest index of the type is the restart index, so the type holds one less.
+  EXPECT(ElementArrayBuffer::getIndexType(restart - 1) == type);
+  const std::vector<GLuint> indices = {0, 1, restart - 1, ElementArrayBuffer::restartIndex, 2};
+  const std::vector<T> narrowed = ElementArrayBuffer::narrowIndices<T>(indices);
+  EXPECT(narrowed.size() == indices.size());
+  EXPECT(narrowed[0] == 0 && narrowed[1] == 1 && narrowed[2] == restart - 1 && narrowed[4] == 2);
+  EXPECT(narrowed[3] == restart);
+}
+}  // namespace
+
+int main() {
+  testNarrowIndices<GLubyte>(GL_UNSIGNED_BYTE);
+  testNarrowIndices<GLushort>(GL_UNSIGNED_SHORT);
+  testNarrowIndices<GLuint>(GL_UNSIGNED_INT);
+  EXPECT(ElementArrayBuffer::getIndexType(0) == GL_UNSIGNED_BYTE);
+  EXPECT(ElementArrayBuffer::getIndexType(255) == GL_UNSIGNED_SHORT);
+  EXPECT(ElementArrayBuffer::getIndexType(65535) == GL_UNSIGNED_INT);
+  EXPECT(ElementArrayBuffer::restartIndex == ElementArrayBuffer::getRestartIndex(GL_UNSIGNED_INT));
+
+  // The 100-subdivision strip plane fits 16 bits, its row restarts must survive narrowing.
+  using graphics::shape::Plane;
+  std::vector<GLuint> strip;
+  Plane::generateStripIndices(strip, 100);
+  GLuint maxIndex = 0;
+  for (GLuint index : strip)
+    if (index != ElementArrayBuffer::restartIndex) maxIndex = std::max(maxIndex, index);
+  EXPECT(maxIndex + 1 == Plane::getVertexCount(100));
+  EXPECT(ElementArrayBuffer::getIndexType(maxIndex) == GL_UNSIGNED_SHORT);
+  const std::vector<GLushort> narrowed = ElementArrayBuffer::narrowIndices<GLushort>(strip);
+  EXPECT(std::count(narrowed.begin(), narrowed.end(), 0xFFFF) == 99);
+  EXPECT(std::equal(strip.begin(), strip.end(), narrowed.begin(), [](GLuint index, GLushort narrow) {
+    return index == ElementArrayBuffer::restartIndex ? narrow == 0xFFFF : index == narrow;
+  }));
+  return utils::testFailures() != 0;
+}
@@ -0,0 +1,101 @@
+#include "buffer/streambuffer.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "context_manager.h"
+
+namespace {
+// Partitions start at multiples of this, larger than any uniform / storage offset alignment seen in practice.
+constexpr GLsizeiptr partitionAlignment = 256;
+// Nanoseconds per glClientWaitSync call while blocking.
+constexpr GLuint64 waitTimeout = 1000000;
+}  // namespace
+
+namespace graphics::buffer {
+StreamBuffer::~StreamBuffer() { release(); }
+
+void StreamBuffer::release() noexcept {
+  for (GLsync& fence : fences) {
+    if (fence) glDeleteSync(fence);
+    fence = nullptr;
+  }
+  // Deleting a mapped buffer unmaps it.
+  if (handle) OpenGLContext::getStateCache().deleteBuffer(handle);
+  handle = 0;
+  memory = nullptr;
+}
+
+void StreamBuffer::reserve(GLsizeiptr frameSize) {
+  if (frameSize <= partitionSize) return;
+  release();
+  partitionSize = (frameSize + partitionAlignment - 1) / partitionAlignment * partitionAlignment;
+  const GLsizeiptr size = partitionSize * frameCount;
+  glGenBuffers(1, &handle);
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+  persistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+  if (persistent) {
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+    memory = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+    if (memory == nullptr) THROW_EXCEPTION(std::runtime_error, "Failed to map stream buffer!");
+  } else {
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    fallback.resize(size);
+    memory = fallback.data();
+  }
+  fences.assign(frameCount, nullptr);
+  frame = 0;
+  partitionStart = head = flushed = 0;
+}
+
+void StreamBuffer::beginFrame() {
+  statistics.lastFrameBytes = statistics.frameBytes;
+  statistics.frameBytes = 0;
+  frame = (frame + 1) % frameCount;
+  partitionStart = head = flushed = frame * partitionSize;
+  if (fences.empty() || fences[frame] == nullptr) return;
+  GLsync& fence = fences[frame];
+  if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+    ++statistics.fenceWaits;
+    auto start = std::chrono::steady_clock::now();
+    // Flush once so the fence itself reaches the GPU.
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (glClientWaitSync(fence, flags, waitTimeout) == GL_TIMEOUT_EXPIRED) flags = 0;
+    statistics.waitMilliseconds +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+  GLintptr offset = (head + alignment - 1) & ~(alignment - 1);
+  if (offset + size > partitionStart + partitionSize)
+    THROW_EXCEPTION(std::length_error,
+                    "Stream buffer partition of " + std::to_string(partitionSize) + " bytes is full, reserve more");
+  head = offset + size;
+  statistics.frameBytes += size;
+  return Allocation{offset, memory + offset};
+}
+
+void StreamBuffer::flush() {
+  if (persistent || head == flushed) return;
+  OpenGLContext::getStateCache().bindBuffer(GL_COPY_WRITE_BUFFER, handle);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, flushed, head - flushed, memory + flushed);
+  flushed = head;
+}
+
+void StreamBuffer::bind(GLenum target) const noexcept { OpenGLContext::getStateCache().bindBuffer(target, handle); }
+
+void StreamBuffer::bindRange(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size) const noexcept {
+  OpenGLContext::getStateCache().bindBufferRange(target, index, handle, offset, size);
+}
+
+void StreamBuffer::endFrame() {
+  if (fences.empty()) return;
+  if (fences[frame]) glDeleteSync(fences[frame]);
+  fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+}  // namespace graphics::buffer
@@ -1,13 +1,77 @@
 #include "buffer/vertexarray.h"
 
+#include "context_manager.h"
+
 namespace graphics::buffer {
-VertexArray::VertexArray() { glGenVertexArrays(1, &handle); }
-VertexArray::~VertexArray() { glDeleteVertexArrays(1, &handle); }
+VertexArray::VertexArray() {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateVertexArrays(1, &handle);
+  } else {
+    glGenVertexArrays(1, &handle);
+  }
+}
+VertexArray::~VertexArray() { OpenGLContext::getStateCache().deleteVertexArray(handle); }
 
-void VertexArray::enable(int index) { glEnableVertexAttribArray(index); }
+void VertexArray::enable(int index) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glEnableVertexArrayAttrib(handle, index);
+    return;
+  }
+  bind();
+  glEnableVertexAttribArray(index);
+}
 void VertexArray::setAttributePointer(int index, int size, int stride, int offset) {
   glVertexAttribPointer(index, size, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat),
                         reinterpret_cast<GLvoid *>(offset * sizeof(GLfloat)));
 }
-void VertexArray::bind() { glBindVertexArray(handle); }
+void VertexArray::setVertexBuffer(GLuint binding, const Buffer &buffer, GLintptr offset, GLsizei stride) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glVertexArrayVertexBuffer(handle, binding, buffer.getHandle(), offset, stride);
+    return;
+  }
+  bind();
+  glBindVertexBuffer(binding, buffer.getHandle(), offset, stride);
+}
+void VertexArray::setElementBuffer(const Buffer &buffer) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glVertexArrayElementBuffer(handle, buffer.getHandle());
+    return;
+  }
+  bind();
+  OpenGLContext::getStateCache().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.getHandle());
+}
+void VertexArray::setAttributeFormat(int index, int size, GLenum type, bool normalized, GLuint offset,
+                                     GLuint binding) {
+  GLboolean normalize = normalized ? GL_TRUE : GL_FALSE;
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glVertexArrayAttribFormat(handle, index, size, type, normalize, offset);
+    glVertexArrayAttribBinding(handle, index, binding);
+    return;
+  }
+  bind();
+  glVertexAttribFormat(index, size, type, normalize, offset);
+  glVertexAttribBinding(index, binding);
+}
+void VertexArray::setIntegerAttributeFormat(int index, int size, GLenum type, GLuint offset, GLuint binding) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glVertexArrayAttribIFormat(handle, index, size, type, offset);
+    glVertexArrayAttribBinding(handle, index, binding);
+    return;
+  }
+  bind();
+  glVertexAttribIFormat(index, size, type, offset);
+  glVertexAttribBinding(index, binding);
+}
+void VertexArray::setDivisor(GLuint binding, GLuint divisor) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glVertexArrayBindingDivisor(handle, binding, divisor);
+    return;
+  }
+  bind();
+  glVertexBindingDivisor(binding, divisor);
+}
+void VertexArray::bind() { OpenGLContext::getStateCache().bindVertexArray(handle); }
+void VertexArray::unbind() {
+  if (!OpenGLContext::hasDirectStateAccess()) OpenGLContext::getStateCache().bindVertexArray(0);
+}
 }  // namespace graphics::buffer
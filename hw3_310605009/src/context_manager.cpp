@@ -11,6 +11,8 @@ int OpenGLContext::minor_version = 3;
 int OpenGLContext::profile = GLFW_OPENGL_CORE_PROFILE;
 int OpenGLContext::framebuffer_width = 1280;
 int OpenGLContext::framebuffer_height = 720;
+bool OpenGLContext::directStateAccess = false;
+OpenGLStateCache OpenGLContext::stateCache;
 
 namespace {
 void printSourceEnum(GLenum source) {
@@ -106,16 +108,17 @@ OpenGLContext::OpenGLContext() {
   if (!gladLoadGL(glfwGetProcAddress)) {
     THROW_EXCEPTION(std::runtime_error, "Failed to load OpenGL!");
   }
+  directStateAccess = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
 #endif
   // For high dpi monitors like Retina display, we need to recalculate
   // framebuffer size
   glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
-  glViewport(0, 0, framebuffer_width, framebuffer_height);
+  stateCache.setViewport(0, 0, framebuffer_width, framebuffer_height);
   // OK, everything works fine
   // ----------------------------------------------------------
   // Enable some OpenGL feature
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  stateCache.setDepthTest(true);
+  stateCache.setCullFace(true);
   glClearColor(0, 0, 0, 1);
 }
 
@@ -152,6 +155,8 @@ void OpenGLContext::printSystemInfo() {
             << ": " << glGetString(GL_VERSION) << std::endl;
   std::cout << std::left << std::setw(26) << "Moniter refresh rate"
             << ": " << refresh_rate << " Hz" << std::endl;
+  std::cout << std::left << std::setw(26) << "Direct state access"
+            << ": " << (directStateAccess ? "Yes" : "No") << std::endl;
 }
 
 void OpenGLContext::framebufferResizeCallback(GLFWwindow*, int width, int height) {
@@ -159,7 +164,7 @@ void OpenGLContext::framebufferResizeCallback(GLFWwindow*, int width, int height
   if (width == 0 && height == 0) return;
   framebuffer_width = width;
   framebuffer_height = height;
-  glViewport(0, 0, width, height);
+  stateCache.setViewport(0, 0, width, height);
 }
 
 void OpenGLContext::enableDebugCallback() {
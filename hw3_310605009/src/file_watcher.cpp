@@ -0,0 +1,135 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// How long the inotify thread blocks before checking whether it should stop
+constexpr int notifyTimeoutMilliseconds = 100;
+
+utils::fs::file_time_type getWriteTime(const utils::fs::path& file) {
+  std::error_code error;
+  auto time = utils::fs::last_write_time(file, error);
+  return error ? utils::fs::file_time_type::min() : time;
+}
+}  // namespace
+
+namespace utils {
+FileWatcher::FileWatcher(std::chrono::milliseconds _pollInterval, bool useNotify) : pollInterval(_pollInterval) {
+#ifdef __linux__
+  if (useNotify) notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+  (void)useNotify;
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopping = true;
+  }
+  wake.notify_all();
+  if (thread.joinable()) thread.join();
+#ifdef __linux__
+  if (notifyHandle >= 0) close(notifyHandle);
+#endif
+}
+
+fs::path FileWatcher::normalize(const fs::path& file) {
+  std::error_code error;
+  fs::path absolute = fs::absolute(file, error);
+  return (error ? file : absolute).lexically_normal();
+}
+
+void FileWatcher::watch(const fs::path& file) {
+  const fs::path path = normalize(file);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!files.emplace(path, getWriteTime(path)).second) return;
+#ifdef __linux__
+    if (notifyHandle >= 0) {
+      const fs::path directory = path.parent_path();
+      // Watching a directory twice returns its existing descriptor.
+      const int descriptor = inotify_add_watch(notifyHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+      if (descriptor >= 0)
+        directories[descriptor] = directory;
+      else
+        polledFiles.insert(path);
+    }
+#endif
+  }
+  if (!thread.joinable()) thread = std::thread(&FileWatcher::run, this);
+}
+
+std::vector<fs::path> FileWatcher::takeChanges() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<fs::path> taken(changes.begin(), changes.end());
+  changes.clear();
+  return taken;
+}
+
+void FileWatcher::run() {
+  auto nextPoll = std::chrono::steady_clock::now();
+  while (!isStopping) {
+    if (isNotifying()) {
+      readEvents();
+      // Between events, at most every pollInterval
+      if (std::chrono::steady_clock::now() < nextPoll) continue;
+      poll();
+      nextPoll = std::chrono::steady_clock::now() + pollInterval;
+      continue;
+    }
+    poll();
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait_for(lock, pollInterval, [this] { return isStopping.load(); });
+  }
+}
+
+void FileWatcher::poll() {
+  std::vector<fs::path> paths;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isNotifying())
+      paths.assign(polledFiles.begin(), polledFiles.end());
+    else
+      for (const auto& entry : files) paths.push_back(entry.first);
+  }
+  // Files are stat'ed without the lock, watch and takeChanges never wait for the disk.
+  std::vector<fs::file_time_type> times(paths.size());
+  std::transform(paths.begin(), paths.end(), times.begin(), getWriteTime);
+  std::lock_guard<std::mutex> lock(mutex);
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    fs::file_time_type& time = files[paths[i]];
+    if (times[i] == time) continue;
+    time = times[i];
+    changes.insert(paths[i]);
+  }
+}
+
+void FileWatcher::readEvents() {
+#ifdef __linux__
+  pollfd descriptor = {notifyHandle, POLLIN, 0};
+  if (::poll(&descriptor, 1, notifyTimeoutMilliseconds) <= 0) return;
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(notifyHandle, buffer, sizeof(buffer))) > 0) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (char* pointer = buffer; pointer < buffer + length;) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(pointer);
+      pointer += sizeof(inotify_event) + event->len;
+      auto directory = directories.find(event->wd);
+      if (directory == directories.end() || event->len == 0) continue;
+      // Events of other files in the directory are ignored.
+      fs::path path = directory->second / event->name;
+      if (files.count(path)) changes.insert(std::move(path));
+    }
+  }
+#endif
+}
+}  // namespace utils
@@ -0,0 +1,85 @@
+// FileWatcher with inotify and with polling: files rewritten in place and replaced by rename are reported once,
+// other files in the directory are not. Works in a directory under the system's temporary directory.
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "file_watcher.h"
+#include "testing.h"
+
+namespace {
+namespace fs = utils::fs;
+// Polling interval of the watchers, and how long to wait for a change before failing
+constexpr std::chrono::milliseconds pollInterval(20), timeout(2000);
+
+/// @brief Write text to file and move its modification time on, coarse file system clocks would hide the change.
+void write(const fs::path& file, const std::string& text) {
+  std::ofstream(file) << text;
+  std::error_code error;
+  fs::last_write_time(file, fs::last_write_time(file, error) + std::chrono::seconds(2), error);
+}
+
+/// @return Whether file is among the changes reported within the timeout, which must not list it twice.
+bool waitForChange(utils::FileWatcher& watcher, const fs::path& file) {
+  const fs::path path = utils::FileWatcher::normalize(file);
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < end) {
+    const std::vector<fs::path> changes = watcher.takeChanges();
+    const auto count = std::count(changes.begin(), changes.end(), path);
+    EXPECT(count <= 1);
+    if (count != 0) return true;
+    std::this_thread::sleep_for(pollInterval);
+  }
+  return false;
+}
+
+void testWatcher(const fs::path& directory, bool useNotify) {
+  fs::create_directories(directory);
+  const fs::path inPlace = directory / "in_place.glsl", renamed = directory / "renamed.glsl";
+  const fs::path other = directory / "other.glsl", missing = directory / "missing" / "created.glsl";
+  write(inPlace, "1");
+  write(renamed, "1");
+  utils::FileWatcher watcher(pollInterval, useNotify);
+  // Unnormalized paths name the same file.
+  watcher.watch(directory / "." / "in_place.glsl");
+  watcher.watch(renamed);
+  // A directory that does not exist cannot be watched by inotify, its file is polled either way.
+  watcher.watch(missing);
+#ifdef __linux__
+  EXPECT(watcher.isNotifying() == useNotify);
+#else
+  EXPECT(!watcher.isNotifying());
+#endif
+  // Let polling record the initial times before anything changes.
+  std::this_thread::sleep_for(4 * pollInterval);
+  EXPECT(watcher.takeChanges().empty());
+
+  write(inPlace, "2");
+  EXPECT(waitForChange(watcher, inPlace));
+  // Saved as editors often do, to a new file renamed over the old one
+  write(directory / "renamed.glsl.tmp", "2");
+  fs::rename(directory / "renamed.glsl.tmp", renamed);
+  EXPECT(waitForChange(watcher, renamed));
+  fs::create_directories(missing.parent_path());
+  write(missing, "1");
+  EXPECT(waitForChange(watcher, missing));
+
+  write(other, "1");
+  std::this_thread::sleep_for(4 * pollInterval);
+  EXPECT(watcher.takeChanges().empty());
+}
+}  // namespace
+
+int main() {
+  std::error_code error;
+  const fs::path root = fs::temp_directory_path(error) / "file_watcher_test";
+  fs::remove_all(root, error);
+  testWatcher(root / "notify", true);
+  testWatcher(root / "poll", false);
+  fs::remove_all(root, error);
+  return utils::testFailures() != 0;
+}
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -20,11 +22,22 @@
 #include "imgui_impl_opengl3.h"
 
 #include "graphics.h"
+#include "shader/blocks.h"
 
 // Unnamed namespace for global variables
 namespace {
 // Cameras
 graphics::camera::Camera* currentCamera = nullptr;
+// Draws the meshes, its statistics are shown in the GUI
+graphics::render::RenderQueue* renderQueue = nullptr;
+// Per-frame camera uniforms
+graphics::buffer::StreamBuffer* cameraStream = nullptr;
+// Culls and picks the meshes, its statistics are shown in the GUI
+graphics::scene::BoundingVolumeHierarchy* sceneHierarchy = nullptr;
+// Culls hidden meshes of the render queue, its mode is chosen in the GUI
+graphics::render::OcclusionCuller* occlusionCuller = nullptr;
+// Shape under the cursor at the last left click
+const graphics::shape::Shape* pickedShape = nullptr;
 // Control variables
 bool isWindowSizeChanged = true;
 int alignSize = 256;
@@ -38,14 +51,25 @@ bool updateRotation = true;
 bool useDisplacement = false;
 bool useParallax = false;
 bool updateMapping = false;
+// Feature bits of the normal map variants, in the order of their defines
+constexpr graphics::shader::ProgramVariants::Key displacementMappingBit = 1 << 0;
+constexpr graphics::shader::ProgramVariants::Key parallaxMappingBit = 1 << 1;
+// Compiled normal map variants, shown in the GUI
+const graphics::shader::ProgramVariants* normalMapPrograms = nullptr;
+// Rebuilds programs when their shader files are saved, its statistics are shown in the GUI
+const graphics::shader::ShaderReloader* shaderReloader = nullptr;
+// From the start of main until the GPU finished the first frame, 0 before that
+double firstFrameMilliseconds = 0;
 bool mouseBinded = false;
 
 // TODO (Bonus-Displacement): Change 'planeSubDivision' to >= 100, otherwise displacement mapping will not look good.
 constexpr int planeSubDivision = 100;
 constexpr int CAMERA_COUNT = 1;
 constexpr int MESH_COUNT = 3;
-constexpr int SHADER_PROGRAM_COUNT = 4;
+constexpr int SHADER_PROGRAM_COUNT = 3;
 constexpr int normalMapSize = 1024;
+// Depth range of the render queue's sort keys, the camera's far plane
+constexpr float viewDistance = 100.0f;
 }  // namespace
 
 int uboAlign(int i) { return ((i + 1 * (alignSize - 1)) / alignSize) * alignSize; }
@@ -67,6 +91,22 @@ void keyCallback(GLFWwindow* window, int key, int, int action, int) {
   }
 }
 
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int) {
+  // Left click picks a mesh while the cursor is free and not over the GUI.
+  if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS || mouseBinded) return;
+  if (ImGui::GetIO().WantCaptureMouse) return;
+  assert(currentCamera != nullptr && sceneHierarchy != nullptr);
+  double x, y;
+  int width, height;
+  glfwGetCursorPos(window, &x, &y);
+  glfwGetWindowSize(window, &width, &height);
+  if (width == 0 || height == 0) return;
+  const glm::vec2 ndc(2 * x / width - 1, 1 - 2 * y / height);
+  auto ray = graphics::scene::Ray::fromScreen(currentCamera->getViewProjectionMatrix(), ndc);
+  auto hit = sceneHierarchy->queryRay(ray);
+  pickedShape = hit ? sceneHierarchy->getShape(hit->object) : nullptr;
+}
+
 void renderMainPanel(graphics::texture::Texture* normalmap, graphics::texture::Texture* heightmap);
 void renderGUI(graphics::texture::Texture* normalmap, graphics::texture::Texture* heightmap);
 
@@ -78,14 +118,20 @@ void resizeCallback(GLFWwindow* window, int width, int height) {
 }
 
 int main() {
+  const auto startTime = std::chrono::steady_clock::now();
   // Initialize OpenGL context, details are wrapped in class.
   OpenGLContext::createContext(43, GLFW_OPENGL_CORE_PROFILE);
+  // The context falls back to 3.3, but the shaders, compute culling and vertex formats need 4.3.
+  if (OpenGLContext::getOpenGLVersion() < 43) THROW_EXCEPTION(std::runtime_error, "OpenGL 4.3 is required");
   GLFWwindow* window = OpenGLContext::getWindow();
   glfwSetWindowTitle(window, "HW3");
   glfwSetKeyCallback(window, keyCallback);
+  glfwSetMouseButtonCallback(window, mouseButtonCallback);
   glfwSetFramebufferSizeCallback(window, resizeCallback);
-  // glEnable(GL_BLEND);
-  // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  // OpenGLContext::getStateCache().setBlend(true);
+  // OpenGLContext::getStateCache().setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  // The skybox is drawn at depth 1, LEQUAL lets it pass where nothing was drawn without switching per frame.
+  OpenGLContext::getStateCache().setDepthFunc(GL_LEQUAL);
 #ifndef NDEBUG
   OpenGLContext::printSystemInfo();
   // This is useful if you want to debug your OpenGL API calls.
@@ -101,50 +147,54 @@ int main() {
     ImGui_ImplOpenGL3_Init(nullptr);
   }
   // Initialize shader
+  graphics::shader::ShaderReloader reloader;
+  shaderReloader = &reloader;
   std::vector<graphics::shader::ShaderProgram> shaderPrograms(SHADER_PROGRAM_COUNT);
-  std::string filenames[SHADER_PROGRAM_COUNT] = {"skybox", "fresnel", "normalmap", "calculatenormal"};
-  for (int i = 0; i < SHADER_PROGRAM_COUNT; ++i) {
-    graphics::shader::VertexShader vs;
-    graphics::shader::FragmentShader fs;
-    vs.fromFile("../assets/shader/" + filenames[i] + ".vert");
-    fs.fromFile("../assets/shader/" + filenames[i] + ".frag");
-    shaderPrograms[i].attach(&vs, &fs);
-    shaderPrograms[i].link();
-    shaderPrograms[i].detach(&vs, &fs);
-    shaderPrograms[i].use();
+  std::string filenames[SHADER_PROGRAM_COUNT] = {"skybox", "fresnel", "calculatenormal"};
+  // The camera block is declared from its C++ struct, not in the shader files.
+  const std::string cameraDeclaration = graphics::shader::std140::declaration<graphics::shader::CameraBlock>();
+  auto initializeProgram = [](graphics::shader::ShaderProgram& program, const std::string& name) {
+    if (!program.checkUniformBlock<graphics::shader::CameraBlock>())
+      THROW_EXCEPTION(std::runtime_error, "Camera block layout of " + name + " differs from C++");
+    program.use();
 
-    shaderPrograms[i].uniformBlockBinding("model", 0);
-    shaderPrograms[i].uniformBlockBinding("camera", 1);
+    program.uniformBlockBinding("camera", 1);
 
-    shaderPrograms[i].setUniform("useDisplacementMapping", 0);
-    shaderPrograms[i].setUniform("useParallaxMapping", 0);
-    shaderPrograms[i].setUniform("skybox", 0);
-    shaderPrograms[i].setUniform("diffuseTexture", 1);
-    shaderPrograms[i].setUniform("normalTexture", 2);
-    shaderPrograms[i].setUniform("heightTexture", 3);
+    program.setUniform("skybox", 0);
+    program.setUniform("diffuseTexture", 1);
+    program.setUniform("normalTexture", 2);
+    program.setUniform("heightTexture", 3);
+  };
+  // Queued to be built with the first normal map variant, linked binaries of earlier runs are loaded when they match.
+  graphics::shader::ProgramCache::setDirectory("program_cache");
+  // Shared GLSL, e.g. the object buffer, is included from the shader directory.
+  graphics::shader::Preprocessor::setRoot("../assets/shader");
+  for (int i = 0; i < SHADER_PROGRAM_COUNT; ++i) {
+    using graphics::shader::ShaderSource;
+    graphics::shader::ProgramCache::add(
+        &shaderPrograms[i],
+        {ShaderSource::fromFile(GL_VERTEX_SHADER, "../assets/shader/" + filenames[i] + ".vert"),
+         ShaderSource::fromFile(GL_FRAGMENT_SHADER, "../assets/shader/" + filenames[i] + ".frag")},
+        cameraDeclaration);
   }
-  graphics::buffer::UniformBuffer meshUBO, cameraUBO;
+  // Displacement and parallax mapping are compiled in, each combination is a program of its own.
+  graphics::shader::ProgramVariants normalMapVariants("../assets/shader/normalmap.vert",
+                                                      "../assets/shader/normalmap.frag",
+                                                      {"DISPLACEMENT_MAPPING", "PARALLAX_MAPPING"}, cameraDeclaration);
+  normalMapPrograms = &normalMapVariants;
+  normalMapVariants.setReloader(&reloader);
+  // Model matrices are uploaded by the render queue, camera uniforms are streamed every frame.
+  graphics::buffer::StreamBuffer cameraUniforms;
+  cameraStream = &cameraUniforms;
   // Calculate UBO alignment size
   glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignSize);
-  constexpr int perMeshSize = 2 * sizeof(glm::mat4);
-  constexpr int perCameraSize = sizeof(glm::mat4) + sizeof(glm::vec4);
-  int perMeshOffset = uboAlign(perMeshSize);
-  int perCameraOffset = uboAlign(perCameraSize);
-  meshUBO.allocate(MESH_COUNT * perMeshOffset, GL_DYNAMIC_DRAW);
-  cameraUBO.allocate(CAMERA_COUNT * perCameraOffset, GL_DYNAMIC_DRAW);
-  // Default to first data
-  meshUBO.bindUniformBlockIndex(0, 0, perMeshSize);
-  cameraUBO.bindUniformBlockIndex(1, 0, perCameraSize);
+  constexpr int perCameraSize = sizeof(graphics::shader::CameraBlock);
+  cameraUniforms.reserve(CAMERA_COUNT * uboAlign(perCameraSize));
   // Camera
   std::vector<graphics::camera::CameraPTR> cameras;
   cameras.emplace_back(graphics::camera::QuaternionCamera::make_unique(glm::vec3(0, 2, 5)));
   assert(cameras.size() == CAMERA_COUNT);
-  for (int i = 0; i < CAMERA_COUNT; ++i) {
-    int offset = i * perCameraOffset;
-    cameras[i]->initialize(OpenGLContext::getAspectRatio());
-    cameraUBO.load(offset, sizeof(glm::mat4), cameras[i]->getViewProjectionMatrixPTR());
-    cameraUBO.load(offset + sizeof(glm::mat4), sizeof(glm::vec4), cameras[i]->getPositionPTR());
-  }
+  for (int i = 0; i < CAMERA_COUNT; ++i) cameras[i]->initialize(OpenGLContext::getAspectRatio());
   currentCamera = cameras[0].get();
 
   // Texture
@@ -159,102 +209,166 @@ int main() {
   skybox.fromFile("../assets/texture/posx.jpg", "../assets/texture/negx.jpg", "../assets/texture/posy.jpg",
                   "../assets/texture/negy.jpg", "../assets/texture/posz.jpg", "../assets/texture/negz.jpg", false);
   wood.fromFile("../assets/texture/wood.jpg");
-  // Meshes
+  // Meshes, generated meshes are cached in mesh_cache under the working directory.
+  graphics::shape::MeshCache::setDirectory("mesh_cache");
   std::vector<utils::Mesh> meshes;
   graphics::shape::Sphere sphere;
   graphics::shape::Cube skyboxCube;
-  std::vector<GLfloat> vertex;
+  std::vector<graphics::shape::QuantizedVertex> vertex;
   std::vector<GLuint> index;
-  graphics::shape::Plane::generateVertices(vertex, index, planeSubDivision);
-  graphics::shape::Plane fakeWave(vertex, index);
+  graphics::shape::PositionQuantization quantization;
+  graphics::shape::Plane::generateVertices(vertex, index, quantization, planeSubDivision);
+  graphics::shape::Plane::generateStripIndices(index, planeSubDivision);
+  graphics::shape::Plane fakeWave(vertex, index, GL_TRIANGLE_STRIP);
+  // Bounds read from the vertices are in the unorm16 range, before the positionScale / positionBias decode.
+  fakeWave.setLocalBounds(graphics::shape::Bounds::fromBox(quantization.bias, quantization.bias + quantization.scale));
+  // Only the wave is drawn with these programs.
+  auto setQuantization = [&quantization](graphics::shader::ShaderProgram& program) {
+    program.use();
+    program.setUniform("positionScale", quantization.scale.x, quantization.scale.y, quantization.scale.z);
+    program.setUniform("positionBias", quantization.bias.x, quantization.bias.y, quantization.bias.z);
+  };
+  normalMapVariants.setInitializer([&](graphics::shader::ShaderProgram& program) {
+    initializeProgram(program, "normalmap");
+    setQuantization(program);
+  });
+  // Compiles (or loads) every queued program in one batch.
+  normalMapVariants.prepare({0});
+  for (int i = 0; i < SHADER_PROGRAM_COUNT; ++i) initializeProgram(shaderPrograms[i], filenames[i]);
+  setQuantization(shaderPrograms[2]);
   {
     using textureVector = std::vector<graphics::texture::Texture*>;
     meshes.emplace_back(&sphere, &shaderPrograms[1], textureVector{});
-    meshes.emplace_back(&fakeWave, &shaderPrograms[2], textureVector{&skybox, &wood, &normalMap, &heightMap});
+    meshes.emplace_back(&fakeWave, &normalMapVariants.get(0), textureVector{&skybox, &wood, &normalMap, &heightMap});
     meshes.emplace_back(&skyboxCube, &shaderPrograms[0], textureVector{&skybox});
 
     sphere.setModelMatrix(glm::translate(glm::mat4(1), glm::vec3(3, 0, 0)));
-    skyboxCube.registerPreDrawFunction([] {
-      glDepthFunc(GL_LEQUAL);
-      glFrontFace(GL_CW);
-    });
-    skyboxCube.registerPostDrawFunction([] {
-      glFrontFace(GL_CCW);
-      glDepthFunc(GL_LESS);
-    });
+    skyboxCube.registerPreDrawFunction([] { OpenGLContext::getStateCache().setFrontFace(GL_CW); });
+    skyboxCube.registerPostDrawFunction([] { OpenGLContext::getStateCache().setFrontFace(GL_CCW); });
   }
 
   assert(meshes.size() == MESH_COUNT);
+  // Locations of uniforms updated in the loop, looked up once and again after a reload.
+  GLint skyboxView, skyboxProjection;
+  auto onSkyboxReload = [&](graphics::shader::ShaderProgram& program) {
+    skyboxView = program.getUniformLocation("view");
+    skyboxProjection = program.getUniformLocation("projection");
+  };
+  GLint fresnelBiasLocation, fresnelScaleLocation, fresnelPowerLocation;
+  auto onFresnelReload = [&](graphics::shader::ShaderProgram& program) {
+    fresnelBiasLocation = program.getUniformLocation("fresnelBias");
+    fresnelScaleLocation = program.getUniformLocation("fresnelScale");
+    fresnelPowerLocation = program.getUniformLocation("fresnelPower");
+  };
+  GLint offsetLocation;
+  auto onCalculateNormalReload = [&](graphics::shader::ShaderProgram& program) {
+    offsetLocation = program.getUniformLocation("offset");
+  };
+  graphics::shader::ShaderReloader::Callback onReload[SHADER_PROGRAM_COUNT] = {onSkyboxReload, onFresnelReload,
+                                                                              onCalculateNormalReload};
+  for (int i = 0; i < SHADER_PROGRAM_COUNT; ++i) {
+    onReload[i](shaderPrograms[i]);
+    reloader.add(&shaderPrograms[i],
+                 {{GL_VERTEX_SHADER, "../assets/shader/" + filenames[i] + ".vert"},
+                  {GL_FRAGMENT_SHADER, "../assets/shader/" + filenames[i] + ".frag"}},
+                 cameraDeclaration, onReload[i]);
+  }
+  // Meshes sharing a program and vertex layout are drawn by one glMultiDrawElementsIndirect.
+  graphics::render::RenderQueue queue(graphics::render::Submission::Indirect);
+  renderQueue = &queue;
+  graphics::render::OcclusionCuller occlusion("../assets/shader");
+  occlusionCuller = &occlusion;
+  queue.setOcclusionCuller(&occlusion);
+  // The skybox surrounds the camera, it is neither culled nor picked.
+  graphics::scene::BoundingVolumeHierarchy hierarchy;
+  sceneHierarchy = &hierarchy;
+  std::vector<int> objectMeshes;
   for (int i = 0; i < MESH_COUNT; ++i) {
-    int offset = i * perMeshOffset;
-    meshUBO.load(offset, sizeof(glm::mat4), meshes[i].shape->getModelMatrixPTR());
-    meshUBO.load(offset + sizeof(glm::mat4), sizeof(glm::mat4), meshes[i].shape->getNormalMatrixPTR());
+    if (meshes[i].shape == &skyboxCube) continue;
+    const int object = hierarchy.add(meshes[i].shape);
+    objectMeshes.resize(std::max<std::size_t>(objectMeshes.size(), object + 1));
+    objectMeshes[object] = i;
   }
+  std::vector<int> visibleObjects;
   int currentOffset = 0;
   // Main rendering loop
   while (!glfwWindowShouldClose(window)) {
     // Polling events.
     glfwPollEvents();
+    OpenGLContext::getStateCache().beginFrame();
+    // Swap in programs rebuilt from edited shader files, a failed build keeps the running program.
+    reloader.update();
     // Update camera's uniforms if camera moves.
     bool isCameraMove = mouseBinded ? currentCamera->move(window) : false;
     if (isCameraMove || isWindowSizeChanged) {
       isWindowSizeChanged = false;
-      shaderPrograms[0].use();
-      shaderPrograms[0].setUniformMatrix("view", currentCamera->getViewMatrixPTR());
-      shaderPrograms[0].setUniformMatrix("projection", currentCamera->getProjectionMatrixPTR());
-
-      cameraUBO.load(0, sizeof(glm::mat4), currentCamera->getViewProjectionMatrixPTR());
-      cameraUBO.load(sizeof(glm::mat4), sizeof(glm::vec4), currentCamera->getPositionPTR());
+      shaderPrograms[0].setUniforms({{skyboxView, currentCamera->getViewMatrix()},
+                                     {skyboxProjection, currentCamera->getProjectionMatrix()}});
     }
-    shaderPrograms[1].use();
+    cameraUniforms.beginFrame();
+    auto camera = cameraUniforms.allocate(perCameraSize, alignSize);
+    graphics::shader::CameraBlock cameraBlock{currentCamera->getViewProjectionMatrix(), currentCamera->getPosition()};
+    std::memcpy(camera.pointer, &cameraBlock, sizeof(cameraBlock));
+    cameraUniforms.flush();
+    cameraUniforms.bindRange(GL_UNIFORM_BUFFER, 1, camera.offset, perCameraSize);
     // Update fresnel equation's parametsers.
     if (updateFresnelParameters) {
-      shaderPrograms[1].setUniform("fresnelBias", fresnelBias);
-      shaderPrograms[1].setUniform("fresnelScale", fresnelScale);
-      shaderPrograms[1].setUniform("fresnelPower", fresnelPower);
+      shaderPrograms[1].setUniforms({{fresnelBiasLocation, fresnelBias},
+                                     {fresnelScaleLocation, fresnelScale},
+                                     {fresnelPowerLocation, fresnelPower}});
       updateFresnelParameters = false;
     }
     if (updateRotation) {
       fakeWave.setModelMatrix(glm::rotate(glm::mat4(1), glm::radians(rotation), glm::vec3(1, 0, 0)));
-      meshUBO.load(perMeshOffset, sizeof(glm::mat4), meshes[1].shape->getModelMatrixPTR());
-      meshUBO.load(perMeshOffset + sizeof(glm::mat4), sizeof(glm::mat4), meshes[1].shape->getNormalMatrixPTR());
       updateRotation = false;
     }
-    // update switches
+    // update switches, the wave swaps to the variant with the chosen features
     if (updateMapping) {
-      shaderPrograms[2].use();
-      shaderPrograms[2].setUniform("useParallaxMapping", useParallax);
-      shaderPrograms[2].setUniform("useDisplacementMapping", useDisplacement);
+      const graphics::shader::ProgramVariants::Key features =
+          (useDisplacement ? displacementMappingBit : 0) | (useParallax ? parallaxMappingBit : 0);
+      meshes[1].program = &normalMapVariants.get(features);
       updateMapping = false;
     }
     // Update normal map
     fbo.bind();
     glClear(GL_COLOR_BUFFER_BIT);
     (++currentOffset) %= 101;
-    glViewport(0, 0, normalMapSize, normalMapSize);
-    shaderPrograms[3].use();
-    shaderPrograms[3].setUniform("offset", currentOffset * 0.01f * glm::two_pi<float>());
-    meshUBO.bindUniformBlockIndex(0, perMeshOffset, perMeshSize);
+    OpenGLContext::getStateCache().setViewport(0, 0, normalMapSize, normalMapSize);
+    shaderPrograms[2].use();
+    shaderPrograms[2].setUniform(offsetLocation, currentOffset * 0.01f * glm::two_pi<float>());
     fakeWave.draw();
-    glViewport(0, 0, OpenGLContext::getWidth(), OpenGLContext::getHeight());
+    OpenGLContext::getStateCache().setViewport(0, 0, OpenGLContext::getWidth(), OpenGLContext::getHeight());
 
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    graphics::texture::Framebuffer::unbind();
     // GL_XXX_BIT can simply "OR" together to use.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    // Render all objects
-    for (int i = 0; i < MESH_COUNT; ++i) {
-      // Bind current object's model matrix
-      meshUBO.bindUniformBlockIndex(0, i * perMeshOffset, perMeshSize);
-      // Render current object
-      meshes[i].draw();
-    }
+    // Refit the meshes moved this frame and cull them, the skybox is always drawn.
+    hierarchy.update();
+    visibleObjects.clear();
+    hierarchy.queryFrustum(graphics::scene::Frustum::fromMatrix(currentCamera->getViewProjectionMatrix()),
+                           visibleObjects);
+    // Render visible objects, sorted by state. The skybox goes last so depth testing rejects most of it.
+    occlusion.beginFrame(currentCamera->getViewProjectionMatrix());
+    queue.begin(glm::vec3(currentCamera->getPosition()), viewDistance);
+    for (int i = 0; i < MESH_COUNT; ++i)
+      if (meshes[i].shape == &skyboxCube) queue.push(meshes[i], graphics::render::Pass::Background);
+    for (int object : visibleObjects) queue.push(meshes[objectMeshes[object]], graphics::render::Pass::Opaque);
+    queue.submit();
+    occlusion.endFrame();
     // Render GUI
     renderGUI(&normalMap, &heightMap);
 #ifdef __APPLE__
     // Some platform need explicit glFlush
     glFlush();
 #endif
+    cameraUniforms.endFrame();
     glfwSwapBuffers(window);
+    if (firstFrameMilliseconds == 0) {
+      // Wait for the GPU once, so the startup time includes the driver's deferred work.
+      glFinish();
+      firstFrameMilliseconds =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    }
   }
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplGlfw_Shutdown();
@@ -315,8 +429,65 @@ void renderMainPanel(graphics::texture::Texture* normalmap, graphics::texture::T
     updateMapping |= ImGui::Checkbox("Displacement", &useDisplacement);
     ImGui::SameLine();
     updateMapping |= ImGui::Checkbox("Parallax", &useParallax);
+    ImGui::SameLine();
+    ImGui::Text("(%zu variants compiled)", normalMapPrograms->getCompiledCount());
     ImGui::Text("----------------------- Other -----------------------");
     ImGui::Text("Current framerate: %.0f", ImGui::GetIO().Framerate);
+    const auto& geometry = graphics::shape::GeometryRegistry::getStatistics();
+    ImGui::Text("Meshes: %zu (%.1f MB), uploaded %zu of %zu in %.1f ms",
+                graphics::shape::GeometryRegistry::getLiveCount(),
+                graphics::shape::GeometryRegistry::getLiveSize() / 1048576.0, geometry.uploads, geometry.requests,
+                geometry.uploadMilliseconds);
+    const auto& meshCache = graphics::shape::MeshCache::getStatistics();
+    const auto& render = renderQueue->getStatistics();
+    const auto& state = OpenGLContext::getStateCache().getFrameCounters();
+    ImGui::Text("State changes: %zu issued, %zu skipped", state.issued, state.skipped);
+    ImGui::Text("Draw calls: %zu, switches: %zu programs, %zu textures, %zu VAOs", render.drawCalls,
+                render.programSwitches, render.textureSwitches, render.vertexArraySwitches);
+    const auto& hierarchy = sceneHierarchy->getStatistics();
+    ImGui::Text("BVH: %zu objects, depth %d, cost x%.2f, %zu builds (%.2f ms), refit %zu (%.3f ms)%s",
+                hierarchy.objects, hierarchy.depth, hierarchy.costRatio, hierarchy.builds, hierarchy.buildMilliseconds,
+                hierarchy.refitLeaves, hierarchy.refitMilliseconds, hierarchy.isFlatCull ? ", flat cull" : "");
+    int occlusionMode = static_cast<int>(occlusionCuller->getMode());
+    ImGui::Text("Occlusion:");
+    ImGui::SameLine();
+    bool isOcclusionChanged = ImGui::RadioButton("Off", &occlusionMode, 0);
+    ImGui::SameLine();
+    isOcclusionChanged |= ImGui::RadioButton("Hi-Z", &occlusionMode, 1);
+    ImGui::SameLine();
+    isOcclusionChanged |= ImGui::RadioButton("Queries", &occlusionMode, 2);
+    if (isOcclusionChanged) occlusionCuller->setMode(static_cast<graphics::render::Occlusion>(occlusionMode));
+    const auto& occlusion = occlusionCuller->getStatistics();
+    if (occlusionCuller->getMode() == graphics::render::Occlusion::HierarchicalZ) {
+      ImGui::Text("Hi-Z: %zu tested, %zu culled, %zu recovered late", occlusion.tested, occlusion.culled,
+                  occlusion.recovered);
+    } else if (occlusionCuller->getMode() == graphics::render::Occlusion::Queries) {
+      ImGui::Text("Queries: %zu tested, %zu skipped, %zu conditional", occlusion.tested, occlusion.skipped,
+                  occlusion.conditional);
+    }
+    ImGui::Text("Picked: %s (left click, F9 frees the cursor)", pickedShape ? pickedShape->getTypeName() : "none");
+    ImGui::Text("Render queue: %zu items, sort %.3f ms, submit %.3f ms", render.items, render.sortMilliseconds,
+                render.submitMilliseconds);
+    const auto& pool = renderQueue->getPool();
+    ImGui::Text("Indirect: %zu batches (%.1f MB), %.1f KB uploaded", pool.getBatchCount(),
+                pool.getSize() / 1048576.0, render.uploadedBytes / 1024.0);
+    const auto& cameraStatistics = cameraStream->getStatistics();
+    const auto& queueStatistics = renderQueue->getStream().getStatistics();
+    ImGui::Text("Streamed: %.1f KB per frame, %zu fence waits (%.1f ms)%s",
+                (cameraStatistics.lastFrameBytes + queueStatistics.lastFrameBytes) / 1024.0,
+                cameraStatistics.fenceWaits + queueStatistics.fenceWaits,
+                cameraStatistics.waitMilliseconds + queueStatistics.waitMilliseconds,
+                cameraStream->isPersistent() ? "" : ", not persistent");
+    const auto& programs = graphics::shader::ProgramCache::getStatistics();
+    ImGui::Text("Startup (%s): first frame after %.1f ms, programs %zu loaded (%.1f ms), %zu compiled (%.1f ms)",
+                programs.misses == 0 ? "warm" : "cold", firstFrameMilliseconds, programs.hits,
+                programs.loadMilliseconds, programs.misses, programs.compileMilliseconds);
+    const auto& reloads = shaderReloader->getStatistics();
+    ImGui::Text("Hot reload (%s): %zu reloads, last %.1f ms, %zu failed",
+                shaderReloader->isNotifying() ? "inotify" : "polling", reloads.reloads, reloads.lastMilliseconds,
+                reloads.failures);
+    ImGui::Text("Mesh cache: %zu loaded in %.1f ms, %zu generated in %.1f ms", meshCache.hits,
+                meshCache.loadMilliseconds, meshCache.misses, meshCache.generateMilliseconds);
   }
   ImGui::End();
 }
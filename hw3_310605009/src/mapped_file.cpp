@@ -0,0 +1,133 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include <glad/gl.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+void report(const std::string& message) {
+  if (glDebugMessageInsert) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                         message.c_str());
+  } else {
+    puts(message.c_str());
+  }
+}
+}  // namespace
+
+namespace utils {
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : address(std::exchange(other.address, nullptr)),
+      length(std::exchange(other.length, 0))
+#ifdef _WIN32
+      ,
+      mapping(std::exchange(other.mapping, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    release();
+    address = std::exchange(other.address, nullptr);
+    length = std::exchange(other.length, 0);
+#ifdef _WIN32
+    mapping = std::exchange(other.mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { release(); }
+
+#ifdef _WIN32
+MappedFile::MappedFile(const fs::path& path) {
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) THROW_EXCEPTION(std::runtime_error, "Cannot open file: " + path.string());
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    THROW_EXCEPTION(std::runtime_error, "Cannot stat file: " + path.string());
+  }
+  length = static_cast<std::size_t>(fileSize.QuadPart);
+  // Empty files cannot be mapped, keep a null view.
+  if (length != 0) {
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  }
+  CloseHandle(file);
+  if (length != 0 && address == nullptr) {
+    release();
+    THROW_EXCEPTION(std::runtime_error, "Cannot map file: " + path.string());
+  }
+}
+
+void MappedFile::release() noexcept {
+  if (address != nullptr) UnmapViewOfFile(address);
+  if (mapping != nullptr) CloseHandle(mapping);
+  address = nullptr;
+  mapping = nullptr;
+  length = 0;
+}
+#else
+MappedFile::MappedFile(const fs::path& path) {
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) THROW_EXCEPTION(std::runtime_error, "Cannot open file: " + path.string());
+  struct stat status;
+  if (fstat(file, &status) != 0) {
+    close(file);
+    THROW_EXCEPTION(std::runtime_error, "Cannot stat file: " + path.string());
+  }
+  length = static_cast<std::size_t>(status.st_size);
+  // Empty files cannot be mapped, keep a null view.
+  if (length != 0) {
+    address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+    if (address == MAP_FAILED) address = nullptr;
+  }
+  close(file);
+  if (length != 0 && address == nullptr) {
+    length = 0;
+    THROW_EXCEPTION(std::runtime_error, "Cannot map file: " + path.string());
+  }
+}
+
+void MappedFile::release() noexcept {
+  if (address != nullptr) munmap(address, length);
+  address = nullptr;
+  length = 0;
+}
+#endif
+
+bool writeCacheFile(const fs::path& path, const std::function<void(std::ostream& output)>& write) {
+  try {
+    fs::create_directories(path.parent_path());
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+      std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+      if (output) write(output);
+      if (!output) THROW_EXCEPTION(std::runtime_error, "Cannot write cache file: " + temporary.string());
+    }
+    fs::rename(temporary, path);
+    return true;
+  } catch (const std::exception& e) {
+    report(e.what());
+    return false;
+  }
+}
+}  // namespace utils
@@ -0,0 +1,96 @@
+#include "render/geometrypool.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+// Batches start with room for a few typical meshes and double when full.
+constexpr GLsizeiptr minimumBatchBytes = 1 << 20;
+
+GLsizeiptr growCapacity(GLsizeiptr capacity, GLsizeiptr required) {
+  capacity = std::max(capacity, minimumBatchBytes);
+  while (capacity < required) capacity *= 2;
+  return capacity;
+}
+}  // namespace
+
+namespace graphics::render {
+const PoolRange& GeometryPool::get(const shape::Geometry& geometry) {
+  if (auto it = ranges.find(geometry.getId()); it != ranges.end()) return it->second;
+  uint32_t batchIndex = findBatch(geometry);
+  Batch& batch = *batches[batchIndex];
+  const buffer::ArrayBuffer& vertices = geometry.getVertexBuffer();
+  const buffer::ElementArrayBuffer& indices = geometry.getIndexBuffer();
+  // The vertex array is re-pointed only when a buffer got a new handle.
+  bool resized = false;
+  if (batch.vertexBytes + vertices.getSize() > batch.vbo.getSize()) {
+    batch.vbo.resize(growCapacity(batch.vbo.getSize(), batch.vertexBytes + vertices.getSize()));
+    resized = true;
+  }
+  if (batch.indexBytes + indices.getSize() > batch.ebo.getSize()) {
+    batch.ebo.resize(growCapacity(batch.ebo.getSize(), batch.indexBytes + indices.getSize()));
+    resized = true;
+  }
+  if (resized) setupVertexArray(batch);
+  batch.vbo.copy(vertices, 0, batch.vertexBytes, vertices.getSize());
+  batch.ebo.copy(indices, 0, batch.indexBytes, indices.getSize());
+
+  PoolRange range;
+  range.batch = batchIndex;
+  range.firstIndex = static_cast<GLuint>(batch.indexBytes / buffer::ElementArrayBuffer::getIndexSize(batch.indexType));
+  range.indexCount = static_cast<GLuint>(indices.getIndexCount());
+  range.baseVertex = static_cast<GLint>(batch.vertexBytes / batch.layout.stride);
+  batch.vertexBytes += vertices.getSize();
+  batch.indexBytes += indices.getSize();
+  return ranges.emplace(geometry.getId(), range).first->second;
+}
+
+uint32_t GeometryPool::findBatch(const shape::Geometry& geometry) {
+  GLenum indexType = geometry.getIndexBuffer().getIndexType();
+  for (uint32_t i = 0; i < batches.size(); ++i) {
+    const Batch& batch = *batches[i];
+    if (batch.layout == geometry.getLayout() && batch.indexType == indexType &&
+        batch.primitive == geometry.getPrimitive())
+      return i;
+  }
+  auto batch = std::make_unique<Batch>();
+  batch->layout = geometry.getLayout();
+  batch->indexType = indexType;
+  batch->primitive = geometry.getPrimitive();
+  batches.push_back(std::move(batch));
+  return static_cast<uint32_t>(batches.size() - 1);
+}
+
+void GeometryPool::reserveObjects(GLuint count) {
+  if (count <= objectCapacity) return;
+  objectCapacity = std::max(count, objectCapacity * 2);
+  std::vector<GLuint> identity(objectCapacity);
+  std::iota(identity.begin(), identity.end(), 0);
+  objectIndices.resize(objectCapacity * sizeof(GLuint));
+  objectIndices.load(0, objectCapacity * sizeof(GLuint), identity.data());
+  for (const auto& batch : batches) setupVertexArray(*batch);
+}
+
+void GeometryPool::setupVertexArray(Batch& batch) {
+  batch.layout.apply(batch.vao, batch.vbo);
+  batch.vao.setElementBuffer(batch.ebo);
+  if (objectCapacity > 0) {
+    batch.vao.setVertexBuffer(objectIndexBinding, objectIndices, 0, sizeof(GLuint));
+    batch.vao.enable(objectIndexAttribute);
+    batch.vao.setIntegerAttributeFormat(objectIndexAttribute, 1, GL_UNSIGNED_INT, 0, objectIndexBinding);
+    batch.vao.setDivisor(objectIndexBinding, 1);
+  }
+  buffer::VertexArray::unbind();
+}
+
+std::size_t GeometryPool::getSize() const {
+  std::size_t size = 0;
+  for (const auto& batch : batches) size += batch->vertexBytes + batch->indexBytes;
+  return size;
+}
+
+void GeometryPool::clear() {
+  batches.clear();
+  ranges.clear();
+}
+}  // namespace graphics::render
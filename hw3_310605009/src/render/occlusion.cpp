@@ -0,0 +1,277 @@
+#include "render/occlusion.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "context_manager.h"
+#include "shader/programcache.h"
+
+namespace {
+using graphics::render::OcclusionCuller;
+// Queries of shapes not drawn for this many frames are deleted.
+constexpr uint64_t queryLifetime = 120;
+constexpr GLuint cullGroupSize = 64;
+constexpr GLuint reduceGroupSize = 8;
+
+/// @brief Immutable 2D texture read with texelFetch, levels of width x height halved down to 1 x 1.
+GLuint createTexture(GLenum format, int levels, int width, int height) {
+  GLuint texture = 0;
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureStorage2D(texture, levels, format, width, height);
+    return texture;
+  }
+  glGenTextures(1, &texture);
+  OpenGLContext::getStateCache().bindTexture(OcclusionCuller::pyramidUnit, GL_TEXTURE_2D, texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexStorage2D(GL_TEXTURE_2D, levels, format, width, height);
+  return texture;
+}
+
+/// @return Whether a corner of the box lies in front of the near plane, where its faces would be clipped away.
+bool crossesNearPlane(const glm::mat4& matrix, const graphics::shape::Bounds& bounds) {
+  for (int corner = 0; corner < 8; ++corner) {
+    glm::vec4 position((corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y,
+                       (corner & 4) ? bounds.max.z : bounds.min.z, 1.0f);
+    glm::vec4 clip = matrix * position;
+    if (clip.w <= 0 || clip.z < -clip.w) return true;
+  }
+  return false;
+}
+}  // namespace
+
+namespace graphics::render {
+OcclusionCuller::OcclusionCuller(const utils::fs::path& shaderDirectory) {
+  using shader::ShaderSource;
+  shader::ProgramCache::add(&reduceProgram,
+                            {ShaderSource::fromFile(GL_COMPUTE_SHADER, shaderDirectory / "hiz_reduce.comp")});
+  shader::ProgramCache::add(&cullProgram,
+                            {ShaderSource::fromFile(GL_COMPUTE_SHADER, shaderDirectory / "hiz_cull.comp")});
+  shader::ProgramCache::add(&proxyProgram,
+                            {ShaderSource::fromFile(GL_VERTEX_SHADER, shaderDirectory / "occlusion_proxy.vert"),
+                             ShaderSource::fromFile(GL_FRAGMENT_SHADER, shaderDirectory / "occlusion_proxy.frag")});
+  shader::ProgramCache::build();
+  sourceLevelLocation = reduceProgram.getUniformLocation("sourceLevel");
+  viewProjectionLocation = cullProgram.getUniformLocation("viewProjection");
+  objectCountLocation = cullProgram.getUniformLocation("objectCount");
+  phaseLocation = cullProgram.getUniformLocation("phase");
+  GLint alignment = 0;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  counterStride = std::max<GLsizeiptr>(alignment, 2 * sizeof(GLuint));
+  std::vector<unsigned char> zeros(counterStride * counterSlots, 0);
+  counters.allocate_load(counterStride * counterSlots, zeros.data(), GL_DYNAMIC_READ);
+  boxMatrixLocation = proxyProgram.getUniformLocation("boxMatrix");
+  // Unit cube, corner i at (i & 1, i >> 1 & 1, i >> 2 & 1), faces counter-clockwise seen from outside.
+  GLfloat corners[24];
+  for (int i = 0; i < 8; ++i) {
+    corners[i * 3] = static_cast<GLfloat>(i & 1);
+    corners[i * 3 + 1] = static_cast<GLfloat>((i >> 1) & 1);
+    corners[i * 3 + 2] = static_cast<GLfloat>((i >> 2) & 1);
+  }
+  proxyVertices.allocate_load(sizeof(corners), corners);
+  proxyIndices.allocate_load(std::vector<GLubyte>{0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2,
+                                                  1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3});
+  proxyVertexArray.setVertexBuffer(0, proxyVertices, 0, 3 * sizeof(GLfloat));
+  proxyVertexArray.enable(0);
+  proxyVertexArray.setAttributeFormat(0, 3, GL_FLOAT, false, 0);
+  proxyVertexArray.setElementBuffer(proxyIndices);
+  buffer::VertexArray::unbind();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+  releasePyramid();
+  for (GLsync fence : counterFences)
+    if (fence) glDeleteSync(fence);
+  for (auto& [shape, query] : queries)
+    if (query.handle) glDeleteQueries(1, &query.handle);
+}
+
+void OcclusionCuller::setMode(Occlusion _mode) {
+  // A pyramid of a frame drawn without culling would still be valid, but may be arbitrarily old.
+  if (_mode != mode) hasPyramid = false;
+  mode = _mode;
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& _viewProjection) {
+  ++frame;
+  viewProjection = _viewProjection;
+  statistics.tested = 0;
+  statistics.skipped = 0;
+  statistics.conditional = 0;
+  queriedShapes.clear();
+  isCounting = false;
+  if (counterStride != 0) {
+    // The slot of this frame was last fenced counterSlots frames ago, read it if the GPU is done with it.
+    const int slot = static_cast<int>(frame % counterSlots);
+    GLsync& fence = counterFences[slot];
+    if (fence) {
+      const GLenum status = glClientWaitSync(fence, 0, 0);
+      if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+        GLuint values[2] = {0, 0};
+        if (OpenGLContext::hasDirectStateAccess()) {
+          glGetNamedBufferSubData(counters.getHandle(), slot * counterStride, sizeof(values), values);
+        } else {
+          OpenGLContext::getStateCache().bindBuffer(GL_COPY_READ_BUFFER, counters.getHandle());
+          glGetBufferSubData(GL_COPY_READ_BUFFER, slot * counterStride, sizeof(values), values);
+        }
+        statistics.culled = values[0];
+        statistics.recovered = values[1];
+      }
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+  for (auto it = queries.begin(); it != queries.end();) {
+    if (it->second.lastFrame + queryLifetime >= frame) {
+      ++it;
+      continue;
+    }
+    glDeleteQueries(1, &it->second.handle);
+    it = queries.erase(it);
+  }
+}
+
+void OcclusionCuller::endFrame() {
+  if (!isCounting) return;
+  counterFences[frame % counterSlots] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool OcclusionCuller::cullEarly(GLuint objectCount) {
+  if (!hasPyramid || objectCount == 0 || counterStride == 0) return false;
+  // Zero the counters of this frame, the GL orders this after the readback of their last use.
+  const GLintptr slotOffset = static_cast<GLintptr>(frame % counterSlots) * counterStride;
+  const GLuint zeros[2] = {0, 0};
+  counters.load(slotOffset, sizeof(zeros), zeros);
+  OpenGLStateCache& state = OpenGLContext::getStateCache();
+  state.bindBufferRange(GL_SHADER_STORAGE_BUFFER, counterStorageBinding, counters.getHandle(), slotOffset,
+                        sizeof(zeros));
+  state.bindTexture(pyramidUnit, GL_TEXTURE_2D, pyramid);
+  cullProgram.setUniforms({{viewProjectionLocation, pyramidViewProjection},
+                           {objectCountLocation, static_cast<GLint>(objectCount)},
+                           {phaseLocation, GLint{1}}});
+  cullProgram.use();
+  glDispatchCompute((objectCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+  isCounting = true;
+  return true;
+}
+
+void OcclusionCuller::cullLate(GLuint objectCount, bool retest) {
+  const int width = OpenGLContext::getWidth(), height = OpenGLContext::getHeight();
+  if (counterStride == 0 || width <= 0 || height <= 0) return;
+  if (width != pyramidWidth || height != pyramidHeight) resizePyramid(width, height);
+  OpenGLStateCache& state = OpenGLContext::getStateCache();
+  // Depth can only be sampled from a texture, copy it from the framebuffer being drawn (the window in main).
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCopyTextureSubImage2D(depthCopy, 0, 0, 0, 0, 0, width, height);
+  } else {
+    state.bindTexture(pyramidUnit, GL_TEXTURE_2D, depthCopy);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+  }
+  reduceProgram.use();
+  for (int level = 0; level < pyramidLevels; ++level) {
+    // Level 0 is the depth copy itself, each further level halves the previous one.
+    state.bindTexture(pyramidUnit, GL_TEXTURE_2D, level == 0 ? depthCopy : pyramid);
+    reduceProgram.setUniform(sourceLevelLocation, std::max(level - 1, 0));
+    glBindImageTexture(0, pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    const GLuint levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+    glDispatchCompute((levelWidth + reduceGroupSize - 1) / reduceGroupSize,
+                      (levelHeight + reduceGroupSize - 1) / reduceGroupSize, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+  }
+  hasPyramid = true;
+  pyramidViewProjection = viewProjection;
+  if (!retest || objectCount == 0) return;
+  state.bindTexture(pyramidUnit, GL_TEXTURE_2D, pyramid);
+  cullProgram.setUniforms({{viewProjectionLocation, pyramidViewProjection}, {phaseLocation, GLint{2}}});
+  cullProgram.use();
+  glDispatchCompute((objectCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+bool OcclusionCuller::beginDraw(const shape::Shape& shape) {
+  isConditional = false;
+  ++statistics.tested;
+  // Too close to draw a box around, the query would miss the faces the near plane clips away.
+  if (crossesNearPlane(viewProjection * shape.getModelMatrix(), shape.getLocalBounds())) return true;
+  queriedShapes.push_back(&shape);
+  auto it = queries.find(&shape);
+  if (it == queries.end()) return true;
+  Query& query = it->second;
+  if (query.isPending) {
+    GLuint isAvailable = GL_FALSE;
+    glGetQueryObjectuiv(query.handle, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (isAvailable) {
+      GLuint anySamples = 0;
+      glGetQueryObjectuiv(query.handle, GL_QUERY_RESULT, &anySamples);
+      query.isVisible = anySamples != 0;
+      query.isPending = false;
+    }
+  }
+  if (!query.isPending) {
+    if (!query.isVisible) ++statistics.skipped;
+    return query.isVisible;
+  }
+  // Still in flight, let the GPU decide without waiting for it.
+  glBeginConditionalRender(query.handle, GL_QUERY_NO_WAIT);
+  isConditional = true;
+  ++statistics.conditional;
+  return true;
+}
+
+void OcclusionCuller::endDraw() {
+  if (isConditional) glEndConditionalRender();
+  isConditional = false;
+}
+
+void OcclusionCuller::issueQueries() {
+  if (queriedShapes.empty()) return;
+  constexpr GLenum target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+  OpenGLStateCache& state = OpenGLContext::getStateCache();
+  proxyProgram.use();
+  proxyVertexArray.bind();
+  state.setDepthMask(false);
+  glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+  for (const shape::Shape* shape : queriedShapes) {
+    Query& query = queries[shape];
+    query.lastFrame = frame;
+    // One query per shape in flight, the result of the previous one is still to come.
+    if (query.isPending) continue;
+    if (query.handle == 0) glGenQueries(1, &query.handle);
+    const shape::Bounds& bounds = shape->getLocalBounds();
+    glm::mat4 boxMatrix = glm::translate(viewProjection * shape->getModelMatrix(), bounds.min);
+    boxMatrix = glm::scale(boxMatrix, bounds.max - bounds.min);
+    proxyProgram.setUniformMatrix(boxMatrixLocation, glm::value_ptr(boxMatrix));
+    glBeginQuery(target, query.handle);
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, nullptr);
+    glEndQuery(target);
+    query.isPending = true;
+  }
+  glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  state.setDepthMask(true);
+}
+
+void OcclusionCuller::resizePyramid(int width, int height) {
+  releasePyramid();
+  pyramidWidth = width;
+  pyramidHeight = height;
+  pyramidLevels = static_cast<int>(std::floor(std::log2(std::max(width, height)))) + 1;
+  depthCopy = createTexture(GL_DEPTH_COMPONENT32F, 1, width, height);
+  pyramid = createTexture(GL_R32F, pyramidLevels, width, height);
+}
+
+void OcclusionCuller::releasePyramid() {
+  OpenGLStateCache& state = OpenGLContext::getStateCache();
+  if (depthCopy) state.deleteTexture(depthCopy);
+  if (pyramid) state.deleteTexture(pyramid);
+  depthCopy = pyramid = 0;
+  pyramidWidth = pyramidHeight = pyramidLevels = 0;
+  hasPyramid = false;
+}
+}  // namespace graphics::render
@@ -0,0 +1,305 @@
+#include "render/renderqueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "context_manager.h"
+
+namespace {
+constexpr int depthBits = 24;
+constexpr int vertexArrayBits = 12;
+constexpr int textureBits = 12;
+constexpr int programBits = 12;
+constexpr int vertexArrayShift = depthBits;
+constexpr int textureShift = vertexArrayShift + vertexArrayBits;
+constexpr int programShift = textureShift + textureBits;
+constexpr int passShift = programShift + programBits;
+// Transparent items sort by depth right under the pass, the state fields move down below it and only break ties.
+constexpr int transparentDepthShift = passShift - depthBits;
+constexpr int transparentStateShift = -depthBits;
+constexpr uint32_t depthMax = (1u << depthBits) - 1;
+
+constexpr uint64_t field(uint64_t value, int bits, int shift) { return (value & ((1ull << bits) - 1)) << shift; }
+constexpr graphics::render::Pass getPass(uint64_t key) {
+  return static_cast<graphics::render::Pass>((key >> passShift) & 0xF);
+}
+
+constexpr int radixBits = 11;
+constexpr int radixBuckets = 1 << radixBits;
+constexpr int radixPasses = (64 + radixBits - 1) / radixBits;
+constexpr uint32_t getDigit(uint64_t key, int pass) {
+  return static_cast<uint32_t>(key >> (pass * radixBits)) & (radixBuckets - 1);
+}
+
+/**
+ * LSD radix sort of keys with their values, 11 bits per pass. All histograms are counted in one read, passes where
+ * every key has the same digit (e.g. a single pass or program) are skipped. The result ends up in keys / values, the
+ * buffers are scratch space kept between calls.
+ */
+void radixSort(std::vector<uint64_t>& keys,
+               std::vector<uint32_t>& values,
+               std::vector<uint64_t>& keyBuffer,
+               std::vector<uint32_t>& valueBuffer,
+               std::vector<uint32_t>& histograms) {
+  const std::size_t count = keys.size();
+  keyBuffer.resize(count);
+  valueBuffer.resize(count);
+  histograms.assign(radixPasses * radixBuckets, 0);
+  for (uint64_t key : keys)
+    for (int pass = 0; pass < radixPasses; ++pass) ++histograms[pass * radixBuckets + getDigit(key, pass)];
+  for (int pass = 0; pass < radixPasses; ++pass) {
+    uint32_t* histogram = &histograms[pass * radixBuckets];
+    if (histogram[getDigit(keys[0], pass)] == count) continue;
+    uint32_t offset = 0;
+    for (int bucket = 0; bucket < radixBuckets; ++bucket) {
+      uint32_t size = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += size;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      uint32_t target = histogram[getDigit(keys[i], pass)]++;
+      keyBuffer[target] = keys[i];
+      valueBuffer[target] = values[i];
+    }
+    keys.swap(keyBuffer);
+    values.swap(valueBuffer);
+  }
+}
+}  // namespace
+
+namespace graphics::render {
+void RenderQueue::setObjectBuffer(const buffer::UniformBuffer* buffer, GLuint binding, GLuint size) {
+  objectBuffer = buffer;
+  objectBinding = binding;
+  objectSize = size;
+}
+
+void RenderQueue::begin(const glm::vec3& _eye, float farPlane) {
+  eye = _eye;
+  depthScale = farPlane > 0 ? depthMax / farPlane : 0;
+  items.clear();
+  keys.clear();
+  statistics = Statistics();
+}
+
+void RenderQueue::push(const utils::Mesh& mesh, Pass pass, GLuint objectOffset) {
+  shape::Geometry* geometry = mesh.shape->getGeometry();
+  const PoolRange* range = submission == Submission::Indirect ? &pool.get(*geometry) : nullptr;
+  uint64_t textureHash = 14695981039346656037ull;
+  for (const texture::Texture* texture : mesh.textures) {
+    GLuint handle = texture ? texture->getHandle() : 0;
+    textureHash = shape::hashBytes(&handle, sizeof(handle), textureHash);
+  }
+  const float* model = mesh.shape->getModelMatrixPTR();
+  glm::vec3 origin(model[12], model[13], model[14]);
+  float distance = std::min(glm::length(origin - eye) * depthScale, static_cast<float>(depthMax));
+  GLuint vertexArray = range ? range->batch + 1 : geometry->getVertexArrayHandle();
+  keys.push_back(makeKey(pass, mesh.program->getHandle(), textureHash, vertexArray, static_cast<uint32_t>(distance)));
+  items.push_back(Item{mesh.shape, mesh.program, &mesh.textures, geometry, range, objectOffset});
+}
+
+uint64_t RenderQueue::makeKey(Pass pass, GLuint program, uint64_t textureHash, GLuint vertexArray, uint32_t depth) {
+  const int stateShift = pass == Pass::Transparent ? transparentStateShift : 0;
+  uint64_t key = field(static_cast<uint64_t>(pass), 4, passShift);
+  key |= field(program, programBits, programShift + stateShift);
+  key |= field(textureHash ^ (textureHash >> 32), textureBits, textureShift + stateShift);
+  key |= field(vertexArray, vertexArrayBits, vertexArrayShift + stateShift);
+  depth = std::min(depth, depthMax);
+  if (pass == Pass::Transparent) return key | field(depthMax - depth, depthBits, transparentDepthShift);
+  return key | depth;
+}
+
+void RenderQueue::submit() {
+  statistics.items = items.size();
+  if (items.empty()) return;
+  auto start = std::chrono::steady_clock::now();
+  order.resize(items.size());
+  for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+  radixSort(keys, order, sortedKeys, sortedOrder, histograms);
+  auto sorted = std::chrono::steady_clock::now();
+
+  if (currentTextures.empty()) {
+    GLint units = 0;
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &units);
+    currentTextures.resize(units);
+  }
+  resetBindings();
+  if (submission == Submission::Indirect) {
+    submitIndirect();
+  } else {
+    submitDirect();
+  }
+  auto end = std::chrono::steady_clock::now();
+  statistics.sortMilliseconds = std::chrono::duration<double, std::milli>(sorted - start).count();
+  statistics.submitMilliseconds = std::chrono::duration<double, std::milli>(end - sorted).count();
+}
+
+void RenderQueue::resetBindings() {
+  currentProgram = nullptr;
+  currentTextureSet = nullptr;
+  std::fill(currentTextures.begin(), currentTextures.end(), 0);
+}
+
+void RenderQueue::bindMaterial(const Item& item) {
+  if (item.program != currentProgram) {
+    item.program->use();
+    currentProgram = item.program;
+    ++statistics.programSwitches;
+  }
+  // Meshes usually share their texture vector only with themselves, compare per unit to skip equal sets.
+  if (item.textures == currentTextureSet) return;
+  const std::vector<texture::Texture*>& textures = *item.textures;
+  if (textures.size() > currentTextures.size())
+    THROW_EXCEPTION(std::runtime_error, "More textures than texture units: " + std::to_string(textures.size()));
+  for (std::size_t unit = 0; unit < textures.size(); ++unit) {
+    if (!textures[unit] || textures[unit]->getHandle() == currentTextures[unit]) continue;
+    textures[unit]->bind(static_cast<GLuint>(unit));
+    currentTextures[unit] = textures[unit]->getHandle();
+    ++statistics.textureSwitches;
+  }
+  currentTextureSet = item.textures;
+}
+
+void RenderQueue::submitDirect() {
+  GLuint currentVertexArray = 0;
+  GLuint currentObjectOffset = 0;
+  bool objectBound = false;
+  const bool queries = occlusion && occlusion->getMode() == Occlusion::Queries;
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    const Item& item = items[order[i]];
+    const bool isTested = queries && getPass(keys[i]) == Pass::Opaque;
+    if (isTested && !occlusion->beginDraw(*item.shape)) continue;
+    bindMaterial(item);
+    if (objectBuffer && (!objectBound || item.objectOffset != currentObjectOffset)) {
+      objectBuffer->bindUniformBlockIndex(objectBinding, item.objectOffset, objectSize);
+      currentObjectOffset = item.objectOffset;
+      objectBound = true;
+      ++statistics.objectBufferSwitches;
+    }
+    GLuint vertexArray = item.geometry->getVertexArrayHandle();
+    if (vertexArray != currentVertexArray) {
+      item.geometry->bind();
+      currentVertexArray = vertexArray;
+      ++statistics.vertexArraySwitches;
+    }
+    item.shape->preDraw();
+    item.geometry->drawBound();
+    item.shape->postDraw();
+    if (isTested) occlusion->endDraw();
+    ++statistics.drawCalls;
+  }
+  if (queries) occlusion->issueQueries();
+}
+
+void RenderQueue::submitIndirect() {
+  const uint32_t count = static_cast<uint32_t>(order.size());
+  const Occlusion occlusionMode = occlusion ? occlusion->getMode() : Occlusion::Off;
+  const bool hierarchicalZ = occlusionMode == Occlusion::HierarchicalZ;
+  if (storageAlignment == 0) glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+  const GLsizeiptr objectBytes = count * sizeof(ObjectData), commandBytes = count * sizeof(DrawCommand);
+  // The culling shader also reads the bounds and writes both command arrays as storage blocks.
+  const GLsizeiptr boundsBytes = hierarchicalZ ? count * sizeof(ObjectBounds) : 0;
+  const GLsizeiptr occlusionBytes = hierarchicalZ ? boundsBytes + commandBytes + 3 * storageAlignment : 0;
+  const GLsizeiptr commandAlignment = hierarchicalZ ? storageAlignment : alignof(DrawCommand);
+  // Grow with headroom so a slowly growing scene does not recreate the ring every frame.
+  stream.reserve((objectBytes + commandBytes + occlusionBytes + 2 * storageAlignment) * 3 / 2);
+  stream.beginFrame();
+  buffer::StreamBuffer::Allocation objectAllocation = stream.allocate(objectBytes, storageAlignment);
+  buffer::StreamBuffer::Allocation commandAllocation = stream.allocate(commandBytes, commandAlignment);
+  buffer::StreamBuffer::Allocation boundsAllocation{}, lateAllocation{};
+  if (hierarchicalZ) {
+    boundsAllocation = stream.allocate(boundsBytes, storageAlignment);
+    lateAllocation = stream.allocate(commandBytes, storageAlignment);
+  }
+  // Object i and command i belong to the i-th sorted item, baseInstance = i makes objectIndex = i.
+  ObjectData* objects = static_cast<ObjectData*>(objectAllocation.pointer);
+  DrawCommand* commands = static_cast<DrawCommand*>(commandAllocation.pointer);
+  ObjectBounds* bounds = static_cast<ObjectBounds*>(boundsAllocation.pointer);
+  DrawCommand* lateCommands = static_cast<DrawCommand*>(lateAllocation.pointer);
+  for (uint32_t i = 0; i < count; ++i) {
+    const Item& item = items[order[i]];
+    objects[i].modelMatrix = item.shape->getModelMatrix();
+    objects[i].normalMatrix = item.shape->getNormalMatrix();
+    commands[i] = DrawCommand{item.range->indexCount, 1, item.range->firstIndex, item.range->baseVertex, i};
+    if (!hierarchicalZ) continue;
+    const shape::Bounds& local = item.shape->getLocalBounds();
+    const float isTested = getPass(keys[i]) == Pass::Opaque ? 1.0f : 0.0f;
+    bounds[i] = ObjectBounds{glm::vec4(local.min, isTested), glm::vec4(local.max, 0.0f)};
+    // Phase 2 sets the instance count of what it recovers.
+    lateCommands[i] = commands[i];
+    lateCommands[i].instanceCount = 0;
+  }
+  stream.flush();
+  pool.reserveObjects(count);
+  statistics.uploadedBytes = objectBytes + commandBytes + (hierarchicalZ ? boundsBytes + commandBytes : 0);
+  stream.bindRange(GL_SHADER_STORAGE_BUFFER, objectStorageBinding, objectAllocation.offset, objectBytes);
+  stream.bind(GL_DRAW_INDIRECT_BUFFER);
+
+  bool isCulledEarly = false;
+  if (hierarchicalZ) {
+    stream.bindRange(GL_SHADER_STORAGE_BUFFER, OcclusionCuller::boundsStorageBinding, boundsAllocation.offset,
+                     boundsBytes);
+    stream.bindRange(GL_SHADER_STORAGE_BUFFER, OcclusionCuller::commandStorageBinding, commandAllocation.offset,
+                     commandBytes);
+    stream.bindRange(GL_SHADER_STORAGE_BUFFER, OcclusionCuller::lateCommandStorageBinding, lateAllocation.offset,
+                     commandBytes);
+    isCulledEarly = occlusion->cullEarly(count);
+  }
+  // Keys sort by pass first, the opaque items come first.
+  const uint32_t opaqueCount = static_cast<uint32_t>(
+      std::find_if(keys.begin(), keys.end(), [](uint64_t key) { return getPass(key) != Pass::Opaque; }) - keys.begin());
+  const bool queries = occlusionMode == Occlusion::Queries;
+  drawRuns(commandAllocation.offset, 0, opaqueCount, queries);
+  if (hierarchicalZ) {
+    // The pyramid is built from opaque depth only, and what it recovers is drawn before anything is blended over it.
+    occlusion->cullLate(count, isCulledEarly);
+    // Runs keep their shape, only the instance counts of the late commands differ.
+    if (isCulledEarly) drawRuns(lateAllocation.offset, 0, opaqueCount, false);
+  }
+  drawRuns(commandAllocation.offset, opaqueCount, count, queries);
+  if (occlusionMode == Occlusion::Queries) occlusion->issueQueries();
+  stream.endFrame();
+}
+
+void RenderQueue::drawRuns(GLintptr commandOffset, uint32_t begin, uint32_t count, bool queries) {
+  // The culling shaders may have changed the program and texture bindings since the last run.
+  resetBindings();
+  uint32_t currentBatch = UINT32_MAX;
+  for (uint32_t first = begin, last; first < count; first = last) {
+    const Item& item = items[order[first]];
+    const uint32_t batch = item.range->batch;
+    // Items under an occlusion query are drawn alone.
+    const bool isTested = queries && getPass(keys[first]) == Pass::Opaque;
+    last = first + 1;
+    if (isTested && !occlusion->beginDraw(*item.shape)) continue;
+    if (!item.shape->hasDrawCallbacks() && !isTested) {
+      while (last < count) {
+        const Item& next = items[order[last]];
+        if (next.program != item.program || next.range->batch != batch || next.shape->hasDrawCallbacks() ||
+            (queries && getPass(keys[last]) == Pass::Opaque) ||
+            (next.textures != item.textures && *next.textures != *item.textures))
+          break;
+        ++last;
+      }
+    }
+    bindMaterial(item);
+    if (batch != currentBatch) {
+      pool.bind(batch);
+      currentBatch = batch;
+      ++statistics.vertexArraySwitches;
+    }
+    const GLenum primitive = pool.getPrimitive(batch), indexType = pool.getIndexType(batch);
+    OpenGLContext::getStateCache().setPrimitiveRestart(primitive == GL_TRIANGLE_STRIP,
+                                                       buffer::ElementArrayBuffer::getRestartIndex(indexType));
+    item.shape->preDraw();
+    const GLintptr runOffset = commandOffset + first * sizeof(DrawCommand);
+    glMultiDrawElementsIndirect(primitive, indexType, reinterpret_cast<const void*>(runOffset),
+                                static_cast<GLsizei>(last - first), 0);
+    item.shape->postDraw();
+    if (isTested) occlusion->endDraw();
+    ++statistics.drawCalls;
+  }
+}
+}  // namespace graphics::render
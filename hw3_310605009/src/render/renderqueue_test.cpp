@@ -0,0 +1,51 @@
+// Sort keys of RenderQueue: the transparent pass comes out back to front across programs, the opaque pass grouped by
+// program and front to back within one.
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "render/renderqueue.h"
+#include "testing.h"
+
+namespace {
+using graphics::render::Pass;
+using graphics::render::RenderQueue;
+
+struct TestItem {
+  GLuint program;
+  uint32_t depth;
+};
+
+/// @return Items in the order their keys sort to.
+std::vector<TestItem> sortItems(Pass pass, const std::vector<TestItem>& items) {
+  std::vector<std::pair<uint64_t, TestItem>> keyed;
+  for (const TestItem& item : items)
+    keyed.emplace_back(RenderQueue::makeKey(pass, item.program, 0, 1, item.depth), item);
+  std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  std::vector<TestItem> sorted;
+  for (const auto& entry : keyed) sorted.push_back(entry.second);
+  return sorted;
+}
+}  // namespace
+
+int main() {
+  // Two programs at interleaved depths
+  const std::vector<TestItem> items = {{1, 10}, {2, 20}, {1, 30}, {2, 40}};
+  const std::vector<TestItem> transparent = sortItems(Pass::Transparent, items);
+  for (std::size_t i = 1; i < transparent.size(); ++i) EXPECT(transparent[i - 1].depth > transparent[i].depth);
+
+  const std::vector<TestItem> opaque = sortItems(Pass::Opaque, items);
+  for (std::size_t i = 1; i < opaque.size(); ++i) {
+    EXPECT(opaque[i - 1].program <= opaque[i].program);
+    if (opaque[i - 1].program == opaque[i].program) EXPECT(opaque[i - 1].depth < opaque[i].depth);
+  }
+
+  // Passes stay in order whatever the depth.
+  EXPECT(RenderQueue::makeKey(Pass::Opaque, 4095, ~0ull, 4095, ~0u) <
+         RenderQueue::makeKey(Pass::Background, 0, 0, 0, 0));
+  EXPECT(RenderQueue::makeKey(Pass::Background, 4095, ~0ull, 4095, ~0u) <
+         RenderQueue::makeKey(Pass::Transparent, 0, 0, 0, ~0u));
+  // Equal depths fall back to the state, so equal state still merges.
+  EXPECT(RenderQueue::makeKey(Pass::Transparent, 1, 0, 1, 5) < RenderQueue::makeKey(Pass::Transparent, 2, 0, 1, 5));
+  return utils::testFailures() != 0;
+}
@@ -0,0 +1,498 @@
+#include "scene/bvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+using graphics::scene::Box;
+// Centroid bins per axis of the SAH build
+constexpr int binCount = 16;
+
+/// @brief Box that merging with any box leaves unchanged.
+Box emptyBox() {
+  constexpr float infinity = std::numeric_limits<float>::infinity();
+  return {glm::vec3(infinity), glm::vec3(-infinity)};
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @return Whether the ray enters the box before maxDistance, entry is 0 for origins inside the box.
+bool intersectRay(const Box& box, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                  float& entry) {
+  float near = 0, far = maxDistance;
+  for (int axis = 0; axis < 3; ++axis) {
+    float t0 = (box.min[axis] - origin[axis]) * inverseDirection[axis];
+    float t1 = (box.max[axis] - origin[axis]) * inverseDirection[axis];
+    if (t0 > t1) std::swap(t0, t1);
+    // Written so a NaN (an origin on a slab of a zero direction) keeps the previous interval.
+    near = t0 > near ? t0 : near;
+    far = t1 < far ? t1 : far;
+    if (near > far) return false;
+  }
+  entry = near;
+  return true;
+}
+}  // namespace
+
+namespace graphics::scene {
+Box Box::fromBounds(const shape::Bounds& bounds, const glm::mat4& modelMatrix) {
+  const glm::vec3 localCenter = 0.5f * (bounds.min + bounds.max), localExtent = bounds.getExtent();
+  glm::vec3 center, extent;
+  for (int row = 0; row < 3; ++row) {
+    center[row] = modelMatrix[3][row];
+    extent[row] = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+      center[row] += modelMatrix[axis][row] * localCenter[axis];
+      extent[row] += std::abs(modelMatrix[axis][row]) * localExtent[axis];
+    }
+  }
+  return {center - extent, center + extent};
+}
+
+Ray Ray::fromScreen(const glm::mat4& viewProjection, const glm::vec2& ndc) {
+  const glm::mat4 inverse = glm::inverse(viewProjection);
+  glm::vec4 near = inverse * glm::vec4(ndc.x, ndc.y, -1, 1);
+  glm::vec4 far = inverse * glm::vec4(ndc.x, ndc.y, 1, 1);
+  near /= near.w;
+  far /= far.w;
+  return {glm::vec3(near), glm::normalize(glm::vec3(far) - glm::vec3(near))};
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {
+  for (Object& object : objects)
+    if (object.isAlive && object.shape != nullptr) object.shape->registerTransformFunction(nullptr);
+}
+
+int BoundingVolumeHierarchy::add(const shape::Bounds& bounds, const glm::mat4& modelMatrix) {
+  int id;
+  if (freeObjects.empty()) {
+    id = static_cast<int>(objects.size());
+    objects.emplace_back();
+  } else {
+    id = freeObjects.back();
+    freeObjects.pop_back();
+    objects[id] = Object();
+  }
+  Object& object = objects[id];
+  object.bounds = bounds;
+  object.box = Box::fromBounds(bounds, modelMatrix);
+  object.isAlive = true;
+  if (id == static_cast<int>(culler.size()))
+    culler.add(bounds, modelMatrix);
+  else
+    culler.set(id, bounds, modelMatrix);
+  pendingObjects.push_back(id);
+  ++objectCount;
+  return id;
+}
+
+int BoundingVolumeHierarchy::add(shape::Shape* shape) {
+  const int id = add(shape->getLocalBounds(), shape->getModelMatrix());
+  objects[id].shape = shape;
+  shape->registerTransformFunction([this, id, shape] { setModelMatrix(id, shape->getModelMatrix()); });
+  return id;
+}
+
+void BoundingVolumeHierarchy::remove(int id) {
+  Object& object = objects[id];
+  if (!object.isAlive) return;
+  if (object.shape != nullptr) object.shape->registerTransformFunction(nullptr);
+  if (object.leaf >= 0) {
+    removeLeaf(object.leaf);
+    freeNode(object.leaf);
+  } else {
+    pendingObjects.erase(std::find(pendingObjects.begin(), pendingObjects.end(), id));
+  }
+  // A stale entry in movedObjects is skipped by update(), the object is no longer alive or not the same.
+  object = Object();
+  freeObjects.push_back(id);
+  --objectCount;
+}
+
+void BoundingVolumeHierarchy::setModelMatrix(int id, const glm::mat4& modelMatrix) {
+  Object& object = objects[id];
+  object.box = Box::fromBounds(object.bounds, modelMatrix);
+  culler.setModelMatrix(id, modelMatrix);
+  if (object.leaf >= 0 && !object.isMoved) {
+    object.isMoved = true;
+    movedObjects.push_back(id);
+  }
+}
+
+void BoundingVolumeHierarchy::update() {
+  if (!isBuilt) {
+    build();
+    return;
+  }
+  if (pendingObjects.empty() && movedObjects.empty() && statistics.objects == objectCount && !isUnfitted) return;
+  auto start = std::chrono::steady_clock::now();
+  statistics.refitLeaves = 0;
+  for (int id : movedObjects) {
+    Object& object = objects[id];
+    if (!object.isMoved) continue;
+    object.isMoved = false;
+    nodes[object.leaf].box = object.box;
+    ++statistics.refitLeaves;
+  }
+  // Walking up from every moved leaf revisits the upper levels, past a fraction of them the tree is left unfitted
+  // until fewer move. Leaves are current, inserting and removing below only refits boxes that refitAll() redoes.
+  if (statistics.refitLeaves * flatCullDivisor > objectCount) {
+    isUnfitted = true;
+  } else if (isUnfitted) {
+    refitUnfitted();
+  } else {
+    for (int id : movedObjects)
+      if (objects[id].leaf >= 0) refitAncestors(nodes[objects[id].leaf].parent);
+  }
+  movedObjects.clear();
+  for (int id : pendingObjects) {
+    const int leaf = allocateNode();
+    nodes[leaf].box = objects[id].box;
+    nodes[leaf].object = id;
+    objects[id].leaf = leaf;
+    insertLeaf(leaf);
+  }
+  pendingObjects.clear();
+  statistics.objects = objectCount;
+  statistics.nodes = nodes.size() - freeNodes.size();
+  statistics.isFlatCull = isUnfitted;
+  statistics.refitMilliseconds = millisecondsSince(start);
+  // The cost of unfitted boxes means nothing, it is checked once the tree is refit.
+  if (isUnfitted) return;
+  statistics.costRatio = buildCost > 0 ? computeCost() / buildCost : 1;
+  // A tree built with less than two objects has no cost to compare with.
+  if (statistics.costRatio > rebuildRatio || (buildCost == 0 && objectCount > 1)) build();
+}
+
+void BoundingVolumeHierarchy::build() {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<BuildItem> items;
+  items.reserve(objectCount);
+  for (int id = 0; id < static_cast<int>(objects.size()); ++id) {
+    if (!objects[id].isAlive) continue;
+    objects[id].isMoved = false;
+    items.push_back({objects[id].box, objects[id].box.getCenter(), id});
+  }
+  pendingObjects.clear();
+  movedObjects.clear();
+  nodes.clear();
+  freeNodes.clear();
+  nodes.reserve(items.empty() ? 0 : 2 * items.size() - 1);
+  statistics.depth = 0;
+  root = items.empty() ? -1 : buildRange(items, 0, static_cast<int>(items.size()), -1, 1);
+  isBuilt = true;
+  isUnfitted = false;
+  buildCost = computeCost();
+  statistics.objects = objectCount;
+  statistics.nodes = nodes.size();
+  statistics.costRatio = 1;
+  statistics.isFlatCull = false;
+  ++statistics.builds;
+  statistics.buildMilliseconds = millisecondsSince(start);
+}
+
+int BoundingVolumeHierarchy::allocateNode() {
+  if (freeNodes.empty()) {
+    nodes.emplace_back();
+    return static_cast<int>(nodes.size()) - 1;
+  }
+  const int node = freeNodes.back();
+  freeNodes.pop_back();
+  nodes[node] = Node();
+  return node;
+}
+
+void BoundingVolumeHierarchy::freeNode(int node) {
+  nodes[node] = Node();
+  freeNodes.push_back(node);
+}
+
+int BoundingVolumeHierarchy::buildRange(std::vector<BuildItem>& items, int first, int last, int parent, int depth) {
+  const int node = allocateNode();
+  nodes[node].parent = parent;
+  if (last - first == 1) {
+    statistics.depth = std::max(statistics.depth, depth);
+    const int id = items[first].object;
+    nodes[node].box = items[first].box;
+    nodes[node].object = id;
+    objects[id].leaf = node;
+    return node;
+  }
+  Box centroids = emptyBox();
+  for (int i = first; i < last; ++i) {
+    centroids.min = glm::min(centroids.min, items[i].center);
+    centroids.max = glm::max(centroids.max, items[i].center);
+  }
+  // Small ranges are binned coarser, most nodes are near the leaves.
+  const int bins = std::min(binCount, last - first);
+  const glm::vec3 size = centroids.max - centroids.min;
+  glm::vec3 scale;
+  for (int axis = 0; axis < 3; ++axis) scale[axis] = size[axis] > 0 ? bins / size[axis] : 0;
+  auto binOf = [&](const glm::vec3& center, int axis) {
+    return std::min(bins - 1, static_cast<int>((center[axis] - centroids.min[axis]) * scale[axis]));
+  };
+  // Bin the items along all three axes in one pass.
+  Box binBoxes[3][binCount];
+  int binCounts[3][binCount] = {};
+  for (auto& axisBoxes : binBoxes) std::fill(axisBoxes, axisBoxes + bins, emptyBox());
+  for (int i = first; i < last; ++i) {
+    for (int axis = 0; axis < 3; ++axis) {
+      const int bin = binOf(items[i].center, axis);
+      binBoxes[axis][bin] = Box::merge(binBoxes[axis][bin], items[i].box);
+      ++binCounts[axis][bin];
+    }
+  }
+  // Pick the bin boundary with the lowest area * count summed over both sides.
+  int bestAxis = -1, bestBin = 0;
+  float bestCost = std::numeric_limits<float>::max();
+  for (int axis = 0; axis < 3; ++axis) {
+    if (scale[axis] == 0) continue;
+    // rightArea[bin] and rightCount[bin] cover bins [bin, bins).
+    float rightArea[binCount];
+    int rightCount[binCount];
+    Box right = emptyBox();
+    for (int bin = bins - 1, count = 0; bin > 0; --bin) {
+      right = Box::merge(right, binBoxes[axis][bin]);
+      count += binCounts[axis][bin];
+      rightArea[bin] = right.getHalfArea();
+      rightCount[bin] = count;
+    }
+    Box left = emptyBox();
+    for (int bin = 1, count = 0; bin < bins; ++bin) {
+      left = Box::merge(left, binBoxes[axis][bin - 1]);
+      count += binCounts[axis][bin - 1];
+      if (count == 0 || rightCount[bin] == 0) continue;
+      const float cost = left.getHalfArea() * count + rightArea[bin] * rightCount[bin];
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestAxis = axis;
+        bestBin = bin;
+      }
+    }
+  }
+  // All centroids in one point, split in the middle.
+  int middle = (first + last) / 2;
+  if (bestAxis >= 0) {
+    auto split = std::partition(items.begin() + first, items.begin() + last,
+                                [&](const BuildItem& item) { return binOf(item.center, bestAxis) < bestBin; });
+    middle = static_cast<int>(split - items.begin());
+  }
+  // Nodes may reallocate while building the children, no references are held across the calls.
+  const int left = buildRange(items, first, middle, node, depth + 1);
+  const int right = buildRange(items, middle, last, node, depth + 1);
+  nodes[node].children[0] = left;
+  nodes[node].children[1] = right;
+  nodes[node].box = Box::merge(nodes[left].box, nodes[right].box);
+  return node;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(int leaf) {
+  if (root < 0) {
+    root = leaf;
+    nodes[leaf].parent = -1;
+    return;
+  }
+  // Descend towards the sibling whose new parent adds the least area, counting the growth of the ancestors.
+  const Box box = nodes[leaf].box;
+  int sibling = root;
+  while (!nodes[sibling].isLeaf()) {
+    const Node& node = nodes[sibling];
+    const float area = node.box.getHalfArea();
+    const float combinedArea = Box::merge(node.box, box).getHalfArea();
+    // Cost of making the leaf this node's sibling, and the growth every deeper choice inherits.
+    const float cost = 2 * combinedArea;
+    const float inheritedCost = 2 * (combinedArea - area);
+    float childCosts[2];
+    for (int i = 0; i < 2; ++i) {
+      const Node& child = nodes[node.children[i]];
+      const float merged = Box::merge(child.box, box).getHalfArea();
+      childCosts[i] = (child.isLeaf() ? merged : merged - child.box.getHalfArea()) + inheritedCost;
+    }
+    if (cost < childCosts[0] && cost < childCosts[1]) break;
+    sibling = node.children[childCosts[0] < childCosts[1] ? 0 : 1];
+  }
+  const int oldParent = nodes[sibling].parent;
+  const int newParent = allocateNode();
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].box = Box::merge(nodes[sibling].box, box);
+  nodes[newParent].children[0] = sibling;
+  nodes[newParent].children[1] = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+  if (oldParent < 0) {
+    root = newParent;
+    return;
+  }
+  Node& parent = nodes[oldParent];
+  parent.children[parent.children[0] == sibling ? 0 : 1] = newParent;
+  refitAncestors(oldParent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(int leaf) {
+  if (leaf == root) {
+    root = -1;
+    return;
+  }
+  const int parent = nodes[leaf].parent;
+  const int grandParent = nodes[parent].parent;
+  const int sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+  nodes[sibling].parent = grandParent;
+  freeNode(parent);
+  if (grandParent < 0) {
+    root = sibling;
+    return;
+  }
+  Node& node = nodes[grandParent];
+  node.children[node.children[0] == parent ? 0 : 1] = sibling;
+  refitAncestors(grandParent);
+}
+
+void BoundingVolumeHierarchy::refitAncestors(int node) {
+  while (node >= 0) {
+    Node& current = nodes[node];
+    const Box box = Box::merge(nodes[current.children[0]].box, nodes[current.children[1]].box);
+    if (box.min == current.box.min && box.max == current.box.max) return;
+    current.box = box;
+    node = current.parent;
+  }
+}
+
+void BoundingVolumeHierarchy::refitAll() {
+  if (root < 0) return;
+  // Parents come before their children in pre-order, so the reverse order refits children first.
+  std::vector<int> order;
+  order.reserve(nodes.size());
+  nodeStack.assign(1, {root, 0});
+  while (!nodeStack.empty()) {
+    const int node = nodeStack.back().first;
+    nodeStack.pop_back();
+    order.push_back(node);
+    if (nodes[node].isLeaf()) continue;
+    nodeStack.emplace_back(nodes[node].children[0], 0);
+    nodeStack.emplace_back(nodes[node].children[1], 0);
+  }
+  for (auto node = order.rbegin(); node != order.rend(); ++node) {
+    Node& current = nodes[*node];
+    if (!current.isLeaf())
+      current.box = Box::merge(nodes[current.children[0]].box, nodes[current.children[1]].box);
+  }
+}
+
+void BoundingVolumeHierarchy::refitUnfitted() {
+  if (!isUnfitted) return;
+  refitAll();
+  isUnfitted = false;
+  statistics.isFlatCull = false;
+}
+
+float BoundingVolumeHierarchy::computeCost() const {
+  if (root < 0) return 0;
+  // Free nodes look like leaves without an object, only internal nodes are summed.
+  float area = 0;
+  for (const Node& node : nodes)
+    if (!node.isLeaf()) area += node.box.getHalfArea();
+  const float rootArea = nodes[root].box.getHalfArea();
+  return rootArea > 0 ? area / rootArea : 0;
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const Frustum& frustum, std::vector<int>& result) {
+  auto start = std::chrono::steady_clock::now();
+  statistics.nodesVisited = 0;
+  if (isUnfitted) {
+    // Removed ids keep their last box in the culler.
+    culler.cull(frustum);
+    for (int id = 0; id < static_cast<int>(objects.size()); ++id)
+      if (objects[id].isAlive && culler.isVisible(id)) result.push_back(id);
+    statistics.queryMilliseconds = millisecondsSince(start);
+    return;
+  }
+  if (root < 0) return;
+  constexpr unsigned allPlanes = (1u << 6) - 1;
+  nodeStack.assign(1, {root, allPlanes});
+  while (!nodeStack.empty()) {
+    auto [index, planes] = nodeStack.back();
+    nodeStack.pop_back();
+    ++statistics.nodesVisited;
+    const Node& node = nodes[index];
+    // Planes the parent is fully inside of are not tested again, a node inside all of them is accepted as a whole.
+    if (planes != 0) {
+      const glm::vec3 center = node.box.getCenter(), extent = node.box.getExtent();
+      bool isOutside = false;
+      for (int p = 0; p < 6 && !isOutside; ++p) {
+        if (!(planes & (1u << p))) continue;
+        const glm::vec4& plane = frustum.planes[p];
+        const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        const float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+        isOutside = distance + radius < 0;
+        if (distance - radius >= 0) planes &= ~(1u << p);
+      }
+      if (isOutside) continue;
+    }
+    if (node.isLeaf()) {
+      result.push_back(node.object);
+    } else {
+      nodeStack.emplace_back(node.children[0], planes);
+      nodeStack.emplace_back(node.children[1], planes);
+    }
+  }
+  statistics.queryMilliseconds = millisecondsSince(start);
+}
+
+void BoundingVolumeHierarchy::queryOverlap(const Box& box, std::vector<int>& result) {
+  refitUnfitted();
+  auto start = std::chrono::steady_clock::now();
+  statistics.nodesVisited = 0;
+  if (root < 0) return;
+  nodeStack.assign(1, {root, 0});
+  while (!nodeStack.empty()) {
+    const Node& node = nodes[nodeStack.back().first];
+    nodeStack.pop_back();
+    ++statistics.nodesVisited;
+    if (!node.box.overlaps(box)) continue;
+    if (node.isLeaf()) {
+      result.push_back(node.object);
+    } else {
+      nodeStack.emplace_back(node.children[0], 0);
+      nodeStack.emplace_back(node.children[1], 0);
+    }
+  }
+  statistics.queryMilliseconds = millisecondsSince(start);
+}
+
+std::optional<RayHit> BoundingVolumeHierarchy::queryRay(const Ray& ray, float maxDistance) {
+  refitUnfitted();
+  auto start = std::chrono::steady_clock::now();
+  statistics.nodesVisited = 0;
+  std::optional<RayHit> hit;
+  const glm::vec3 inverseDirection = glm::vec3(1) / ray.direction;
+  float entry;
+  if (root < 0 || !intersectRay(nodes[root].box, ray.origin, inverseDirection, maxDistance, entry)) return hit;
+  rayStack.assign(1, {root, entry});
+  // Children are visited nearest first, nodes entered after the closest hit so far are skipped.
+  while (!rayStack.empty()) {
+    auto [index, distance] = rayStack.back();
+    rayStack.pop_back();
+    if (hit && distance >= hit->distance) continue;
+    ++statistics.nodesVisited;
+    const Node& node = nodes[index];
+    if (node.isLeaf()) {
+      hit = RayHit{node.object, distance};
+      maxDistance = distance;
+      continue;
+    }
+    float entries[2];
+    bool isHit[2];
+    for (int i = 0; i < 2; ++i)
+      isHit[i] = intersectRay(nodes[node.children[i]].box, ray.origin, inverseDirection, maxDistance, entries[i]);
+    const int nearer = isHit[0] && (!isHit[1] || entries[0] <= entries[1]) ? 0 : 1;
+    if (isHit[1 - nearer]) rayStack.emplace_back(node.children[1 - nearer], entries[1 - nearer]);
+    if (isHit[nearer]) rayStack.emplace_back(node.children[nearer], entries[nearer]);
+  }
+  statistics.queryMilliseconds = millisecondsSince(start);
+  return hit;
+}
+}  // namespace graphics::scene
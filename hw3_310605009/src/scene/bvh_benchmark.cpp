@@ -0,0 +1,155 @@
+// BoundingVolumeHierarchy build, frustum, ray and overlap queries against linear loops over the same boxes, then
+// update() plus a frustum query per frame with part of the objects moving, for up to 1M random objects (or the
+// first argument). Queries must find the same objects as the loops.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "benchmark.h"
+#include "scene/bvh.h"
+
+namespace {
+using graphics::scene::BoundingVolumeHierarchy;
+using graphics::scene::Box;
+using graphics::scene::Frustum;
+using graphics::scene::Ray;
+
+/// @return Distance to the closest box the ray enters, negative when it misses all of them.
+float castLinear(const BoundingVolumeHierarchy& hierarchy, int count, const Ray& ray) {
+  const glm::vec3 inverseDirection = glm::vec3(1) / ray.direction;
+  float closest = -1;
+  for (int i = 0; i < count; ++i) {
+    const Box& box = hierarchy.getBox(i);
+    float near = 0, far = closest < 0 ? 1e30f : closest;
+    for (int axis = 0; axis < 3; ++axis) {
+      float t0 = (box.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+      float t1 = (box.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+      if (t0 > t1) std::swap(t0, t1);
+      near = std::max(near, t0);
+      far = std::min(far, t1);
+    }
+    if (near <= far) closest = near;
+  }
+  return closest;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int maxCount = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  const glm::mat4 view = glm::lookAt(glm::vec3(0, 2, 5), glm::vec3(0), glm::vec3(0, 1, 0));
+  const Frustum frustum = Frustum::fromMatrix(projection * view);
+  const graphics::shape::Bounds bounds = graphics::shape::Bounds::fromBox(glm::vec3(-1), glm::vec3(1));
+  constexpr int rayCount = 1000, linearRayCount = 20, overlapCount = 20;
+  std::printf("%10s %10s %6s %11s %11s %11s %11s %11s %11s\n", "objects", "build ms", "depth", "frustum ms",
+              "linear ms", "ray us", "linear us", "overlap us", "linear us");
+  for (int count = 10000; count <= maxCount; count *= 10) {
+    std::mt19937 random(count);
+    std::uniform_real_distribution<float> position(-200, 200), scale(0.5f, 3), unit(-1, 1);
+    BoundingVolumeHierarchy hierarchy;
+    std::vector<glm::mat4> models;
+    for (int i = 0; i < count; ++i) {
+      const glm::vec3 translation(position(random), position(random) * 0.1f, position(random));
+      models.push_back(glm::scale(glm::translate(glm::mat4(1), translation), glm::vec3(scale(random))));
+      hierarchy.add(bounds, models.back());
+    }
+    hierarchy.update();
+    const auto& statistics = hierarchy.getStatistics();
+    int mismatches = 0;
+
+    std::vector<int> visible, linearVisible;
+    const double frustumMilliseconds = utils::measureMilliseconds(5, [&] {
+      visible.clear();
+      hierarchy.queryFrustum(frustum, visible);
+    });
+    const double linearFrustumMilliseconds = utils::measureMilliseconds(5, [&] {
+      linearVisible.clear();
+      for (int i = 0; i < count; ++i) {
+        const Box& box = hierarchy.getBox(i);
+        if (frustum.intersects(box.getCenter(), box.getExtent())) linearVisible.push_back(i);
+      }
+    });
+    std::sort(visible.begin(), visible.end());
+    mismatches += visible != linearVisible;
+
+    std::vector<Ray> rays;
+    for (int i = 0; i < rayCount; ++i) rays.push_back(Ray::fromScreen(projection * view, {unit(random), unit(random)}));
+    std::vector<float> distances(rayCount);
+    const double rayMilliseconds = utils::measureMilliseconds(5, [&] {
+      for (int i = 0; i < rayCount; ++i) {
+        const auto hit = hierarchy.queryRay(rays[i]);
+        distances[i] = hit ? hit->distance : -1;
+      }
+    });
+    std::vector<float> linearDistances(linearRayCount);
+    const double linearRayMilliseconds = utils::measureMilliseconds(1, [&] {
+      for (int i = 0; i < linearRayCount; ++i) linearDistances[i] = castLinear(hierarchy, count, rays[i]);
+    });
+    for (int i = 0; i < linearRayCount; ++i) mismatches += distances[i] != linearDistances[i];
+
+    std::vector<Box> boxes;
+    for (int i = 0; i < overlapCount; ++i) {
+      const glm::vec3 center(position(random), position(random) * 0.1f, position(random));
+      boxes.push_back({center - glm::vec3(5), center + glm::vec3(5)});
+    }
+    std::size_t overlaps = 0, linearOverlaps = 0;
+    std::vector<int> found;
+    const double overlapMilliseconds = utils::measureMilliseconds(5, [&] {
+      overlaps = 0;
+      for (const Box& box : boxes) {
+        found.clear();
+        hierarchy.queryOverlap(box, found);
+        overlaps += found.size();
+      }
+    });
+    const double linearOverlapMilliseconds = utils::measureMilliseconds(1, [&] {
+      linearOverlaps = 0;
+      for (const Box& box : boxes)
+        for (int i = 0; i < count; ++i) linearOverlaps += hierarchy.getBox(i).overlaps(box);
+    });
+    mismatches += overlaps != linearOverlaps;
+
+    std::printf("%10d %10.2f %6d %11.3f %11.3f %11.2f %11.2f %11.2f %11.2f\n", count, statistics.buildMilliseconds,
+                statistics.depth, frustumMilliseconds, linearFrustumMilliseconds, 1000 * rayMilliseconds / rayCount,
+                1000 * linearRayMilliseconds / linearRayCount, 1000 * overlapMilliseconds / overlapCount,
+                1000 * linearOverlapMilliseconds / overlapCount);
+    if (mismatches) std::printf("%d queries differ from the linear loops\n", mismatches);
+  }
+
+  // Objects moved with setModelMatrix, then update() and a frustum query as a frame would do.
+  std::printf("\n%10s %8s %12s %12s %10s %8s\n", "objects", "moved", "frame ms", "update ms", "flat cull", "builds");
+  for (int count = 10000; count <= maxCount; count *= 10) {
+    for (int percent : {1, 10, 100}) {
+      std::mt19937 random(count + percent);
+      std::uniform_real_distribution<float> position(-200, 200), step(-1, 1);
+      BoundingVolumeHierarchy hierarchy;
+      std::vector<glm::mat4> models;
+      for (int i = 0; i < count; ++i) {
+        const glm::vec3 translation(position(random), position(random) * 0.1f, position(random));
+        models.push_back(glm::translate(glm::mat4(1), translation));
+        hierarchy.add(bounds, models.back());
+      }
+      hierarchy.update();
+      const int moved = static_cast<int>(static_cast<long long>(count) * percent / 100);
+      std::vector<int> visible;
+      double updateMilliseconds = 0;
+      const double frameMilliseconds = utils::measureMilliseconds(5, [&] {
+        for (int i = 0; i < moved; ++i) {
+          const int id = percent == 100 ? i : static_cast<int>(random() % count);
+          models[id] = glm::translate(models[id], glm::vec3(step(random), 0, step(random)));
+          hierarchy.setModelMatrix(id, models[id]);
+        }
+        updateMilliseconds = utils::measureMilliseconds(1, [&] { hierarchy.update(); });
+        visible.clear();
+        hierarchy.queryFrustum(frustum, visible);
+      });
+      const auto& statistics = hierarchy.getStatistics();
+      std::printf("%10d %7d%% %12.3f %12.3f %10s %8zu\n", count, percent, frameMilliseconds, updateMilliseconds,
+                  statistics.isFlatCull ? "yes" : "no", statistics.builds);
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#include "scene/culling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_USE_SSE 1
+#endif
+
+namespace {
+// Objects are stored in groups of this many, the SIMD width.
+constexpr std::size_t groupSize = 4;
+}  // namespace
+
+namespace graphics::scene {
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+  // Rows of the matrix, glm is column major.
+  const glm::mat4 rows = glm::transpose(viewProjection);
+  Frustum frustum;
+  frustum.planes = {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                    rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+  for (glm::vec4& plane : frustum.planes) plane /= glm::length(glm::vec3(plane));
+  return frustum;
+}
+
+bool Frustum::intersects(const glm::vec3& center, const glm::vec3& extent) const {
+  for (const glm::vec4& plane : planes) {
+    glm::vec3 normal(plane);
+    // Distance of the box corner farthest along the normal.
+    if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent) < 0) return false;
+  }
+  return true;
+}
+
+void FrustumCuller::clear() { count = 0; }
+
+std::size_t FrustumCuller::add(const shape::Bounds& bounds, const glm::mat4& modelMatrix) {
+  if (count == visible.size()) {
+    // Grow by a whole group, lanes past count are computed but never read.
+    const std::size_t size = count + groupSize;
+    for (auto& array : center) array.resize(size);
+    for (auto& array : extent) array.resize(size);
+    for (auto& array : model) array.resize(size);
+    visible.resize(size);
+  }
+  set(count, bounds, modelMatrix);
+  return count++;
+}
+
+void FrustumCuller::set(std::size_t index, const shape::Bounds& bounds, const glm::mat4& modelMatrix) {
+  const glm::vec3 boxCenter = 0.5f * (bounds.min + bounds.max), boxExtent = bounds.getExtent();
+  for (int axis = 0; axis < 3; ++axis) {
+    center[axis][index] = boxCenter[axis];
+    extent[axis][index] = boxExtent[axis];
+  }
+  setModelMatrix(index, modelMatrix);
+}
+
+void FrustumCuller::setModelMatrix(std::size_t index, const glm::mat4& modelMatrix) {
+  for (int row = 0; row < 3; ++row)
+    for (int column = 0; column < 4; ++column) model[row * 4 + column][index] = modelMatrix[column][row];
+}
+
+void FrustumCuller::cull(const Frustum& frustum) {
+  auto start = std::chrono::steady_clock::now();
+  const int groups = static_cast<int>((count + groupSize - 1) / groupSize);
+  std::atomic<std::size_t> culled = 0;
+  std::atomic<int> threads = 0;
+  utils::parallelFor(groups, threadThreshold / groupSize, [&](int first, int last) {
+    ++threads;
+    culled += cullRange(frustum, first * groupSize, std::min(count, last * groupSize));
+  });
+  statistics.tested = count;
+  statistics.culled = culled;
+  statistics.threads = threads;
+  statistics.milliseconds =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t FrustumCuller::cullRange(const Frustum& frustum, std::size_t first, std::size_t last) {
+  std::size_t culled = 0;
+#ifdef CULLING_USE_SSE
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  __m128 planes[6][7];
+  for (int p = 0; p < 6; ++p) {
+    const glm::vec4& plane = frustum.planes[p];
+    for (int axis = 0; axis < 3; ++axis) {
+      planes[p][axis] = _mm_set1_ps(plane[axis]);
+      planes[p][axis + 3] = _mm_set1_ps(std::abs(plane[axis]));
+    }
+    planes[p][6] = _mm_set1_ps(plane.w);
+  }
+  for (std::size_t i = first; i < last; i += groupSize) {
+    __m128 localCenter[3], localExtent[3], worldCenter[3], worldExtent[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      localCenter[axis] = _mm_loadu_ps(&center[axis][i]);
+      localExtent[axis] = _mm_loadu_ps(&extent[axis][i]);
+    }
+    // World box: the center is transformed, the extent by the absolute 3x3 part.
+    for (int row = 0; row < 3; ++row) {
+      __m128 m0 = _mm_loadu_ps(&model[row * 4][i]), m1 = _mm_loadu_ps(&model[row * 4 + 1][i]);
+      __m128 m2 = _mm_loadu_ps(&model[row * 4 + 2][i]), m3 = _mm_loadu_ps(&model[row * 4 + 3][i]);
+      worldCenter[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, localCenter[0]), _mm_mul_ps(m1, localCenter[1])),
+                                    _mm_add_ps(_mm_mul_ps(m2, localCenter[2]), m3));
+      worldExtent[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, m0), localExtent[0]),
+                                               _mm_mul_ps(_mm_andnot_ps(signMask, m1), localExtent[1])),
+                                    _mm_mul_ps(_mm_andnot_ps(signMask, m2), localExtent[2]));
+    }
+    __m128 outside = _mm_setzero_ps();
+    for (const auto& plane : planes) {
+      __m128 distance = _mm_add_ps(_mm_mul_ps(plane[0], worldCenter[0]), _mm_mul_ps(plane[1], worldCenter[1]));
+      distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(plane[2], worldCenter[2]), plane[6]));
+      // Plus the extent along the normal, i.e. the distance of the box corner farthest along it.
+      __m128 extentX = _mm_mul_ps(plane[3], worldExtent[0]), extentY = _mm_mul_ps(plane[4], worldExtent[1]);
+      distance = _mm_add_ps(distance, _mm_add_ps(extentX, extentY));
+      distance = _mm_add_ps(distance, _mm_mul_ps(plane[5], worldExtent[2]));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+    }
+    const int mask = _mm_movemask_ps(outside);
+    const std::size_t lanes = std::min(groupSize, last - i);
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+      visible[i + lane] = !(mask & (1 << lane));
+      culled += (mask >> lane) & 1;
+    }
+  }
+#else
+  for (std::size_t i = first; i < last; ++i) {
+    glm::vec3 worldCenter, worldExtent;
+    for (int row = 0; row < 3; ++row) {
+      worldCenter[row] = model[row * 4 + 3][i];
+      worldExtent[row] = 0;
+      for (int axis = 0; axis < 3; ++axis) {
+        worldCenter[row] += model[row * 4 + axis][i] * center[axis][i];
+        worldExtent[row] += std::abs(model[row * 4 + axis][i]) * extent[axis][i];
+      }
+    }
+    visible[i] = frustum.intersects(worldCenter, worldExtent);
+    culled += !visible[i];
+  }
+#endif
+  return culled;
+}
+}  // namespace graphics::scene
@@ -0,0 +1,56 @@
+// FrustumCuller::cull against a scalar loop of Frustum::intersects over the same world boxes, for up to 1M random
+// objects (or the first argument). Both must report the same visible objects.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "benchmark.h"
+#include "scene/culling.h"
+
+int main(int argc, char** argv) {
+  using graphics::scene::Frustum;
+  using graphics::scene::FrustumCuller;
+  const int maxCount = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  const glm::mat4 view = glm::lookAt(glm::vec3(0, 2, 5), glm::vec3(0), glm::vec3(0, 1, 0));
+  const Frustum frustum = Frustum::fromMatrix(projection * view);
+  const graphics::shape::Bounds bounds = graphics::shape::Bounds::fromBox(glm::vec3(-1), glm::vec3(1));
+  std::printf("%10s %12s %12s %10s %10s %8s\n", "objects", "culler ms", "scalar ms", "speedup", "visible", "threads");
+  for (int count = 1000; count <= maxCount; count *= 10) {
+    std::mt19937 random(count);
+    std::uniform_real_distribution<float> position(-200, 200), scale(0.5f, 3);
+    FrustumCuller culler;
+    std::vector<glm::mat4> models;
+    for (int i = 0; i < count; ++i) {
+      const glm::vec3 translation(position(random), position(random) * 0.1f, position(random));
+      models.push_back(glm::scale(glm::translate(glm::mat4(1), translation), glm::vec3(scale(random))));
+      culler.add(bounds, models.back());
+    }
+    const double cullerMilliseconds = utils::measureMilliseconds(5, [&] { culler.cull(projection * view); });
+    std::vector<char> visible(count);
+    const double scalarMilliseconds = utils::measureMilliseconds(5, [&] {
+      for (int i = 0; i < count; ++i) {
+        const glm::mat4& model = models[i];
+        const glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1));
+        glm::vec3 extent(0);
+        const glm::vec3 localExtent = bounds.getExtent();
+        for (int column = 0; column < 3; ++column)
+          for (int row = 0; row < 3; ++row) extent[row] += std::abs(model[column][row]) * localExtent[column];
+        visible[i] = frustum.intersects(center, extent);
+      }
+    });
+    int mismatches = 0, visibleCount = 0;
+    for (int i = 0; i < count; ++i) {
+      mismatches += culler.isVisible(i) != (visible[i] != 0);
+      visibleCount += culler.isVisible(i);
+    }
+    std::printf("%10d %12.3f %12.3f %9.2fx %10d %8d\n", count, cullerMilliseconds, scalarMilliseconds,
+                scalarMilliseconds / cullerMilliseconds, visibleCount, culler.getStatistics().threads);
+    if (mismatches) std::printf("%d objects differ from the scalar test\n", mismatches);
+  }
+}
@@ -0,0 +1,126 @@
+#include "shader/preprocessor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <system_error>
+
+#include <glad/gl.h>
+
+#include "file_watcher.h"
+#include "shader/shader.h"
+#include "shape/geometry.h"
+
+namespace {
+void report(const std::string& message) {
+  if (glDebugMessageInsert) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                         message.c_str());
+  } else {
+    puts(message.c_str());
+  }
+}
+
+utils::fs::file_time_type getWriteTime(const utils::fs::path& file) {
+  std::error_code error;
+  auto time = utils::fs::last_write_time(file, error);
+  return error ? utils::fs::file_time_type::min() : time;
+}
+
+/// @brief Drop leading spaces and tabs, then word if it follows. @return Whether word was dropped.
+bool consume(std::string_view& line, std::string_view word) {
+  line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+  if (line.compare(0, word.size(), word) != 0) return false;
+  line.remove_prefix(word.size());
+  return true;
+}
+}  // namespace
+
+namespace graphics::shader {
+utils::fs::path Preprocessor::root;
+std::map<utils::fs::path, Preprocessor::Entry> Preprocessor::cache;
+
+const Expansion& Preprocessor::expand(const utils::fs::path& file) {
+  const utils::fs::path path = utils::FileWatcher::normalize(file);
+  auto cached = cache.find(path);
+  if (cached != cache.end()) {
+    const Entry& entry = cached->second;
+    bool isCurrent = true;
+    for (std::size_t i = 0; i < entry.writeTimes.size() && isCurrent; ++i)
+      isCurrent = getWriteTime(entry.expansion.dependencies[i]) == entry.writeTimes[i];
+    if (isCurrent) return entry.expansion;
+  }
+  Entry entry;
+  std::vector<utils::fs::path> stack, included;
+  append(path, entry, stack, included);
+  entry.expansion.hash = shape::hashBytes(entry.expansion.code.data(), entry.expansion.code.size());
+  Entry& stored = cache[path];
+  stored = std::move(entry);
+  return stored.expansion;
+}
+
+void Preprocessor::append(const utils::fs::path& file,
+                          Entry& entry,
+                          std::vector<utils::fs::path>& stack,
+                          std::vector<utils::fs::path>& included) {
+  if (std::find(included.begin(), included.end(), file) != included.end()) return;
+  if (std::find(stack.begin(), stack.end(), file) != stack.end()) {
+    report("Shader include cycle: " + file.string() + " includes itself");
+    return;
+  }
+  Expansion& expansion = entry.expansion;
+  auto& dependencies = expansion.dependencies;
+  const std::size_t index = std::find(dependencies.begin(), dependencies.end(), file) - dependencies.begin();
+  if (index == dependencies.size()) {
+    // Time before contents, a write in between makes the next expand read the file again.
+    dependencies.push_back(file);
+    entry.writeTimes.push_back(getWriteTime(file));
+  }
+  const std::string code = readFile(file);
+  if (!stack.empty()) expansion.code += "#line 1 " + std::to_string(index) + "\n";
+  stack.push_back(file);
+  std::size_t lineNumber = 0;
+  for (std::size_t begin = 0; begin < code.size();) {
+    const std::size_t end = std::min(code.find('\n', begin), code.size());
+    const std::string_view line(code.data() + begin, end - begin);
+    begin = end + 1;
+    ++lineNumber;
+    std::string_view directive = line;
+    if (!consume(directive, "#")) {
+      (expansion.code += line) += '\n';
+      continue;
+    }
+    if (std::string_view rest = directive; consume(rest, "pragma") && consume(rest, "once")) {
+      // Kept as an empty line, the compiler would warn about the unknown pragma.
+      included.push_back(file);
+      expansion.code += '\n';
+      continue;
+    }
+    if (!consume(directive, "include")) {
+      (expansion.code += line) += '\n';
+      continue;
+    }
+    consume(directive, "");
+    const bool isQuoted = !directive.empty() && directive.front() == '"';
+    const std::size_t close = directive.find(isQuoted ? '"' : '>', 1);
+    if ((!isQuoted && (directive.empty() || directive.front() != '<')) || close == std::string_view::npos) {
+      report("Malformed #include in " + file.string() + ":" + std::to_string(lineNumber));
+      expansion.code += '\n';
+      continue;
+    }
+    const std::string name(directive.substr(1, close - 1));
+    append(resolve(name, isQuoted, file), entry, stack, included);
+    expansion.code += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(index) + "\n";
+  }
+  stack.pop_back();
+}
+
+utils::fs::path Preprocessor::resolve(const std::string& name, bool isQuoted, const utils::fs::path& includer) {
+  if (isQuoted) {
+    const utils::fs::path sibling = includer.parent_path() / name;
+    std::error_code error;
+    if (utils::fs::exists(sibling, error)) return utils::FileWatcher::normalize(sibling);
+  }
+  return utils::FileWatcher::normalize(root / name);
+}
+}  // namespace graphics::shader
@@ -1,20 +1,181 @@
 #include "shader/program.h"
 
+#include <algorithm>
+#include <string>
+
 #include <glm/gtc/type_ptr.hpp>
 
-namespace graphics::shader {
-GLuint ShaderProgram::currentBinding = 0;
+#include "context_manager.h"
+
+namespace {
+/// @brief Binary search of a table sorted by hash, nullptr if not found.
+template <class T>
+const T* findByHash(const std::vector<T>& table, uint32_t hash) {
+  auto it = std::lower_bound(table.begin(), table.end(), hash, [](const T& entry, uint32_t value) {
+    return entry.hash < value;
+  });
+  return it != table.end() && it->hash == hash ? &*it : nullptr;
+}
 
+/// @brief Sort a table by hash, warning about names that hash alike (the later one is unreachable by name).
+template <class T>
+void sortByHash(std::vector<T>& table, const std::vector<std::string>& names) {
+  std::vector<uint32_t> order(table.size());
+  for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return table[a].hash < table[b].hash; });
+  std::vector<T> sorted;
+  sorted.reserve(table.size());
+  for (uint32_t i : order) {
+    if (!sorted.empty() && sorted.back().hash == table[i].hash) {
+      const std::string message = "Uniform name hash collision, " + names[i] + " is only reachable by location";
+      if (glDebugMessageInsert) {
+        glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                             message.c_str());
+      } else {
+        puts(message.c_str());
+      }
+      continue;
+    }
+    sorted.push_back(table[i]);
+  }
+  table.swap(sorted);
+}
+
+/// Component type and count of a uniform type, count 0 for types copyUniforms skips.
+struct UniformFormat {
+  GLenum component;
+  int count;
+  bool isMatrix;
+};
+
+UniformFormat getUniformFormat(GLenum type) {
+  switch (type) {
+    case GL_FLOAT: return {GL_FLOAT, 1, false};
+    case GL_FLOAT_VEC2: return {GL_FLOAT, 2, false};
+    case GL_FLOAT_VEC3: return {GL_FLOAT, 3, false};
+    case GL_FLOAT_VEC4: return {GL_FLOAT, 4, false};
+    case GL_FLOAT_MAT2: return {GL_FLOAT, 4, true};
+    case GL_FLOAT_MAT3: return {GL_FLOAT, 9, true};
+    case GL_FLOAT_MAT4: return {GL_FLOAT, 16, true};
+    case GL_UNSIGNED_INT: return {GL_UNSIGNED_INT, 1, false};
+    case GL_UNSIGNED_INT_VEC2: return {GL_UNSIGNED_INT, 2, false};
+    case GL_UNSIGNED_INT_VEC3: return {GL_UNSIGNED_INT, 3, false};
+    case GL_UNSIGNED_INT_VEC4: return {GL_UNSIGNED_INT, 4, false};
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2: return {GL_INT, 2, false};
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3: return {GL_INT, 3, false};
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4: return {GL_INT, 4, false};
+    // Samplers and images hold their unit.
+    case GL_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_3D:
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+    case GL_IMAGE_2D:
+    case GL_IMAGE_3D: return {GL_INT, 1, false};
+    default: return {GL_NONE, 0, false};
+  }
+}
+}  // namespace
+
+namespace graphics::shader {
 ShaderProgram::ShaderProgram() noexcept : isLinked(false), handle(glCreateProgram()), uniforms(), uniformBlocks() {}
 
-ShaderProgram::~ShaderProgram() { glDeleteProgram(handle); }
+ShaderProgram::~ShaderProgram() { OpenGLContext::getStateCache().deleteProgram(handle); }
 
 void ShaderProgram::attach(Shader* shader) { glAttachShader(handle, shader->getHandle()); }
 void ShaderProgram::detach(Shader* shader) { glDetachShader(handle, shader->getHandle()); }
 
 void ShaderProgram::link() {
+  beginLink();
+  finishLink();
+}
+
+void ShaderProgram::beginLink(bool retrievable) {
+  if (retrievable) glProgramParameteri(handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(handle);
+  isLinked = false;
+}
+
+void ShaderProgram::finishLink() {
   isLinked = checkLinkState();
+  uniforms.clear();
+  uniformBlocks.clear();
+  if (isLinked) reflect();
+}
+
+bool ShaderProgram::isLinkComplete() const {
+  if (!GLAD_GL_KHR_parallel_shader_compile && !GLAD_GL_ARB_parallel_shader_compile) return true;
+  GLint isComplete = GL_TRUE;
+  glGetProgramiv(handle, GL_COMPLETION_STATUS_KHR, &isComplete);
+  return isComplete == GL_TRUE;
+}
+
+bool ShaderProgram::loadBinary(GLenum format, const void* binary, GLsizei size) {
+  glProgramBinary(handle, format, binary, size);
+  GLint success = GL_FALSE;
+  glGetProgramiv(handle, GL_LINK_STATUS, &success);
+  isLinked = success == GL_TRUE;
+  uniforms.clear();
+  uniformBlocks.clear();
+  if (isLinked) reflect();
+  return isLinked;
+}
+
+std::vector<unsigned char> ShaderProgram::getBinary(GLenum& format) const {
+  GLint length = 0;
+  if (isLinked) glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &length);
+  std::vector<unsigned char> binary(length);
+  if (length > 0) glGetProgramBinary(handle, length, &length, &format, binary.data());
+  binary.resize(length);
+  return binary;
+}
+
+void ShaderProgram::reflect() {
+  GLint uniformCount = 0, blockCount = 0, uniformNameLength = 0, blockNameLength = 0;
+  glGetProgramInterfaceiv(handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniformCount);
+  glGetProgramInterfaceiv(handle, GL_UNIFORM, GL_MAX_NAME_LENGTH, &uniformNameLength);
+  glGetProgramInterfaceiv(handle, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blockCount);
+  glGetProgramInterfaceiv(handle, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &blockNameLength);
+  std::string name(std::max(uniformNameLength, blockNameLength), '\0');
+  std::vector<std::string> names;
+
+  constexpr GLenum uniformProperties[] = {GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE};
+  for (GLint i = 0; i < uniformCount; ++i) {
+    GLint values[4];
+    glGetProgramResourceiv(handle, GL_UNIFORM, i, 4, uniformProperties, 4, nullptr, values);
+    // Block members have no location, they are set through buffers.
+    if (values[0] != -1) continue;
+    GLsizei length = 0;
+    glGetProgramResourceName(handle, GL_UNIFORM, i, static_cast<GLsizei>(name.size()), &length, name.data());
+    std::string_view view(name.data(), length);
+    if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") view.remove_suffix(3);
+    uniforms.push_back(Uniform{hashUniformName(view), values[1], static_cast<GLenum>(values[2]), values[3]});
+    names.emplace_back(view);
+  }
+  sortByHash(uniforms, names);
+
+  names.clear();
+  constexpr GLenum blockProperties[] = {GL_BUFFER_DATA_SIZE};
+  for (GLint i = 0; i < blockCount; ++i) {
+    GLint dataSize = 0;
+    glGetProgramResourceiv(handle, GL_UNIFORM_BLOCK, i, 1, blockProperties, 1, nullptr, &dataSize);
+    GLsizei length = 0;
+    glGetProgramResourceName(handle, GL_UNIFORM_BLOCK, i, static_cast<GLsizei>(name.size()), &length, name.data());
+    std::string_view view(name.data(), length);
+    uniformBlocks.push_back(UniformBlock{hashUniformName(view), static_cast<GLuint>(i), dataSize});
+    names.emplace_back(view);
+  }
+  sortByHash(uniformBlocks, names);
 }
 
 bool ShaderProgram::checkLinkState() const {
@@ -33,36 +194,84 @@ bool ShaderProgram::checkLinkState() const {
   return success;
 }
 
+void ShaderProgram::swap(ShaderProgram& other) noexcept {
+  std::swap(isLinked, other.isLinked);
+  std::swap(handle, other.handle);
+  uniforms.swap(other.uniforms);
+  uniformBlocks.swap(other.uniformBlocks);
+}
+
+void ShaderProgram::copyUniforms(const ShaderProgram& source) {
+  if (!isLinked || !source.isLinked) return;
+  for (const Uniform& uniform : uniforms) {
+    const Uniform* from = findByHash(source.uniforms, uniform.hash);
+    const UniformFormat format = getUniformFormat(uniform.type);
+    if (from == nullptr || from->type != uniform.type || format.count == 0) continue;
+    // Elements of an array have consecutive locations.
+    const GLint elements = std::min(uniform.arraySize, from->arraySize);
+    for (GLint element = 0; element < elements; ++element) {
+      const GLint location = uniform.location + element, fromLocation = from->location + element;
+      union {
+        GLfloat f[16];
+        GLint i[4];
+        GLuint u[4];
+      } value;
+      if (format.component == GL_FLOAT) {
+        glGetUniformfv(source.handle, fromLocation, value.f);
+        switch (format.isMatrix ? format.count : format.count - 1) {
+          case 0: glProgramUniform1fv(handle, location, 1, value.f); break;
+          case 1: glProgramUniform2fv(handle, location, 1, value.f); break;
+          case 2: glProgramUniform3fv(handle, location, 1, value.f); break;
+          case 3: glProgramUniform4fv(handle, location, 1, value.f); break;
+          case 4: glProgramUniformMatrix2fv(handle, location, 1, GL_FALSE, value.f); break;
+          case 9: glProgramUniformMatrix3fv(handle, location, 1, GL_FALSE, value.f); break;
+          default: glProgramUniformMatrix4fv(handle, location, 1, GL_FALSE, value.f); break;
+        }
+      } else if (format.component == GL_INT) {
+        glGetUniformiv(source.handle, fromLocation, value.i);
+        switch (format.count) {
+          case 1: glProgramUniform1iv(handle, location, 1, value.i); break;
+          case 2: glProgramUniform2iv(handle, location, 1, value.i); break;
+          case 3: glProgramUniform3iv(handle, location, 1, value.i); break;
+          default: glProgramUniform4iv(handle, location, 1, value.i); break;
+        }
+      } else {
+        glGetUniformuiv(source.handle, fromLocation, value.u);
+        switch (format.count) {
+          case 1: glProgramUniform1uiv(handle, location, 1, value.u); break;
+          case 2: glProgramUniform2uiv(handle, location, 1, value.u); break;
+          case 3: glProgramUniform3uiv(handle, location, 1, value.u); break;
+          default: glProgramUniform4uiv(handle, location, 1, value.u); break;
+        }
+      }
+    }
+  }
+  for (const UniformBlock& block : uniformBlocks) {
+    const UniformBlock* from = findByHash(source.uniformBlocks, block.hash);
+    if (from == nullptr) continue;
+    GLint binding = 0;
+    glGetActiveUniformBlockiv(source.handle, from->index, GL_UNIFORM_BLOCK_BINDING, &binding);
+    glUniformBlockBinding(handle, block.index, static_cast<GLuint>(binding));
+  }
+}
+
 GLuint ShaderProgram::getHandle() const { return handle; }
 
 void ShaderProgram::use() const {
-  // NOP if binds to the same shader program.
-  if (handle == currentBinding) return;
-  if (isLinked) {
-    glUseProgram(handle);
-    currentBinding = handle;
-  }
+  if (isLinked) OpenGLContext::getStateCache().useProgram(handle);
 }
 
-GLint ShaderProgram::getUniformLocation(const char* name) const {
-  // Cache the location since glGetUniformLocation calls are expensive
-  auto it = uniforms.find(name);
-  if (it != uniforms.end()) return it->second;
-  GLint location = glGetUniformLocation(handle, name);
-  uniforms.insert(std::make_pair(std::string(name), location));
-  return location;
+GLint ShaderProgram::getUniformLocation(UniformName name) const {
+  const Uniform* uniform = findByHash(uniforms, name.hash);
+  return uniform ? uniform->location : -1;
 }
 
-GLuint ShaderProgram::getUniformBlockIndex(const char* name) const {
-  // Cache the location since glGetUniformBlockIndex calls are expensive
-  auto it = uniformBlocks.find(name);
-  if (it != uniformBlocks.end()) return it->second;
-  GLint location = glGetUniformBlockIndex(handle, name);
-  uniformBlocks.insert(std::make_pair(std::string(name), location));
-  return location;
+GLuint ShaderProgram::getUniformBlockIndex(UniformName name) const {
+  const UniformBlock* block = findByHash(uniformBlocks, name.hash);
+  return block ? block->index : GL_INVALID_INDEX;
 }
 
-void ShaderProgram::uniformBlockBinding(const char* name, GLuint uniformBlockBinding) const {
+void ShaderProgram::uniformBlockBinding(UniformName name, GLuint uniformBlockBinding) const {
   GLuint blockindex = getUniformBlockIndex(name);
   if (blockindex != GL_INVALID_INDEX) glUniformBlockBinding(handle, blockindex, uniformBlockBinding);
 }
@@ -70,16 +279,79 @@ void ShaderProgram::uniformBlockBinding(const char* name, GLuint uniformBlockBin
 void ShaderProgram::uniformBlockBinding(GLuint uniformBlockIndex, GLuint uniformBlockBinding) const {
   if (uniformBlockIndex != GL_INVALID_INDEX) glUniformBlockBinding(handle, uniformBlockIndex, uniformBlockBinding);
 }
-void ShaderProgram::setUniform(const char* name, GLint i1) { glUniform1i(getUniformLocation(name), i1); }
+
+bool ShaderProgram::checkUniformBlock(std::string_view name, GLint size, const std140::Member* members,
+                                      std::size_t count) const {
+  const UniformBlock* block = findByHash(uniformBlocks, UniformName::fromString(name).hash);
+  if (block == nullptr) return true;
+  std::string errors;
+  if (block->dataSize > size) {
+    errors += "size " + std::to_string(block->dataSize) + " is larger than " + std::to_string(size) + "; ";
+  }
+  GLint activeCount = 0, nameLength = 0;
+  glGetActiveUniformBlockiv(handle, block->index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &activeCount);
+  glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &nameLength);
+  std::vector<GLint> indices(activeCount);
+  glGetActiveUniformBlockiv(handle, block->index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+  std::string memberName(nameLength, '\0');
+  for (GLint index : indices) {
+    GLuint uniformIndex = index;
+    GLint offset = -1;
+    GLsizei length = 0;
+    glGetActiveUniformsiv(handle, 1, &uniformIndex, GL_UNIFORM_OFFSET, &offset);
+    glGetActiveUniformName(handle, uniformIndex, nameLength, &length, memberName.data());
+    std::string_view view(memberName.data(), length);
+    if (view.size() > 3 && view.substr(view.size() - 3) == "[0]") view.remove_suffix(3);
+    const std140::Member* end = members + count;
+    const std140::Member* member = std::find_if(members, end, [view](const auto& m) { return m.name == view; });
+    if (member == end) {
+      errors.append(view).append(" is not in the C++ struct; ");
+    } else if (static_cast<std::size_t>(offset) != member->offset) {
+      errors.append(view).append(" is at " + std::to_string(offset) + ", not " + std::to_string(member->offset) + "; ");
+    }
+  }
+  if (errors.empty()) return true;
+  errors = "Uniform block " + std::string(name) + " differs from its C++ layout: " + errors;
+  if (glDebugMessageInsert) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                         errors.c_str());
+  } else {
+    puts(errors.c_str());
+  }
+  return false;
+}
+
+void ShaderProgram::setUniforms(std::initializer_list<UniformValue> values) const {
+  for (const UniformValue& uniform : values) {
+    const GLfloat* f = uniform.value.f;
+    switch (uniform.type) {
+      case GL_INT: glProgramUniform1i(handle, uniform.location, uniform.value.i); break;
+      case GL_FLOAT: glProgramUniform1f(handle, uniform.location, f[0]); break;
+      case GL_FLOAT_VEC2: glProgramUniform2fv(handle, uniform.location, 1, f); break;
+      case GL_FLOAT_VEC3: glProgramUniform3fv(handle, uniform.location, 1, f); break;
+      case GL_FLOAT_VEC4: glProgramUniform4fv(handle, uniform.location, 1, f); break;
+      case GL_FLOAT_MAT4: glProgramUniformMatrix4fv(handle, uniform.location, 1, GL_FALSE, f); break;
+      default: break;
+    }
+  }
+}
+
+void ShaderProgram::setUniform(UniformName name, GLint i1) { glUniform1i(getUniformLocation(name), i1); }
 void ShaderProgram::setUniform(GLint location, GLint i1) { glUniform1i(location, i1); }
-void ShaderProgram::setUniform(const char* name, GLfloat f1) { glUniform1f(getUniformLocation(name), f1); }
+void ShaderProgram::setUniform(UniformName name, GLfloat f1) { glUniform1f(getUniformLocation(name), f1); }
 void ShaderProgram::setUniform(GLint location, GLfloat f1) { glUniform1f(location, f1); }
-void ShaderProgram::setUniform(const char* name, GLfloat f1, GLfloat f2) {
+void ShaderProgram::setUniform(UniformName name, GLfloat f1, GLfloat f2) {
   glUniform2f(getUniformLocation(name), f1, f2);
 }
 void ShaderProgram::setUniform(GLint location, GLfloat f1, GLfloat f2) { glUniform2f(location, f1, f2); }
+void ShaderProgram::setUniform(UniformName name, GLfloat f1, GLfloat f2, GLfloat f3) {
+  glUniform3f(getUniformLocation(name), f1, f2, f3);
+}
+void ShaderProgram::setUniform(GLint location, GLfloat f1, GLfloat f2, GLfloat f3) {
+  glUniform3f(location, f1, f2, f3);
+}
 
-void ShaderProgram::setUniformMatrix(const char* name, const GLfloat* mat4) {
+void ShaderProgram::setUniformMatrix(UniformName name, const GLfloat* mat4) {
   glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, mat4);
 }
 void ShaderProgram::setUniformMatrix(GLint location, const GLfloat* mat4) {
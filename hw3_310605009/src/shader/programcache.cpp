@@ -0,0 +1,166 @@
+#include "shader/programcache.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "mapped_file.h"
+#include "shader/preprocessor.h"
+#include "shader/shader.h"
+#include "shape/geometry.h"
+
+namespace {
+using graphics::shape::hashBytes;
+constexpr char programFileMagic[4] = {'P', 'R', 'G', 'M'};
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @brief Hash the length too, so the boundaries between strings are part of the key.
+uint64_t hashString(const std::string& string, uint64_t hash) {
+  const uint64_t size = string.size();
+  return hashBytes(string.data(), string.size(), hashBytes(&size, sizeof(size), hash));
+}
+
+std::string getString(GLenum name) {
+  const GLubyte* string = glGetString(name);
+  return string ? reinterpret_cast<const char*>(string) : "";
+}
+
+bool hasProgramBinaries() {
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return formats > 0;
+}
+
+utils::fs::path getProgramPath(const utils::fs::path& directory, uint64_t key) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016" PRIx64 ".program", key);
+  return directory / name;
+}
+}  // namespace
+
+namespace graphics::shader {
+ShaderSource ShaderSource::fromFile(GLenum type, const utils::fs::path& file) {
+  const Expansion& expansion = Preprocessor::expand(file);
+  return ShaderSource{type, expansion.code, expansion.hash};
+}
+
+utils::fs::path ProgramCache::directory;
+std::vector<ProgramCache::Request> ProgramCache::requests;
+ProgramCache::Statistics ProgramCache::statistics;
+
+void ProgramCache::add(ShaderProgram* program, std::vector<ShaderSource> stages, std::string preamble) {
+  requests.push_back(Request{program, std::move(stages), std::move(preamble)});
+}
+
+uint64_t ProgramCache::makeKey(const Request& request, const std::string& driver) {
+  uint64_t key = hashString(driver, 14695981039346656037ull);
+  key = hashString(request.preamble, key);
+  for (const ShaderSource& stage : request.stages) {
+    key = hashBytes(&stage.type, sizeof(stage.type), key);
+    if (stage.hash != 0) {
+      const uint64_t size = stage.code.size();
+      key = hashBytes(&stage.hash, sizeof(stage.hash), hashBytes(&size, sizeof(size), key));
+    } else {
+      key = hashString(stage.code, key);
+    }
+  }
+  return key;
+}
+
+void ProgramCache::build() {
+  if (requests.empty()) return;
+  std::vector<Request> pending;
+  pending.swap(requests);
+  const bool isCached = !directory.empty() && hasProgramBinaries();
+  const std::string driver = getString(GL_VENDOR) + '\n' + getString(GL_RENDERER) + '\n' + getString(GL_VERSION);
+
+  std::vector<std::size_t> misses;
+  std::vector<uint64_t> keys(pending.size());
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < pending.size(); ++i) {
+    keys[i] = makeKey(pending[i], driver);
+    if (isCached && load(*pending[i].program, keys[i])) {
+      ++statistics.hits;
+    } else {
+      misses.push_back(i);
+    }
+  }
+  statistics.loadMilliseconds += elapsedMilliseconds(start);
+  if (misses.empty()) return;
+
+  start = std::chrono::steady_clock::now();
+  if (GLAD_GL_KHR_parallel_shader_compile) {
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+  } else if (GLAD_GL_ARB_parallel_shader_compile) {
+    glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+  }
+  // Everything is submitted before the first status query, which would wait for its program.
+  std::vector<std::vector<std::unique_ptr<Shader>>> shaders(misses.size());
+  for (std::size_t k = 0; k < misses.size(); ++k) {
+    const Request& request = pending[misses[k]];
+    for (const ShaderSource& stage : request.stages) {
+      shaders[k].push_back(createShader(stage.type));
+      shaders[k].back()->fromString(stage.code, request.preamble);
+      request.program->attach(shaders[k].back().get());
+    }
+    request.program->beginLink(isCached);
+  }
+  for (std::size_t k = 0; k < misses.size(); ++k) {
+    ShaderProgram& program = *pending[misses[k]].program;
+    program.finishLink();
+    for (const auto& shader : shaders[k]) {
+      // Reports the stage at fault when linking failed on a compile error.
+      shader->checkCompileState();
+      program.detach(shader.get());
+    }
+  }
+  statistics.misses += misses.size();
+  statistics.compileMilliseconds += elapsedMilliseconds(start);
+
+  if (!isCached) return;
+  for (std::size_t i : misses) store(*pending[i].program, keys[i]);
+}
+
+bool ProgramCache::load(ShaderProgram& program, uint64_t key) {
+  const utils::fs::path path = getProgramPath(directory, key);
+  std::error_code error;
+  if (!utils::fs::exists(path, error)) return false;
+  try {
+    utils::MappedFile file(path);
+    if (file.size() < sizeof(ProgramFileHeader)) return false;
+    ProgramFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, programFileMagic, sizeof(programFileMagic)) != 0 ||
+        header.version != programFileVersion || header.key != key || sizeof(header) + header.size > file.size())
+      return false;
+    return program.loadBinary(header.format, file.data() + sizeof(header), static_cast<GLsizei>(header.size));
+  } catch (const std::runtime_error&) {
+    // Unreadable entry, compiled and replaced by the caller.
+    return false;
+  }
+}
+
+void ProgramCache::store(const ShaderProgram& program, uint64_t key) {
+  GLenum format = 0;
+  const std::vector<unsigned char> binary = program.getBinary(format);
+  if (binary.empty()) return;
+  ProgramFileHeader header = {};
+  std::memcpy(header.magic, programFileMagic, sizeof(programFileMagic));
+  header.version = programFileVersion;
+  header.key = key;
+  header.format = format;
+  header.size = static_cast<uint32_t>(binary.size());
+  utils::writeCacheFile(getProgramPath(directory, key), [&](std::ostream& output) {
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+  });
+}
+}  // namespace graphics::shader
@@ -0,0 +1,113 @@
+#include "shader/reloader.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <glad/gl.h>
+
+#include "shader/preprocessor.h"
+
+namespace {
+void report(const std::string& message) {
+  if (glDebugMessageInsert) {
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_ERROR, 0, GL_DEBUG_SEVERITY_HIGH, -1,
+                         message.c_str());
+  } else {
+    puts(message.c_str());
+  }
+}
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+namespace graphics::shader {
+void ShaderReloader::add(ShaderProgram* program,
+                         std::vector<std::pair<GLenum, utils::fs::path>> stages,
+                         std::string preamble,
+                         Callback onReload) {
+  Entry entry;
+  entry.program = program;
+  entry.stages = std::move(stages);
+  entry.preamble = std::move(preamble);
+  entry.onReload = std::move(onReload);
+  expand(entry);
+  entries.push_back(std::move(entry));
+}
+
+void ShaderReloader::remove(const ShaderProgram* program) {
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [program](const Entry& entry) { return entry.program == program; }),
+                entries.end());
+}
+
+void ShaderReloader::update() {
+  const std::vector<utils::fs::path> changes = watcher.takeChanges();
+  const auto now = std::chrono::steady_clock::now();
+  for (const utils::fs::path& file : changes) {
+    for (Entry& entry : entries) {
+      if (std::find(entry.dependencies.begin(), entry.dependencies.end(), file) == entry.dependencies.end()) continue;
+      if (!entry.isDirty && !entry.candidate) entry.changeTime = now;
+      entry.isDirty = true;
+    }
+  }
+  for (Entry& entry : entries) {
+    if (entry.candidate) {
+      if (!entry.candidate->isLinkComplete()) continue;
+      finish(entry);
+    }
+    // Changed again while the last rebuild was linking, start over from the new files.
+    if (entry.isDirty) start(entry);
+  }
+}
+
+std::vector<std::string> ShaderReloader::expand(Entry& entry) {
+  std::vector<std::string> codes;
+  entry.dependencies.clear();
+  for (const auto& stage : entry.stages) {
+    const Expansion& expansion = Preprocessor::expand(stage.second);
+    codes.push_back(expansion.code);
+    // Includes may have been added or removed since the last build.
+    for (const utils::fs::path& file : expansion.dependencies) {
+      watcher.watch(file);
+      entry.dependencies.push_back(file);
+    }
+  }
+  return codes;
+}
+
+void ShaderReloader::start(Entry& entry) {
+  entry.isDirty = false;
+  entry.candidate = std::make_unique<ShaderProgram>();
+  const std::vector<std::string> codes = expand(entry);
+  for (std::size_t i = 0; i < entry.stages.size(); ++i) {
+    entry.shaders.push_back(createShader(entry.stages[i].first));
+    entry.shaders.back()->fromString(codes[i], entry.preamble);
+    entry.candidate->attach(entry.shaders.back().get());
+  }
+  entry.candidate->beginLink();
+}
+
+void ShaderReloader::finish(Entry& entry) {
+  ShaderProgram& candidate = *entry.candidate;
+  candidate.finishLink();
+  for (const auto& shader : entry.shaders) {
+    shader->checkCompileState();
+    candidate.detach(shader.get());
+  }
+  if (candidate.getLinkStatus()) {
+    candidate.copyUniforms(*entry.program);
+    // The old program is deleted with the candidate, the state cache forgets it if it was bound.
+    entry.program->swap(candidate);
+    if (entry.onReload) entry.onReload(*entry.program);
+    ++statistics.reloads;
+    statistics.lastMilliseconds = elapsedMilliseconds(entry.changeTime);
+  } else {
+    ++statistics.failures;
+    report("Reloading " + entry.stages.front().second.stem().string() + " failed, keeping the previous program");
+  }
+  entry.candidate.reset();
+  entry.shaders.clear();
+}
+}  // namespace graphics::shader
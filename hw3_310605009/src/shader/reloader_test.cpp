@@ -0,0 +1,96 @@
+// ShaderReloader swaps in a program rebuilt from an edited file and keeps the old one when the edit does not compile.
+// Needs an OpenGL context from a hidden window, without one (e.g. no display) the test is skipped.
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "context_manager.h"
+#include "shader/program.h"
+#include "shader/reloader.h"
+#include "shader/shader.h"
+#include "testing.h"
+
+namespace {
+namespace fs = utils::fs;
+// ctest's SKIP_RETURN_CODE of this test
+constexpr int skipped = 77;
+constexpr std::chrono::milliseconds timeout(5000);
+
+constexpr const char* vertexCode = R"(#version 330 core
+void main() { gl_Position = vec4(0, 0, 0, 1); }
+)";
+
+std::string fragmentCode(const std::string& color) {
+  return "#version 330 core\nout vec4 color;\nvoid main() { color = " + color + "; }\n";
+}
+
+/// @brief Write text to file and move its modification time on, coarse file system clocks would hide the change.
+void write(const fs::path& file, const std::string& text) {
+  std::ofstream(file) << text;
+  std::error_code error;
+  fs::last_write_time(file, fs::last_write_time(file, error) + std::chrono::seconds(2), error);
+}
+
+/// @brief Call update() until the statistics count one more reload or failure, or the timeout passes.
+void updateUntilDone(graphics::shader::ShaderReloader& reloader) {
+  const auto& statistics = reloader.getStatistics();
+  const std::size_t done = statistics.reloads + statistics.failures;
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  while (statistics.reloads + statistics.failures == done && std::chrono::steady_clock::now() < end) {
+    reloader.update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+}  // namespace
+
+int main() {
+  if (glfwInit() == GLFW_FALSE) return skipped;
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  try {
+    OpenGLContext::createContext(43, GLFW_OPENGL_CORE_PROFILE);
+  } catch (const std::runtime_error&) {
+    return skipped;
+  }
+  std::error_code error;
+  const fs::path directory = fs::temp_directory_path(error) / "reloader_test";
+  fs::create_directories(directory);
+  const fs::path vertexFile = directory / "test.vert", fragmentFile = directory / "test.frag";
+  write(vertexFile, vertexCode);
+  write(fragmentFile, fragmentCode("vec4(1)"));
+  {
+    graphics::shader::ShaderProgram program;
+    graphics::shader::VertexShader vertexShader;
+    graphics::shader::FragmentShader fragmentShader;
+    vertexShader.fromFile(vertexFile);
+    fragmentShader.fromFile(fragmentFile);
+    program.attach(&vertexShader, &fragmentShader);
+    program.link();
+    program.detach(&vertexShader, &fragmentShader);
+    EXPECT(program.getLinkStatus());
+
+    graphics::shader::ShaderReloader reloader;
+    int callbacks = 0;
+    reloader.add(&program, {{GL_VERTEX_SHADER, vertexFile}, {GL_FRAGMENT_SHADER, fragmentFile}}, {},
+                 [&callbacks](graphics::shader::ShaderProgram&) { ++callbacks; });
+    const GLuint original = program.getHandle();
+    write(fragmentFile, fragmentCode("vec4(0.5)"));
+    updateUntilDone(reloader);
+    EXPECT(reloader.getStatistics().reloads == 1);
+    EXPECT(callbacks == 1);
+    const GLuint reloaded = program.getHandle();
+    EXPECT(reloaded != original);
+    EXPECT(glIsProgram(reloaded));
+
+    write(fragmentFile, fragmentCode("undefinedColor"));
+    updateUntilDone(reloader);
+    EXPECT(reloader.getStatistics().failures == 1);
+    EXPECT(callbacks == 1);
+    EXPECT(program.getHandle() == reloaded);
+    EXPECT(program.getLinkStatus());
+  }
+  fs::remove_all(directory, error);
+  return utils::testFailures() != 0;
+}
@@ -0,0 +1,64 @@
+#include "shader/variants.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "shader/programcache.h"
+
+namespace graphics::shader {
+ProgramVariants::ProgramVariants(const utils::fs::path& _vertexFile,
+                                 const utils::fs::path& _fragmentFile,
+                                 std::vector<std::string> _features,
+                                 std::string _preamble) :
+    vertexFile(_vertexFile),
+    fragmentFile(_fragmentFile),
+    features(std::move(_features)),
+    preamble(std::move(_preamble)) {
+  if (features.size() > maxFeatures) THROW_EXCEPTION(std::length_error, "Too many shader features");
+}
+
+std::string ProgramVariants::getDefines(Key key) const {
+  std::string defines;
+  for (std::size_t i = 0; i < features.size(); ++i)
+    if (key & (Key{1} << i)) defines += "#define " + features[i] + " 1\n";
+  return defines;
+}
+
+ProgramVariants::Key ProgramVariants::mask(Key key) const {
+  return features.size() < maxFeatures ? key & ((Key{1} << features.size()) - 1) : key;
+}
+
+ShaderProgram& ProgramVariants::get(Key key) {
+  key = mask(key);
+  auto it = variants.find(key);
+  if (it != variants.end()) return *it->second;
+  prepare({key});
+  return *variants[key];
+}
+
+void ProgramVariants::prepare(std::initializer_list<Key> keys) {
+  std::vector<ShaderProgram*> built;
+  for (Key key : keys) {
+    std::unique_ptr<ShaderProgram>& variant = variants[mask(key)];
+    if (variant) continue;
+    variant = std::make_unique<ShaderProgram>();
+    const std::string variantPreamble = getDefines(mask(key)) + preamble;
+    // Expanded on demand (and cached), a variant built after a reload uses the edited files too.
+    ProgramCache::add(variant.get(),
+                      {ShaderSource::fromFile(GL_VERTEX_SHADER, vertexFile),
+                       ShaderSource::fromFile(GL_FRAGMENT_SHADER, fragmentFile)},
+                      variantPreamble);
+    if (reloader)
+      reloader->add(variant.get(), {{GL_VERTEX_SHADER, vertexFile}, {GL_FRAGMENT_SHADER, fragmentFile}},
+                    variantPreamble, initializer);
+    built.push_back(variant.get());
+  }
+  ProgramCache::build();
+  if (initializer)
+    for (ShaderProgram* variant : built) initializer(*variant);
+}
+
+void ProgramVariants::forEach(const std::function<void(Key, ShaderProgram&)>& f) {
+  for (auto& [key, variant] : variants) f(key, *variant);
+}
+}  // namespace graphics::shader
@@ -0,0 +1,68 @@
+#include "shape/bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+/// @brief Call read(vertex) for every vertex, read returns the position as glm::vec3.
+template <class Read>
+graphics::shape::Bounds boundsOf(std::size_t count, Read read) {
+  if (count == 0) return graphics::shape::Bounds();
+  glm::vec3 min(read(0)), max(min);
+  for (std::size_t i = 1; i < count; ++i) {
+    glm::vec3 position = read(i);
+    min = glm::min(min, position);
+    max = glm::max(max, position);
+  }
+  graphics::shape::Bounds bounds = graphics::shape::Bounds::fromBox(min, max);
+  // Second pass, the farthest vertex is usually much closer than the farthest corner.
+  float radius2 = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::vec3 offset = read(i) - bounds.center;
+    radius2 = std::max(radius2, glm::dot(offset, offset));
+  }
+  bounds.radius = std::sqrt(radius2);
+  return bounds;
+}
+}  // namespace
+
+namespace graphics::shape {
+Bounds Bounds::fromBox(const glm::vec3& min, const glm::vec3& max) {
+  Bounds bounds;
+  bounds.min = min;
+  bounds.max = max;
+  bounds.center = 0.5f * (min + max);
+  bounds.radius = glm::length(bounds.getExtent());
+  return bounds;
+}
+
+Bounds Bounds::fromVertices(const void* vertices, std::size_t size, const VertexLayout& layout) {
+  const VertexAttribute* position = nullptr;
+  for (uint32_t i = 0; i < layout.attributeCount; ++i)
+    if (layout.attributes[i].index == 0) position = &layout.attributes[i];
+  if (position == nullptr || position->size < 3 || layout.stride == 0) return unbounded();
+  const unsigned char* base = static_cast<const unsigned char*>(vertices) + position->offset;
+  const std::size_t count = size / layout.stride;
+  const std::size_t stride = layout.stride;
+  // memcpy, vertex data has no alignment guarantee (e.g. a mapped mesh file).
+  switch (position->type) {
+    case GL_FLOAT:
+      return boundsOf(count, [=](std::size_t i) {
+        GLfloat xyz[3];
+        std::memcpy(xyz, base + i * stride, sizeof(xyz));
+        return glm::vec3(xyz[0], xyz[1], xyz[2]);
+      });
+    case GL_UNSIGNED_SHORT: {
+      const float scale = position->normalized ? 1.0f / 65535.0f : 1.0f;
+      return boundsOf(count, [=](std::size_t i) {
+        GLushort xyz[3];
+        std::memcpy(xyz, base + i * stride, sizeof(xyz));
+        return glm::vec3(xyz[0], xyz[1], xyz[2]) * scale;
+      });
+    }
+    default:
+      return unbounded();
+  }
+}
+}  // namespace graphics::shape
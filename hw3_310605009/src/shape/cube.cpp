@@ -1,71 +1,31 @@
 #include "shape/cube.h"
 namespace graphics::shape {
 
-std::weak_ptr<buffer::VertexArray> Cube::vao_weak;
-std::weak_ptr<buffer::ArrayBuffer> Cube::vbo_weak;
-std::weak_ptr<buffer::ElementArrayBuffer> Cube::ebo_weak;
+namespace {
+const VertexLayout cubeLayout = makeFloatLayout({3, 3});
+}  // namespace
 
 Cube::Cube() {
-  if ((ebo = ebo_weak.lock())) {
-    // Already have vertex data.
-    vao = vao_weak.lock();
-    vbo = vbo_weak.lock();
-  } else {
-    // First object.
+  geometry = GeometryRegistry::get(makeGeometryKey(ShapeType::Cube), [] {
     std::vector<GLfloat> vertices;
     std::vector<GLubyte> indices;
     generateVertices(vertices, indices);
-
-    vao_weak = vao = std::make_shared<buffer::VertexArray>();
-    vbo_weak = vbo = std::make_shared<buffer::ArrayBuffer>();
-    ebo_weak = ebo = std::make_shared<buffer::ElementArrayBuffer>();
-
-    vbo->allocate_load(vertices.size() * sizeof(GLfloat), vertices.data());
-    ebo->allocate_load(indices.size() * sizeof(GLubyte), indices.data());
-
-    vao->bind();
-    vbo->bind();
-    ebo->bind();
-
-    vao->enable(0);
-    vao->setAttributePointer(0, 3, 6, 0);
-    vao->enable(1);
-    vao->setAttributePointer(1, 3, 6, 3);
-
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  }
+    return std::make_shared<Geometry>(vertices.data(), vertices.size() * sizeof(GLfloat), indices, cubeLayout);
+  });
+  localBounds = geometry->getBounds();
 }
 
 Cube::Cube(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices) {
-  vao = std::make_shared<buffer::VertexArray>();
-  vbo = std::make_shared<buffer::ArrayBuffer>();
-  ebo = std::make_shared<buffer::ElementArrayBuffer>();
-
-  vbo->allocate_load(vertices.size() * sizeof(GLfloat), vertices.data());
-  ebo->allocate_load(indices.size() * sizeof(GLuint), indices.data());
-
-  vao->bind();
-  vbo->bind();
-  ebo->bind();
-
-  vao->enable(0);
-  vao->setAttributePointer(0, 3, 6, 0);
-  vao->enable(1);
-  vao->setAttributePointer(1, 3, 6, 3);
-
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  const std::size_t size = vertices.size() * sizeof(GLfloat);
+  geometry = GeometryRegistry::get(vertices.data(), size, indices, static_cast<uint64_t>(getType()), [&] {
+    return std::make_shared<Geometry>(vertices.data(), size, indices, cubeLayout);
+  });
+  localBounds = geometry->getBounds();
 }
 
 void Cube::draw() const {
   if (preDrawCallback) preDrawCallback();
-  vao->bind();
-  GLsizei indexCount = static_cast<GLsizei>(ebo->getSize() / sizeof(GLubyte));
-  glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_BYTE, nullptr);
-  glBindVertexArray(0);
+  geometry->draw();
   if (postDrawCallback) postDrawCallback();
 }
 
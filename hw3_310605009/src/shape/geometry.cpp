@@ -0,0 +1,118 @@
+#include "shape/geometry.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "context_manager.h"
+
+namespace graphics::shape {
+std::unordered_map<GeometryKey, GeometryRegistry::Entry> GeometryRegistry::registry;
+std::size_t GeometryRegistry::pruneSize = 16;
+GeometryRegistry::Statistics GeometryRegistry::statistics;
+uint64_t Geometry::lastId = 0;
+
+Geometry::Geometry(const void* vertices,
+                   std::size_t size,
+                   const void* indices,
+                   GLsizei indexCount,
+                   GLenum indexType,
+                   const VertexLayout& _layout,
+                   GLenum _primitive)
+    : layout(_layout), bounds(Bounds::fromVertices(vertices, size, _layout)), primitive(_primitive), id(++lastId) {
+  vbo.allocate_load(size, vertices);
+  ebo.allocate_load(indexType, indexCount, indices);
+  bindAttributes();
+}
+
+void Geometry::bindAttributes() {
+  layout.apply(vao, vbo);
+  vao.setElementBuffer(ebo);
+  buffer::VertexArray::unbind();
+}
+
+void Geometry::draw() {
+  vao.bind();
+  drawBound();
+}
+
+void Geometry::drawBound() {
+  GLenum indexType = ebo.getIndexType();
+  OpenGLContext::getStateCache().setPrimitiveRestart(primitive == GL_TRIANGLE_STRIP,
+                                                     buffer::ElementArrayBuffer::getRestartIndex(indexType));
+  glDrawElements(primitive, ebo.getIndexCount(), indexType, nullptr);
+}
+
+GeometryKey GeometryRegistry::hashContent(const Content& content) {
+  GeometryKey hash = hashBytes(&content.tag, sizeof(content.tag));
+  hash = hashBytes(&content.indexSize, sizeof(content.indexSize), hash);
+  hash = hashBytes(content.vertices, content.vertexBytes, hash);
+  return hashBytes(content.indices, content.indexBytes, hash);
+}
+
+GeometryPTR GeometryRegistry::find(GeometryKey key, const Content* content) {
+  auto it = registry.find(key);
+  if (it == registry.end()) return nullptr;
+  const Entry& entry = it->second;
+  if (content == nullptr) {
+    if (entry.content) return nullptr;
+  } else {
+    // Same hash is not enough, another mesh could collide.
+    if (!entry.content || entry.content->tag != content->tag || entry.content->indexSize != content->indexSize ||
+        entry.content->vertexBytes != content->vertexBytes || entry.content->indexBytes != content->indexBytes ||
+        std::memcmp(entry.bytes.data(), content->vertices, content->vertexBytes) != 0 ||
+        std::memcmp(entry.bytes.data() + content->vertexBytes, content->indices, content->indexBytes) != 0)
+      return nullptr;
+  }
+  return entry.geometry.lock();
+}
+
+void GeometryRegistry::add(GeometryKey key,
+                           const Content* content,
+                           const GeometryPTR& geometry,
+                           std::chrono::steady_clock::time_point start) {
+  auto end = std::chrono::steady_clock::now();
+  ++statistics.uploads;
+  statistics.uploadedBytes += geometry->getSize();
+  statistics.uploadMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+  // Expired entries of other keys are dropped once the table doubled, which keeps inserts amortized O(1).
+  if (registry.size() >= pruneSize) prune();
+  // A colliding entry is replaced, its geometry stays with the shapes holding it.
+  Entry& entry = registry[key];
+  entry.geometry = geometry;
+  entry.content.reset();
+  entry.bytes.clear();
+  if (content != nullptr) {
+    entry.content = *content;
+    entry.content->vertices = entry.content->indices = nullptr;
+    const unsigned char* vertices = static_cast<const unsigned char*>(content->vertices);
+    const unsigned char* indices = static_cast<const unsigned char*>(content->indices);
+    entry.bytes.assign(vertices, vertices + content->vertexBytes);
+    entry.bytes.insert(entry.bytes.end(), indices, indices + content->indexBytes);
+  }
+}
+
+void GeometryRegistry::prune() {
+  for (auto it = registry.begin(); it != registry.end();) {
+    if (it->second.geometry.expired()) {
+      it = registry.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  pruneSize = std::max<std::size_t>(16, registry.size() * 2);
+}
+
+std::size_t GeometryRegistry::getLiveCount() {
+  std::size_t count = 0;
+  for (const auto& entry : registry) count += entry.second.geometry.expired() ? 0 : 1;
+  return count;
+}
+
+std::size_t GeometryRegistry::getLiveSize() {
+  std::size_t size = 0;
+  for (const auto& entry : registry) {
+    if (GeometryPTR geometry = entry.second.geometry.lock()) size += geometry->getSize();
+  }
+  return size;
+}
+}  // namespace graphics::shape
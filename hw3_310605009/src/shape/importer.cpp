@@ -0,0 +1,899 @@
+#include "shape/importer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "mapped_file.h"
+
+namespace {
+// ----------------------------------------------------------------------------------------------------------------
+// Text
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+const char* skipSpaces(const char* p, const char* end) {
+  while (p < end && isSpace(*p)) ++p;
+  return p;
+}
+
+const char* skipLine(const char* p, const char* end) {
+  const void* newline = std::memchr(p, '\n', end - p);
+  return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+// Decimal number without locale or null terminator, exact enough for vertex data.
+bool parseFloat(const char*& p, const char* end, double& value) {
+  static constexpr double powersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+  double mantissa = 0;
+  int exponent = 0;
+  bool hasDigits = false;
+  for (; p < end && isDigit(*p); ++p, hasDigits = true) mantissa = mantissa * 10 + (*p - '0');
+  if (p < end && *p == '.') {
+    for (++p; p < end && isDigit(*p); ++p, hasDigits = true) {
+      mantissa = mantissa * 10 + (*p - '0');
+      --exponent;
+    }
+  }
+  if (!hasDigits) {
+    p = start;
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) negativeExponent = *p++ == '-';
+    int e = 0;
+    for (; p < end && isDigit(*p); ++p) e = std::min(e * 10 + (*p - '0'), 1000);
+    exponent += negativeExponent ? -e : e;
+  }
+  if (exponent >= 0) {
+    mantissa *= exponent <= 22 ? powersOfTen[exponent] : std::pow(10.0, exponent);
+  } else {
+    mantissa /= exponent >= -22 ? powersOfTen[-exponent] : std::pow(10.0, -exponent);
+  }
+  value = negative ? -mantissa : mantissa;
+  return true;
+}
+
+bool parseFloat(const char*& p, const char* end, float& value) {
+  double result;
+  if (!parseFloat(p, end, result)) return false;
+  value = static_cast<float>(result);
+  return true;
+}
+
+bool readFloat(const char*& p, const char* end, float& value) {
+  p = skipSpaces(p, end);
+  return parseFloat(p, end, value);
+}
+
+bool parseInteger(const char*& p, const char* end, long long& value) {
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+  if (p == end || !isDigit(*p)) return false;
+  long long result = 0;
+  for (; p < end && isDigit(*p); ++p) result = std::min(result * 10 + (*p - '0'), 1LL << 40);
+  value = negative ? -result : result;
+  return true;
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+// Shared post-processing
+
+constexpr int stride = graphics::shape::importedVertexStride;
+
+// Smooth normals of the vertices whose normal is all zero, weighted by face area.
+void generateMissingNormals(std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices) {
+  const std::size_t vertexCount = vertices.size() / stride;
+  std::vector<char> missing(vertexCount);
+  bool anyMissing = false;
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    const GLfloat* normal = &vertices[v * stride + 3];
+    missing[v] = normal[0] == 0 && normal[1] == 0 && normal[2] == 0;
+    anyMissing |= missing[v] != 0;
+  }
+  if (!anyMissing) return;
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const GLfloat* a = &vertices[static_cast<std::size_t>(indices[i]) * stride];
+    const GLfloat* b = &vertices[static_cast<std::size_t>(indices[i + 1]) * stride];
+    const GLfloat* c = &vertices[static_cast<std::size_t>(indices[i + 2]) * stride];
+    float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float w[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    float faceNormal[3] = {u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0]};
+    for (int k = 0; k < 3; ++k) {
+      const std::size_t v = indices[i + k];
+      if (!missing[v]) continue;
+      for (int axis = 0; axis < 3; ++axis) vertices[v * stride + 3 + axis] += faceNormal[axis];
+    }
+  }
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    if (!missing[v]) continue;
+    GLfloat* normal = &vertices[v * stride + 3];
+    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length > 0) {
+      for (int axis = 0; axis < 3; ++axis) normal[axis] /= length;
+    }
+  }
+}
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+// OBJ
+
+enum class ObjElement { Position, TextureCoordinate, Normal, Face, Other };
+
+// Identify the line at p and move p past its keyword.
+ObjElement classifyLine(const char*& p, const char* end) {
+  p = skipSpaces(p, end);
+  if (end - p < 2) return ObjElement::Other;
+  if (p[0] == 'v') {
+    if (isSpace(p[1])) {
+      p += 1;
+      return ObjElement::Position;
+    }
+    if (end - p >= 3 && isSpace(p[2])) {
+      if (p[1] == 't') {
+        p += 2;
+        return ObjElement::TextureCoordinate;
+      }
+      if (p[1] == 'n') {
+        p += 2;
+        return ObjElement::Normal;
+      }
+    }
+  } else if (p[0] == 'f' && isSpace(p[1])) {
+    p += 1;
+    return ObjElement::Face;
+  }
+  return ObjElement::Other;
+}
+
+std::size_t countFaceVertices(const char* p, const char* end) {
+  std::size_t count = 0;
+  while (true) {
+    p = skipSpaces(p, end);
+    if (p == end || *p == '\n' || *p == '#') return count;
+    ++count;
+    while (p < end && !isSpace(*p) && *p != '\n') ++p;
+  }
+}
+
+// Position / texture coordinate / normal indices of one face vertex, -1 when absent.
+struct ObjCorner {
+  int32_t position;
+  int32_t textureCoordinate;
+  int32_t normal;
+  bool operator==(const ObjCorner& other) const {
+    return position == other.position && textureCoordinate == other.textureCoordinate && normal == other.normal;
+  }
+};
+
+struct ObjChunk {
+  const char* begin;
+  const char* end;
+  // Elements in this chunk, turned into first global element by a prefix sum
+  std::size_t positions = 0;
+  std::size_t textureCoordinates = 0;
+  std::size_t normals = 0;
+  std::size_t corners = 0;
+  bool failed = false;
+};
+
+// OBJ indices are 1-based, negative ones count back from the last element defined so far.
+int32_t resolveIndex(long long index, std::size_t definedSoFar) {
+  if (index > 0) return static_cast<int32_t>(std::min<long long>(index - 1, std::numeric_limits<int32_t>::max()));
+  if (index < 0 && static_cast<long long>(definedSoFar) + index >= 0) return static_cast<int32_t>(definedSoFar + index);
+  return std::numeric_limits<int32_t>::max();
+}
+
+bool parseCorner(const char*& p, const char* end, const std::size_t defined[3], ObjCorner& corner) {
+  long long index;
+  if (!parseInteger(p, end, index)) return false;
+  corner = {resolveIndex(index, defined[0]), -1, -1};
+  if (p < end && *p == '/') {
+    ++p;
+    if (p < end && *p != '/') {
+      if (!parseInteger(p, end, index)) return false;
+      corner.textureCoordinate = resolveIndex(index, defined[1]);
+    }
+    if (p < end && *p == '/') {
+      ++p;
+      if (!parseInteger(p, end, index)) return false;
+      corner.normal = resolveIndex(index, defined[2]);
+    }
+  }
+  return p == end || isSpace(*p) || *p == '\n';
+}
+
+void countChunk(ObjChunk& chunk) {
+  for (const char* p = chunk.begin; p < chunk.end; p = skipLine(p, chunk.end)) {
+    switch (classifyLine(p, chunk.end)) {
+      case ObjElement::Position: ++chunk.positions; break;
+      case ObjElement::TextureCoordinate: ++chunk.textureCoordinates; break;
+      case ObjElement::Normal: ++chunk.normals; break;
+      case ObjElement::Face: {
+        std::size_t count = countFaceVertices(p, chunk.end);
+        if (count >= 3) chunk.corners += (count - 2) * 3;
+        break;
+      }
+      default: break;
+    }
+  }
+}
+
+// Parse a chunk whose counters hold the global index of its first element.
+void parseChunk(ObjChunk& chunk,
+                GLfloat* positions,
+                GLfloat* textureCoordinates,
+                GLfloat* normals,
+                ObjCorner* corners) {
+  std::size_t defined[3] = {chunk.positions, chunk.textureCoordinates, chunk.normals};
+  ObjCorner* corner = corners + chunk.corners;
+  for (const char* p = chunk.begin; p < chunk.end && !chunk.failed; p = skipLine(p, chunk.end)) {
+    switch (classifyLine(p, chunk.end)) {
+      case ObjElement::Position: {
+        GLfloat* position = positions + defined[0]++ * 3;
+        for (int i = 0; i < 3; ++i) chunk.failed |= !readFloat(p, chunk.end, position[i]);
+        break;
+      }
+      case ObjElement::TextureCoordinate: {
+        GLfloat* textureCoordinate = textureCoordinates + defined[1]++ * 2;
+        chunk.failed |= !readFloat(p, chunk.end, textureCoordinate[0]);
+        // v is optional
+        if (!readFloat(p, chunk.end, textureCoordinate[1])) textureCoordinate[1] = 0;
+        break;
+      }
+      case ObjElement::Normal: {
+        GLfloat* normal = normals + defined[2]++ * 3;
+        for (int i = 0; i < 3; ++i) chunk.failed |= !readFloat(p, chunk.end, normal[i]);
+        break;
+      }
+      case ObjElement::Face: {
+        std::size_t count = countFaceVertices(p, chunk.end);
+        if (count < 3) break;
+        ObjCorner first{}, previous{}, current{};
+        for (std::size_t i = 0; i < count && !chunk.failed; ++i) {
+          p = skipSpaces(p, chunk.end);
+          chunk.failed |= !parseCorner(p, chunk.end, defined, current);
+          if (i == 0) {
+            first = current;
+          } else if (i >= 2) {
+            *corner++ = first;
+            *corner++ = previous;
+            *corner++ = current;
+          }
+          previous = current;
+        }
+        break;
+      }
+      default: break;
+    }
+  }
+}
+
+uint32_t hashCorner(const ObjCorner& corner) {
+  uint32_t hash = static_cast<uint32_t>(corner.position) * 0x9E3779B1u;
+  hash ^= static_cast<uint32_t>(corner.textureCoordinate) * 0x85EBCA77u;
+  hash ^= static_cast<uint32_t>(corner.normal) * 0xC2B2AE3Du;
+  return hash ^ (hash >> 15);
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+// JSON, just enough for glTF
+
+struct Json {
+  enum class Type : uint8_t { Null, Boolean, Number, String, Array, Object };
+  Type type = Type::Null;
+  double number = 0;
+  std::string string;
+  // Array elements, or object values
+  std::vector<Json> values;
+  // Object keys, same order as values
+  std::vector<std::string> keys;
+
+  const Json* find(const char* key) const {
+    if (type != Type::Object) return nullptr;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+      if (keys[i] == key) return &values[i];
+    return nullptr;
+  }
+  const Json& at(const char* key) const {
+    const Json* value = find(key);
+    if (value == nullptr) THROW_EXCEPTION(std::runtime_error, std::string("glTF: missing property ") + key);
+    return *value;
+  }
+  const Json& at(std::size_t index) const {
+    if (type != Type::Array || index >= values.size()) THROW_EXCEPTION(std::runtime_error, "glTF: index out of range");
+    return values[index];
+  }
+  double getNumber(const char* key, double fallback) const {
+    const Json* value = find(key);
+    return value != nullptr && value->type == Type::Number ? value->number : fallback;
+  }
+  std::size_t getIndex(const char* key) const { return at(key).asIndex(); }
+  std::size_t asIndex() const {
+    if (type != Type::Number || number < 0) THROW_EXCEPTION(std::runtime_error, "glTF: invalid index");
+    return static_cast<std::size_t>(number);
+  }
+};
+
+class JsonParser {
+ public:
+  JsonParser(const char* _begin, const char* _end) : p(_begin), end(_end) {}
+  Json parse() {
+    Json root = parseValue(0);
+    skipWhitespace();
+    if (p != end) fail();
+    return root;
+  }
+
+ private:
+  [[noreturn]] static void fail() { THROW_EXCEPTION(std::runtime_error, "glTF: malformed JSON"); }
+  void skipWhitespace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+  }
+  void expect(char c) {
+    skipWhitespace();
+    if (p == end || *p != c) fail();
+    ++p;
+  }
+  static unsigned parseHexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    fail();
+  }
+  bool consume(const char* literal) {
+    std::size_t length = std::strlen(literal);
+    if (static_cast<std::size_t>(end - p) < length || std::memcmp(p, literal, length) != 0) return false;
+    p += length;
+    return true;
+  }
+
+  std::string parseString() {
+    expect('"');
+    std::string result;
+    while (p < end && *p != '"') {
+      char c = *p++;
+      if (c != '\\') {
+        result.push_back(c);
+        continue;
+      }
+      if (p == end) fail();
+      switch (c = *p++) {
+        case 'b': result.push_back('\b'); break;
+        case 'f': result.push_back('\f'); break;
+        case 'n': result.push_back('\n'); break;
+        case 'r': result.push_back('\r'); break;
+        case 't': result.push_back('\t'); break;
+        case 'u': {
+          if (end - p < 4) fail();
+          unsigned code = 0;
+          for (const char* digitEnd = p + 4; p < digitEnd; ++p) code = code << 4 | parseHexDigit(*p);
+          // Only keys and URIs are read, non-ASCII characters are kept as UTF-8 of the BMP.
+          if (code < 0x80) {
+            result.push_back(static_cast<char>(code));
+          } else if (code < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+          } else {
+            result.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+          }
+          break;
+        }
+        default: result.push_back(c); break;
+      }
+    }
+    if (p == end) fail();
+    ++p;
+    return result;
+  }
+
+  Json parseValue(int depth) {
+    constexpr int maxDepth = 64;
+    if (depth > maxDepth) fail();
+    skipWhitespace();
+    if (p == end) fail();
+    Json value;
+    switch (*p) {
+      case '{':
+        ++p;
+        value.type = Json::Type::Object;
+        skipWhitespace();
+        if (p < end && *p == '}') {
+          ++p;
+          break;
+        }
+        while (true) {
+          value.keys.push_back(parseString());
+          expect(':');
+          value.values.push_back(parseValue(depth + 1));
+          skipWhitespace();
+          if (p == end || *p != ',') break;
+          ++p;
+        }
+        expect('}');
+        break;
+      case '[':
+        ++p;
+        value.type = Json::Type::Array;
+        skipWhitespace();
+        if (p < end && *p == ']') {
+          ++p;
+          break;
+        }
+        while (true) {
+          value.values.push_back(parseValue(depth + 1));
+          skipWhitespace();
+          if (p == end || *p != ',') break;
+          ++p;
+        }
+        expect(']');
+        break;
+      case '"':
+        value.type = Json::Type::String;
+        value.string = parseString();
+        break;
+      default:
+        if (consume("true")) {
+          value.type = Json::Type::Boolean;
+          value.number = 1;
+        } else if (consume("false")) {
+          value.type = Json::Type::Boolean;
+        } else if (!consume("null")) {
+          value.type = Json::Type::Number;
+          if (!parseFloat(p, end, value.number)) fail();
+        }
+        break;
+    }
+    return value;
+  }
+
+  const char* p;
+  const char* end;
+};
+
+// ----------------------------------------------------------------------------------------------------------------
+// glTF
+
+constexpr uint32_t glbMagic = 0x46546C67;      // "glTF"
+constexpr uint32_t glbJsonChunk = 0x4E4F534A;  // "JSON"
+constexpr uint32_t glbBinaryChunk = 0x004E4942;  // "BIN\0"
+constexpr int gltfTriangles = 4;
+
+struct GltfBuffer {
+  const unsigned char* data = nullptr;
+  std::size_t size = 0;
+};
+
+// Strided view of an accessor inside a mapped buffer.
+struct GltfAccessor {
+  const unsigned char* data = nullptr;
+  std::size_t count = 0;
+  std::size_t stride = 0;
+  int componentType = 0;
+  int components = 0;
+  bool normalized = false;
+
+  float readFloat(std::size_t index, int component) const {
+    const unsigned char* element = data + index * stride;
+    switch (componentType) {
+      case GL_FLOAT: {
+        float value;
+        std::memcpy(&value, element + component * sizeof(float), sizeof(float));
+        return value;
+      }
+      case GL_UNSIGNED_BYTE: {
+        float value = element[component];
+        return normalized ? value / 255.0f : value;
+      }
+      case GL_UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, element + component * sizeof(value), sizeof(value));
+        return normalized ? value / 65535.0f : value;
+      }
+      case GL_BYTE: {
+        float value = static_cast<int8_t>(element[component]);
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+      }
+      case GL_SHORT: {
+        int16_t value;
+        std::memcpy(&value, element + component * sizeof(value), sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+      }
+      default: return 0;
+    }
+  }
+  GLuint readIndex(std::size_t index) const {
+    const unsigned char* element = data + index * stride;
+    switch (componentType) {
+      case GL_UNSIGNED_BYTE: return element[0];
+      case GL_UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, element, sizeof(value));
+        return value;
+      }
+      default: {
+        uint32_t value;
+        std::memcpy(&value, element, sizeof(value));
+        return value;
+      }
+    }
+  }
+};
+
+int getComponentCount(const std::string& type) {
+  if (type == "SCALAR") return 1;
+  if (type == "VEC2") return 2;
+  if (type == "VEC3") return 3;
+  if (type == "VEC4") return 4;
+  THROW_EXCEPTION(std::runtime_error, "glTF: unsupported accessor type " + type);
+}
+
+std::size_t getComponentSize(int componentType) {
+  switch (componentType) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE: return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT: return 2;
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT: return 4;
+    default: THROW_EXCEPTION(std::runtime_error, "glTF: unsupported component type");
+  }
+}
+
+GltfAccessor getAccessor(const Json& root, const std::vector<GltfBuffer>& buffers, std::size_t index) {
+  const Json& accessor = root.at("accessors").at(index);
+  const Json& view = root.at("bufferViews").at(accessor.getIndex("bufferView"));
+  const GltfBuffer& buffer = buffers.at(view.getIndex("buffer"));
+
+  GltfAccessor result;
+  result.count = static_cast<std::size_t>(accessor.getNumber("count", 0));
+  result.componentType = static_cast<int>(accessor.getNumber("componentType", 0));
+  result.components = getComponentCount(accessor.at("type").string);
+  result.normalized = accessor.getNumber("normalized", 0) != 0;
+  std::size_t elementSize = getComponentSize(result.componentType) * result.components;
+  result.stride = static_cast<std::size_t>(view.getNumber("byteStride", static_cast<double>(elementSize)));
+  std::size_t viewOffset = static_cast<std::size_t>(view.getNumber("byteOffset", 0));
+  std::size_t viewLength = static_cast<std::size_t>(view.getNumber("byteLength", 0));
+  std::size_t offset = static_cast<std::size_t>(accessor.getNumber("byteOffset", 0));
+  if (viewOffset + viewLength > buffer.size ||
+      (result.count > 0 && offset + (result.count - 1) * result.stride + elementSize > viewLength))
+    THROW_EXCEPTION(std::runtime_error, "glTF: accessor out of buffer range");
+  result.data = buffer.data + viewOffset + offset;
+  return result;
+}
+
+/// @brief Read the numbers of array property key into values, which are kept when it is absent.
+void readNumbers(const Json& object, const char* key, float* values, std::size_t count) {
+  const Json* array = object.find(key);
+  if (array == nullptr) return;
+  if (array->type != Json::Type::Array || array->values.size() != count)
+    THROW_EXCEPTION(std::runtime_error, std::string("glTF: invalid node ") + key);
+  for (std::size_t i = 0; i < count; ++i) values[i] = static_cast<float>(array->values[i].number);
+}
+
+/// @return Transform of a node relative to its parent, from its matrix or its translation, rotation and scale.
+glm::mat4 getNodeTransform(const Json& node) {
+  glm::mat4 transform(1);
+  if (node.find("matrix")) {
+    // Column-major like glm
+    float matrix[16];
+    readNumbers(node, "matrix", matrix, 16);
+    for (int i = 0; i < 16; ++i) transform[i / 4][i % 4] = matrix[i];
+    return transform;
+  }
+  float translation[3] = {0, 0, 0}, rotation[4] = {0, 0, 0, 1}, scale[3] = {1, 1, 1};
+  readNumbers(node, "translation", translation, 3);
+  readNumbers(node, "rotation", rotation, 4);
+  readNumbers(node, "scale", scale, 3);
+  transform = glm::translate(transform, glm::vec3(translation[0], translation[1], translation[2]));
+  transform = transform * glm::mat4_cast(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]));
+  return glm::scale(transform, glm::vec3(scale[0], scale[1], scale[2]));
+}
+
+uint32_t readUint32(const unsigned char* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+}  // namespace
+
+namespace graphics::shape {
+ImportStatistics importOBJ(const utils::fs::path& filename,
+                           std::vector<GLfloat>& vertices,
+                           std::vector<GLuint>& indices) {
+  auto start = std::chrono::steady_clock::now();
+  utils::MappedFile file(filename);
+  const char* begin = reinterpret_cast<const char*>(file.data());
+  const char* end = begin + file.size();
+
+  // Split at line boundaries, one chunk per core.
+  constexpr std::size_t minBytesPerChunk = 1 << 20;
+  std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t chunkCount = std::max<std::size_t>(1, std::min(threadCount, file.size() / minBytesPerChunk));
+  std::vector<ObjChunk> chunks(chunkCount);
+  for (std::size_t i = 0; i < chunkCount; ++i) {
+    const char* chunkBegin = i == 0 ? begin : chunks[i - 1].end;
+    const char* chunkEnd = i + 1 == chunkCount ? end : skipLine(begin + file.size() * (i + 1) / chunkCount, end);
+    chunks[i].begin = chunkBegin;
+    chunks[i].end = std::max(chunkBegin, chunkEnd);
+  }
+  const int chunks32 = static_cast<int>(chunkCount);
+
+  // Pass 1: count elements, then turn counts into global offsets.
+  utils::parallelFor(chunks32, 1, [&chunks](int first, int last) {
+    for (int i = first; i < last; ++i) countChunk(chunks[i]);
+  });
+  ObjChunk total;
+  for (ObjChunk& chunk : chunks) {
+    std::swap(total.positions, chunk.positions);
+    total.positions += chunk.positions;
+    std::swap(total.textureCoordinates, chunk.textureCoordinates);
+    total.textureCoordinates += chunk.textureCoordinates;
+    std::swap(total.normals, chunk.normals);
+    total.normals += chunk.normals;
+    std::swap(total.corners, chunk.corners);
+    total.corners += chunk.corners;
+  }
+  if (total.positions > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+    THROW_EXCEPTION(std::runtime_error, "OBJ: too many vertices in " + filename.string());
+
+  // Pass 2: parse every chunk into its slice of the element arrays.
+  std::vector<GLfloat> positions(total.positions * 3);
+  std::vector<GLfloat> textureCoordinates(total.textureCoordinates * 2);
+  std::vector<GLfloat> normals(total.normals * 3);
+  std::vector<ObjCorner> corners(total.corners);
+  utils::parallelFor(chunks32, 1, [&](int first, int last) {
+    for (int i = first; i < last; ++i)
+      parseChunk(chunks[i], positions.data(), textureCoordinates.data(), normals.data(), corners.data());
+  });
+  for (const ObjChunk& chunk : chunks)
+    if (chunk.failed) THROW_EXCEPTION(std::runtime_error, "OBJ: malformed element in " + filename.string());
+
+  // Deduplicate corners with an open-addressing table, at most half full.
+  constexpr GLuint empty = std::numeric_limits<GLuint>::max();
+  std::size_t capacity = 16;
+  while (capacity < total.corners * 2) capacity <<= 1;
+  std::vector<GLuint> table(capacity, empty);
+  std::vector<ObjCorner> unique;
+  indices.resize(total.corners);
+  // Optional elements are -1 when absent.
+  auto outOfRange = [](int32_t index, std::size_t count) {
+    return index >= 0 && static_cast<std::size_t>(index) >= count;
+  };
+  for (std::size_t i = 0; i < total.corners; ++i) {
+    const ObjCorner& corner = corners[i];
+    if (corner.position < 0 || outOfRange(corner.position, total.positions) ||
+        outOfRange(corner.textureCoordinate, total.textureCoordinates) || outOfRange(corner.normal, total.normals))
+      THROW_EXCEPTION(std::runtime_error, "OBJ: face index out of range in " + filename.string());
+    std::size_t slot = hashCorner(corner) & (capacity - 1);
+    while (table[slot] != empty && !(unique[table[slot]] == corner)) slot = (slot + 1) & (capacity - 1);
+    if (table[slot] == empty) {
+      table[slot] = static_cast<GLuint>(unique.size());
+      unique.push_back(corner);
+    }
+    indices[i] = table[slot];
+  }
+
+  vertices.resize(unique.size() * stride);
+  utils::parallelFor(static_cast<int>(unique.size()), 1 << 14, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      const ObjCorner& corner = unique[i];
+      GLfloat* vertex = &vertices[static_cast<std::size_t>(i) * stride];
+      std::copy_n(&positions[static_cast<std::size_t>(corner.position) * 3], 3, vertex);
+      if (corner.normal >= 0) {
+        std::copy_n(&normals[static_cast<std::size_t>(corner.normal) * 3], 3, vertex + 3);
+      } else {
+        std::fill_n(vertex + 3, 3, 0.0f);
+      }
+      if (corner.textureCoordinate >= 0) {
+        std::copy_n(&textureCoordinates[static_cast<std::size_t>(corner.textureCoordinate) * 2], 2, vertex + 6);
+      } else {
+        std::fill_n(vertex + 6, 2, 0.0f);
+      }
+    }
+  });
+  generateMissingNormals(vertices, indices);
+
+  ImportStatistics statistics;
+  statistics.bytes = file.size();
+  statistics.vertices = unique.size();
+  statistics.triangles = indices.size() / 3;
+  statistics.milliseconds = elapsedMilliseconds(start);
+  return statistics;
+}
+
+ImportStatistics importGLTF(const utils::fs::path& filename,
+                            std::vector<GLfloat>& vertices,
+                            std::vector<GLuint>& indices) {
+  auto start = std::chrono::steady_clock::now();
+  ImportStatistics statistics;
+  utils::MappedFile file(filename);
+  statistics.bytes = file.size();
+
+  const char* json = reinterpret_cast<const char*>(file.data());
+  const char* jsonEnd = json + file.size();
+  GltfBuffer binaryChunk;
+  if (file.size() >= 20 && readUint32(file.data()) == glbMagic) {
+    // Binary container: 12-byte header, JSON chunk, optional BIN chunk.
+    if (readUint32(file.data() + 4) != 2) THROW_EXCEPTION(std::runtime_error, "glTF: unsupported GLB version");
+    std::size_t length = std::min<std::size_t>(readUint32(file.data() + 8), file.size());
+    std::size_t jsonLength = readUint32(file.data() + 12);
+    if (readUint32(file.data() + 16) != glbJsonChunk || 20 + jsonLength > length)
+      THROW_EXCEPTION(std::runtime_error, "glTF: malformed GLB header");
+    json = reinterpret_cast<const char*>(file.data() + 20);
+    jsonEnd = json + jsonLength;
+    std::size_t binaryOffset = 20 + jsonLength;
+    if (binaryOffset + 8 <= length && readUint32(file.data() + binaryOffset + 4) == glbBinaryChunk) {
+      binaryChunk.data = file.data() + binaryOffset + 8;
+      binaryChunk.size = std::min<std::size_t>(readUint32(file.data() + binaryOffset), length - binaryOffset - 8);
+    }
+  }
+  Json root = JsonParser(json, jsonEnd).parse();
+
+  // Map every external buffer, GLB buffers without URI live in the BIN chunk.
+  std::vector<utils::MappedFile> bufferFiles;
+  std::vector<GltfBuffer> buffers;
+  if (const Json* bufferList = root.find("buffers")) {
+    for (const Json& buffer : bufferList->values) {
+      const Json* uri = buffer.find("uri");
+      if (uri == nullptr) {
+        buffers.push_back(binaryChunk);
+        continue;
+      }
+      if (uri->string.compare(0, 5, "data:") == 0)
+        THROW_EXCEPTION(std::runtime_error, "glTF: embedded buffers are not supported");
+      bufferFiles.emplace_back(filename.parent_path() / utils::fs::u8path(uri->string));
+      buffers.push_back({bufferFiles.back().data(), bufferFiles.back().size()});
+      statistics.bytes += bufferFiles.back().size();
+    }
+  }
+
+  vertices.clear();
+  indices.clear();
+  // Append the triangle primitives of mesh with transform applied.
+  auto appendMesh = [&](const Json& mesh, const glm::mat4& transform) {
+    const glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3(transform));
+    // Mirroring transforms turn the triangles inside out.
+    const bool isMirrored = glm::dot(glm::cross(normalMatrix[0], normalMatrix[1]), normalMatrix[2]) < 0;
+    for (const Json& primitive : mesh.at("primitives").values) {
+      if (primitive.getNumber("mode", gltfTriangles) != gltfTriangles) continue;
+      const Json& attributes = primitive.at("attributes");
+      GltfAccessor position = getAccessor(root, buffers, attributes.getIndex("POSITION"));
+      GltfAccessor normal, textureCoordinate;
+      if (attributes.find("NORMAL")) normal = getAccessor(root, buffers, attributes.getIndex("NORMAL"));
+      if (attributes.find("TEXCOORD_0"))
+        textureCoordinate = getAccessor(root, buffers, attributes.getIndex("TEXCOORD_0"));
+      if (position.components != 3 || (normal.data && (normal.components != 3 || normal.count < position.count)) ||
+          (textureCoordinate.data && (textureCoordinate.components != 2 || textureCoordinate.count < position.count)))
+        THROW_EXCEPTION(std::runtime_error, "glTF: unsupported vertex attributes in " + filename.string());
+
+      const std::size_t baseVertex = vertices.size() / stride;
+      vertices.resize(vertices.size() + position.count * stride);
+      GLfloat* output = vertices.data() + baseVertex * stride;
+      // glTF flips the texture v axis relative to OpenGL.
+      utils::parallelFor(static_cast<int>(position.count), 1 << 14, [&](int first, int last) {
+        for (int i = first; i < last; ++i) {
+          GLfloat* vertex = output + static_cast<std::size_t>(i) * stride;
+          const glm::vec4 point = transform * glm::vec4(position.readFloat(i, 0), position.readFloat(i, 1),
+                                                        position.readFloat(i, 2), 1.0f);
+          glm::vec3 direction(0);
+          if (normal.data) {
+            direction = glm::vec3(normal.readFloat(i, 0), normal.readFloat(i, 1), normal.readFloat(i, 2));
+            direction = normalMatrix * direction;
+            if (direction != glm::vec3(0)) direction = glm::normalize(direction);
+          }
+          for (int k = 0; k < 3; ++k) vertex[k] = point[k];
+          for (int k = 0; k < 3; ++k) vertex[3 + k] = direction[k];
+          vertex[6] = textureCoordinate.data ? textureCoordinate.readFloat(i, 0) : 0.0f;
+          vertex[7] = textureCoordinate.data ? 1.0f - textureCoordinate.readFloat(i, 1) : 0.0f;
+        }
+      });
+
+      const std::size_t baseIndex = indices.size();
+      if (primitive.find("indices")) {
+        GltfAccessor index = getAccessor(root, buffers, primitive.getIndex("indices"));
+        const bool isIndexType = index.componentType == GL_UNSIGNED_BYTE ||
+                                 index.componentType == GL_UNSIGNED_SHORT || index.componentType == GL_UNSIGNED_INT;
+        if (index.components != 1 || !isIndexType)
+          THROW_EXCEPTION(std::runtime_error, "glTF: unsupported index type in " + filename.string());
+        indices.resize(baseIndex + index.count / 3 * 3);
+        for (std::size_t i = baseIndex; i < indices.size(); ++i) {
+          GLuint value = index.readIndex(i - baseIndex);
+          if (value >= position.count) THROW_EXCEPTION(std::runtime_error, "glTF: index out of range");
+          indices[i] = static_cast<GLuint>(baseVertex + value);
+        }
+      } else {
+        indices.resize(baseIndex + position.count / 3 * 3);
+        for (std::size_t i = baseIndex; i < indices.size(); ++i)
+          indices[i] = static_cast<GLuint>(baseVertex + i - baseIndex);
+      }
+      if (isMirrored)
+        for (std::size_t i = baseIndex; i < indices.size(); i += 3) std::swap(indices[i + 1], indices[i + 2]);
+    }
+  };
+
+  const Json* nodes = root.find("nodes");
+  if (nodes == nullptr || nodes->values.empty()) {
+    // Without nodes the meshes stay in their local space.
+    if (const Json* meshes = root.find("meshes"))
+      for (const Json& mesh : meshes->values) appendMesh(mesh, glm::mat4(1));
+  } else {
+    // Roots of the default scene, or every node that is no other node's child when there are no scenes
+    std::vector<std::size_t> roots;
+    const Json* scenes = root.find("scenes");
+    if (scenes != nullptr && !scenes->values.empty()) {
+      const Json& scene = scenes->at(root.find("scene") ? root.getIndex("scene") : 0);
+      if (const Json* sceneNodes = scene.find("nodes"))
+        for (const Json& node : sceneNodes->values) roots.push_back(node.asIndex());
+    } else {
+      std::vector<char> isChild(nodes->values.size());
+      for (const Json& node : nodes->values) {
+        if (const Json* children = node.find("children"))
+          for (const Json& child : children->values) isChild.at(child.asIndex()) = 1;
+      }
+      for (std::size_t i = 0; i < isChild.size(); ++i)
+        if (!isChild[i]) roots.push_back(i);
+    }
+    struct PendingNode {
+      std::size_t index;
+      glm::mat4 parentTransform;
+      std::size_t depth;
+    };
+    std::vector<PendingNode> pending;
+    for (std::size_t index : roots) pending.push_back({index, glm::mat4(1), 0});
+    while (!pending.empty()) {
+      const PendingNode current = pending.back();
+      pending.pop_back();
+      // A hierarchy deeper than the node count has a cycle.
+      if (current.depth >= nodes->values.size()) THROW_EXCEPTION(std::runtime_error, "glTF: cyclic node hierarchy");
+      const Json& node = nodes->at(current.index);
+      const glm::mat4 transform = current.parentTransform * getNodeTransform(node);
+      if (node.find("mesh")) appendMesh(root.at("meshes").at(node.getIndex("mesh")), transform);
+      if (const Json* children = node.find("children"))
+        for (const Json& child : children->values) pending.push_back({child.asIndex(), transform, current.depth + 1});
+    }
+  }
+  generateMissingNormals(vertices, indices);
+
+  statistics.vertices = vertices.size() / stride;
+  statistics.triangles = indices.size() / 3;
+  statistics.milliseconds = elapsedMilliseconds(start);
+  return statistics;
+}
+
+ImportStatistics importMesh(const utils::fs::path& filename,
+                            std::vector<GLfloat>& vertices,
+                            std::vector<GLuint>& indices) {
+  std::string extension = filename.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  if (extension == ".obj") return importOBJ(filename, vertices, indices);
+  if (extension == ".gltf" || extension == ".glb") return importGLTF(filename, vertices, indices);
+  THROW_EXCEPTION(std::runtime_error, "Unsupported mesh file: " + filename.string());
+}
+}  // namespace graphics::shape
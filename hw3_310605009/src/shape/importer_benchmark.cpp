@@ -0,0 +1,100 @@
+// Import throughput of OBJ and glTF in MB/s and triangles/s, on a synthetic grid of 1024 x 1024 quads (or the
+// first argument) written to a temporary directory. Further arguments are imported as well, e.g. real assets.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "shape/importer.h"
+
+namespace {
+void writeOBJ(const utils::fs::path& path, int size) {
+  std::ofstream output(path);
+  for (int i = 0; i <= size; ++i)
+    for (int j = 0; j <= size; ++j) output << "v " << j << " 0 " << i << "\nvt " << j << ' ' << i << '\n';
+  output << "vn 0 1 0\n";
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) {
+      const int corner = i * (size + 1) + j + 1;
+      output << "f " << corner << '/' << corner << "/1 " << corner + size + 1 << '/' << corner + size + 1 << "/1 "
+             << corner + size + 2 << '/' << corner + size + 2 << "/1 " << corner + 1 << '/' << corner + 1 << "/1\n";
+    }
+  }
+}
+
+/// @brief The same grid as a .gltf with positions, normals, texture coordinates and 32-bit indices in one buffer.
+void writeGLTF(const utils::fs::path& path, int size) {
+  std::vector<float> positions, normals, coordinates;
+  std::vector<uint32_t> indices;
+  for (int i = 0; i <= size; ++i) {
+    for (int j = 0; j <= size; ++j) {
+      positions.insert(positions.end(), {static_cast<float>(j), 0.0f, static_cast<float>(i)});
+      normals.insert(normals.end(), {0.0f, 1.0f, 0.0f});
+      coordinates.insert(coordinates.end(), {static_cast<float>(j), static_cast<float>(i)});
+    }
+  }
+  for (uint32_t i = 0; i < static_cast<uint32_t>(size); ++i) {
+    for (uint32_t j = 0; j < static_cast<uint32_t>(size); ++j) {
+      const uint32_t corner = i * (size + 1) + j, below = corner + size + 1;
+      indices.insert(indices.end(), {corner, below, below + 1, corner, below + 1, corner + 1});
+    }
+  }
+  const std::size_t vertexCount = positions.size() / 3;
+  const std::size_t views[] = {positions.size() * 4, normals.size() * 4, coordinates.size() * 4, indices.size() * 4};
+  utils::fs::path bin = path;
+  bin.replace_extension(".bin");
+  {
+    std::ofstream output(bin, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(positions.data()), views[0]);
+    output.write(reinterpret_cast<const char*>(normals.data()), views[1]);
+    output.write(reinterpret_cast<const char*>(coordinates.data()), views[2]);
+    output.write(reinterpret_cast<const char*>(indices.data()), views[3]);
+  }
+  std::ofstream output(path);
+  output << "{\"asset\": {\"version\": \"2.0\"}, \"buffers\": [{\"uri\": \"" << bin.filename().string()
+         << "\", \"byteLength\": " << views[0] + views[1] + views[2] + views[3] << "}], \"bufferViews\": [";
+  for (std::size_t i = 0, offset = 0; i < 4; offset += views[i++]) {
+    output << (i ? ", " : "") << "{\"buffer\": 0, \"byteOffset\": " << offset << ", \"byteLength\": " << views[i]
+           << "}";
+  }
+  output << "], \"accessors\": [";
+  const char* types[] = {"VEC3", "VEC3", "VEC2", "SCALAR"};
+  for (int i = 0; i < 4; ++i) {
+    output << (i ? ", " : "") << "{\"bufferView\": " << i << ", \"componentType\": " << (i == 3 ? 5125 : 5126)
+           << ", \"count\": " << (i == 3 ? indices.size() : vertexCount) << ", \"type\": \"" << types[i] << "\"}";
+  }
+  output << "], \"meshes\": [{\"primitives\": [{\"attributes\": {\"POSITION\": 0, \"NORMAL\": 1, \"TEXCOORD_0\": 2}, "
+            "\"indices\": 3, \"mode\": 4}]}]}\n";
+}
+
+void run(const utils::fs::path& path) {
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  graphics::shape::ImportStatistics statistics;
+  // The first import reads the file into the page cache.
+  for (int i = 0; i < 2; ++i) statistics = graphics::shape::importMesh(path, vertices, indices);
+  const double seconds = statistics.milliseconds / 1000;
+  std::printf("%-24s %10zu %10zu %10.1f %10.1f %12.2f\n", path.filename().string().c_str(), statistics.vertices,
+              statistics.triangles, statistics.milliseconds, statistics.bytes / 1048576.0 / seconds,
+              statistics.triangles / 1e6 / seconds);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int size = argc > 1 ? std::atoi(argv[1]) : 1024;
+  const utils::fs::path directory = utils::fs::temp_directory_path() / "importer_benchmark";
+  utils::fs::create_directories(directory);
+  writeOBJ(directory / "grid.obj", size);
+  writeGLTF(directory / "grid.gltf", size);
+  std::printf("%-24s %10s %10s %10s %10s %12s\n", "file", "vertices", "triangles", "ms", "MB/s", "Mtriangles/s");
+  try {
+    run(directory / "grid.obj");
+    run(directory / "grid.gltf");
+    for (int i = 2; i < argc; ++i) run(argv[i]);
+  } catch (const std::runtime_error& error) {
+    std::puts(error.what());
+  }
+  utils::fs::remove_all(directory);
+}
@@ -0,0 +1,188 @@
+#include "shape/meshfile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+
+#include "buffer/buffer.h"
+
+namespace {
+constexpr char meshFileMagic[4] = {'M', 'E', 'S', 'H'};
+
+constexpr std::size_t alignUp(std::size_t offset) {
+  return (offset + graphics::shape::meshFileAlignment - 1) / graphics::shape::meshFileAlignment *
+         graphics::shape::meshFileAlignment;
+}
+
+/// @return Whether primitive is a mode glDrawElements accepts.
+bool isPrimitive(uint32_t primitive) {
+  switch (primitive) {
+    case GL_POINTS:
+    case GL_LINES:
+    case GL_LINE_LOOP:
+    case GL_LINE_STRIP:
+    case GL_TRIANGLES:
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN: return true;
+    default: return false;
+  }
+}
+
+/// @brief end = offset + count * size. @return Whether it fits in 64 bits.
+bool getBlobEnd(uint64_t offset, uint64_t count, uint64_t size, uint64_t& end) {
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  if (size != 0 && count > max / size) return false;
+  if (count * size > max - offset) return false;
+  end = offset + count * size;
+  return true;
+}
+
+void writePadding(std::ostream& output, std::size_t offset) {
+  static const char zeros[graphics::shape::meshFileAlignment] = {};
+  std::size_t current = static_cast<std::size_t>(output.tellp());
+  output.write(zeros, offset - current);
+}
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace
+
+namespace graphics::shape {
+utils::fs::path MeshCache::directory;
+MeshCache::Statistics MeshCache::statistics;
+
+MeshFile::MeshFile(const utils::fs::path& path) : file(path) {
+  if (file.size() < sizeof(MeshFileHeader)) THROW_EXCEPTION(std::runtime_error, "Truncated mesh file");
+  const MeshFileHeader& header = getHeader();
+  if (std::memcmp(header.magic, meshFileMagic, sizeof(meshFileMagic)) != 0)
+    THROW_EXCEPTION(std::runtime_error, "Not a mesh file: " + path.string());
+  if (header.version != meshFileVersion)
+    THROW_EXCEPTION(std::runtime_error, "Unsupported mesh file version: " + path.string());
+  const bool isIndexType = header.indexType == GL_UNSIGNED_BYTE || header.indexType == GL_UNSIGNED_SHORT ||
+                           header.indexType == GL_UNSIGNED_INT;
+  if (header.layout.attributeCount > VertexLayout::maxAttributes || header.vertexOffset % meshFileAlignment != 0 ||
+      header.indexOffset % meshFileAlignment != 0 || !isIndexType || !isPrimitive(header.primitive))
+    THROW_EXCEPTION(std::runtime_error, "Corrupted mesh file: " + path.string());
+  uint64_t vertexEnd, indexEnd;
+  const uint64_t indexSize = buffer::ElementArrayBuffer::getIndexSize(header.indexType);
+  if (!getBlobEnd(header.vertexOffset, header.vertexCount, header.layout.stride, vertexEnd) ||
+      !getBlobEnd(header.indexOffset, header.indexCount, indexSize, indexEnd) || vertexEnd > file.size() ||
+      indexEnd > file.size())
+    THROW_EXCEPTION(std::runtime_error, "Truncated mesh file: " + path.string());
+}
+
+bool MeshFile::write(const utils::fs::path& path,
+                     GeometryKey key,
+                     uint32_t revision,
+                     const VertexLayout& layout,
+                     const void* vertices,
+                     std::size_t vertexCount,
+                     const std::vector<GLuint>& indices,
+                     GLenum primitive) {
+  GLuint maxIndex = 0;
+  for (GLuint index : indices)
+    if (index != buffer::ElementArrayBuffer::restartIndex) maxIndex = std::max(maxIndex, index);
+
+  MeshFileHeader header = {};
+  std::memcpy(header.magic, meshFileMagic, sizeof(meshFileMagic));
+  header.version = meshFileVersion;
+  header.revision = revision;
+  header.key = key;
+  header.layout = layout;
+  header.primitive = primitive;
+  header.indexType = buffer::ElementArrayBuffer::getIndexType(maxIndex);
+  header.vertexCount = vertexCount;
+  header.indexCount = indices.size();
+  header.vertexOffset = alignUp(sizeof(MeshFileHeader));
+  header.indexOffset = alignUp(header.vertexOffset + vertexCount * layout.stride);
+  const VertexAttribute& position = layout.attributes[0];
+  if (layout.attributeCount > 0 && position.type == GL_FLOAT && position.size == 3 && vertexCount > 0) {
+    const unsigned char* vertex = static_cast<const unsigned char*>(vertices) + position.offset;
+    std::fill_n(header.boundsMin, 3, std::numeric_limits<float>::max());
+    std::fill_n(header.boundsMax, 3, std::numeric_limits<float>::lowest());
+    for (std::size_t i = 0; i < vertexCount; ++i, vertex += layout.stride) {
+      float value[3];
+      std::memcpy(value, vertex, sizeof(value));
+      for (int axis = 0; axis < 3; ++axis) {
+        header.boundsMin[axis] = std::min(header.boundsMin[axis], value[axis]);
+        header.boundsMax[axis] = std::max(header.boundsMax[axis], value[axis]);
+      }
+    }
+  }
+
+  return utils::writeCacheFile(path, [&](std::ostream& output) {
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(output, header.vertexOffset);
+    output.write(static_cast<const char*>(vertices), vertexCount * layout.stride);
+    writePadding(output, header.indexOffset);
+    switch (header.indexType) {
+      case GL_UNSIGNED_BYTE: {
+        std::vector<GLubyte> narrowed = buffer::ElementArrayBuffer::narrowIndices<GLubyte>(indices);
+        output.write(reinterpret_cast<const char*>(narrowed.data()), narrowed.size());
+        break;
+      }
+      case GL_UNSIGNED_SHORT: {
+        std::vector<GLushort> narrowed = buffer::ElementArrayBuffer::narrowIndices<GLushort>(indices);
+        output.write(reinterpret_cast<const char*>(narrowed.data()), narrowed.size() * sizeof(GLushort));
+        break;
+      }
+      default: output.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(GLuint)); break;
+    }
+  });
+}
+
+GeometryPTR MeshFile::upload() const {
+  const MeshFileHeader& header = getHeader();
+  VertexLayout layout = header.layout;
+  return std::make_shared<Geometry>(getVertices(), header.vertexCount * layout.stride, getIndices(),
+                                    static_cast<GLsizei>(header.indexCount), header.indexType, layout,
+                                    header.primitive);
+}
+
+GeometryPTR MeshCache::load(GeometryKey key, const VertexLayout& layout, const Generator& generate, GLenum primitive) {
+  utils::fs::path path;
+  if (!directory.empty()) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 ".mesh", key);
+    path = directory / name;
+    std::error_code error;
+    if (utils::fs::exists(path, error)) {
+      auto start = std::chrono::steady_clock::now();
+      try {
+        MeshFile file(path);
+        const MeshFileHeader& header = file.getHeader();
+        if (header.key == key && header.revision == meshGeneratorRevision && header.layout == layout &&
+            header.primitive == primitive) {
+          GeometryPTR geometry = file.upload();
+          ++statistics.hits;
+          statistics.loadMilliseconds += elapsedMilliseconds(start);
+          return geometry;
+        }
+      } catch (const std::runtime_error&) {
+        // Stale or broken entry, replaced below.
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  generate(vertices, indices);
+  std::size_t size = vertices.size() * sizeof(GLfloat);
+  GeometryPTR geometry = std::make_shared<Geometry>(vertices.data(), size, indices, layout, primitive);
+  ++statistics.misses;
+  statistics.generateMilliseconds += elapsedMilliseconds(start);
+
+  if (!path.empty()) {
+    MeshFile::write(path, key, meshGeneratorRevision, layout, vertices.data(), size / layout.stride, indices,
+                    primitive);
+  }
+  return geometry;
+}
+}  // namespace graphics::shape
@@ -0,0 +1,62 @@
+// Cold versus warm start of the generated meshes: generate and optimize (a cache miss) against mapping the mesh
+// file and reading its blobs (a hit). The upload that follows is the same glBufferData either way, so it is left
+// out and the benchmark needs no GL context. Files are written to a temporary directory, removed at the end.
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "benchmark.h"
+#include "shape/meshfile.h"
+#include "shape/optimizer.h"
+#include "shape/plane.h"
+#include "shape/sphere.h"
+
+namespace {
+using namespace graphics::shape;
+
+/// @return Sum of the blob bytes, touching every page of the mapping like an upload would.
+unsigned sumBlobs(const MeshFile& file) {
+  const MeshFileHeader& header = file.getHeader();
+  const auto* vertices = static_cast<const unsigned char*>(file.getVertices());
+  const auto* indices = static_cast<const unsigned char*>(file.getIndices());
+  const std::size_t indexSize = graphics::buffer::ElementArrayBuffer::getIndexSize(header.indexType);
+  unsigned sum = std::accumulate(vertices, vertices + header.vertexCount * header.layout.stride, 0u);
+  return std::accumulate(indices, indices + header.indexCount * indexSize, sum);
+}
+
+void run(const char* name, const utils::fs::path& path, int stride, const MeshCache::Generator& generate) {
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  const double generateMilliseconds = utils::measureMilliseconds(3, [&] { generate(vertices, indices); });
+  const VertexLayout layout =
+      stride == Sphere::vertexStride ? makeFloatLayout({3, 3, 2}) : makeFloatLayout({3, 3, 2, 3, 3});
+  const double writeMilliseconds = utils::measureMilliseconds(1, [&] {
+    MeshFile::write(path, 0, meshGeneratorRevision, layout, vertices.data(), vertices.size() / stride, indices);
+  });
+  unsigned sum = 0;
+  const double loadMilliseconds = utils::measureMilliseconds(5, [&] { sum += sumBlobs(MeshFile(path)); });
+  std::printf("%-16s %12zu %12.2f %12.2f %12.3f %9.0fx\n", name, vertices.size() / stride, generateMilliseconds,
+              writeMilliseconds, loadMilliseconds, generateMilliseconds / loadMilliseconds);
+  // Keeps the sum, and with it the reads, from being optimized away.
+  if (sum == 1) std::puts("");
+}
+}  // namespace
+
+int main() {
+  const utils::fs::path directory = utils::fs::temp_directory_path() / "meshfile_benchmark";
+  utils::fs::create_directories(directory);
+  std::printf("%-16s %12s %12s %12s %12s %10s\n", "mesh", "vertices", "generate ms", "write ms", "load ms", "speedup");
+  run("sphere 180x360", directory / "sphere.mesh", Sphere::vertexStride, [](auto& vertices, auto& indices) {
+    Sphere::generateVertices(vertices, indices, 180, 360);
+    optimizeMesh(vertices, indices, Sphere::vertexStride);
+  });
+  for (int subdivision : {256, 1024}) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "plane %d", subdivision);
+    run(name, directory / "plane.mesh", Plane::vertexStride, [subdivision](auto& vertices, auto& indices) {
+      Plane::generateVertices(vertices, indices, subdivision);
+      optimizeMesh(vertices, indices, Plane::vertexStride);
+    });
+  }
+  utils::fs::remove_all(directory);
+}
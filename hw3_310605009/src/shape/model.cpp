@@ -0,0 +1,27 @@
+#include "shape/model.h"
+
+#include <string>
+
+#include "shape/meshfile.h"
+
+namespace graphics::shape {
+Model::Model(const utils::fs::path& filename) {
+  utils::fs::path path = utils::fs::absolute(filename);
+  std::string name = path.string();
+  GeometryKey key = makeGeometryKey(ShapeType::Model, hashBytes(name.data(), name.size()), utils::fs::file_size(path),
+                                    utils::fs::last_write_time(path).time_since_epoch().count());
+  geometry = GeometryRegistry::get(key, [&] {
+    static const VertexLayout layout = makeFloatLayout({3, 3, 2});
+    return MeshCache::load(key, layout, [&](std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) {
+      statistics = importMesh(path, vertices, indices);
+    });
+  });
+  localBounds = geometry->getBounds();
+}
+
+void Model::draw() const {
+  if (preDrawCallback) preDrawCallback();
+  geometry->draw();
+  if (postDrawCallback) postDrawCallback();
+}
+}  // namespace graphics::shape
@@ -0,0 +1,178 @@
+#include "shape/optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace {
+// Parameters from https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+constexpr int forsythCacheSize = 32;
+constexpr int maxValenceScore = 32;
+constexpr float cacheDecayPower = 1.5f;
+constexpr float lastTriangleScore = 0.75f;
+constexpr float valenceBoostScale = 2.0f;
+constexpr float valenceBoostPower = 0.5f;
+constexpr GLuint invalidIndex = std::numeric_limits<GLuint>::max();
+
+struct ScoreTable {
+  ScoreTable() {
+    for (int i = 0; i < forsythCacheSize; ++i) {
+      if (i < 3) {
+        cache[i] = lastTriangleScore;
+      } else {
+        cache[i] = std::pow(1.0f - static_cast<float>(i - 3) / (forsythCacheSize - 3), cacheDecayPower);
+      }
+    }
+    valence[0] = 0.0f;
+    for (int i = 1; i < maxValenceScore; ++i)
+      valence[i] = valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+  }
+
+  float operator()(int cachePosition, GLuint remainingValence) const {
+    // No triangle needs this vertex anymore
+    if (remainingValence == 0) return -1.0f;
+    float score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+    if (remainingValence < maxValenceScore) {
+      score += valence[remainingValence];
+    } else {
+      score += valenceBoostScale * std::pow(static_cast<float>(remainingValence), -valenceBoostPower);
+    }
+    return score;
+  }
+
+  std::array<float, forsythCacheSize> cache;
+  std::array<float, maxValenceScore> valence;
+};
+}  // namespace
+
+namespace graphics::shape {
+VertexCacheStatistics analyzeVertexCache(const std::vector<GLuint>& indices, std::size_t vertexCount, int cacheSize) {
+  constexpr std::size_t never = std::numeric_limits<std::size_t>::max();
+  // Time (in misses) when the vertex entered the FIFO.
+  std::vector<std::size_t> cachedAt(vertexCount, never);
+  std::size_t misses = 0;
+  std::size_t referencedVertices = 0;
+  for (GLuint index : indices) {
+    std::size_t& enterTime = cachedAt[index];
+    if (enterTime == never) ++referencedVertices;
+    if (enterTime == never || misses - enterTime >= static_cast<std::size_t>(cacheSize)) {
+      enterTime = misses++;
+    }
+  }
+  VertexCacheStatistics statistics;
+  statistics.transformedVertices = misses;
+  if (indices.size() >= 3) statistics.acmr = static_cast<float>(misses) / (indices.size() / 3);
+  if (referencedVertices > 0) statistics.atvr = static_cast<float>(misses) / referencedVertices;
+  return statistics;
+}
+
+void optimizeVertexCache(std::vector<GLuint>& indices, std::size_t vertexCount) {
+  static const ScoreTable score;
+  const std::size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) return;
+  // Triangles using each vertex, packed into one array. Emitted triangles are swapped out of the live range.
+  std::vector<GLuint> valence(vertexCount, 0);
+  for (std::size_t i = 0; i < triangleCount * 3; ++i) ++valence[indices[i]];
+  std::vector<std::size_t> adjacencyOffset(vertexCount + 1, 0);
+  for (std::size_t v = 0; v < vertexCount; ++v) adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+  std::vector<GLuint> adjacency(triangleCount * 3);
+  {
+    std::vector<std::size_t> cursor(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) adjacency[cursor[indices[i]]++] = static_cast<GLuint>(i / 3);
+  }
+
+  std::vector<float> vertexScore(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; ++v) vertexScore[v] = score(-1, valence[v]);
+  std::vector<float> triangleScore(triangleCount);
+  for (std::size_t t = 0; t < triangleCount; ++t)
+    triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+  std::vector<bool> emitted(triangleCount, false);
+
+  std::vector<GLuint> output;
+  output.reserve(triangleCount * 3);
+  // LRU cache, 3 extra slots hold the vertices pushed out by the newest triangle.
+  std::array<GLuint, forsythCacheSize + 3> cache;
+  std::array<GLuint, forsythCacheSize + 3> nextCache;
+  int cacheCount = 0;
+
+  std::size_t bestTriangle = 0;
+  std::size_t scanCursor = 0;
+  while (output.size() < triangleCount * 3) {
+    if (bestTriangle == invalidIndex) {
+      // Nothing in the cache is useful, continue with the next triangle in the input order.
+      while (emitted[scanCursor]) ++scanCursor;
+      bestTriangle = scanCursor;
+    }
+    emitted[bestTriangle] = true;
+    const GLuint* triangle = &indices[3 * bestTriangle];
+    output.insert(output.end(), triangle, triangle + 3);
+
+    // Remove the triangle from its vertices' adjacency.
+    for (int k = 0; k < 3; ++k) {
+      GLuint v = triangle[k];
+      GLuint* begin = &adjacency[adjacencyOffset[v]];
+      GLuint* end = begin + valence[v];
+      *std::find(begin, end, static_cast<GLuint>(bestTriangle)) = *(end - 1);
+      --valence[v];
+    }
+
+    // Move the triangle's vertices to the front of the LRU cache.
+    int nextCount = 0;
+    for (int k = 0; k < 3; ++k) nextCache[nextCount++] = triangle[k];
+    for (int i = 0; i < cacheCount; ++i) {
+      GLuint v = cache[i];
+      if (v != triangle[0] && v != triangle[1] && v != triangle[2]) nextCache[nextCount++] = v;
+    }
+    std::swap(cache, nextCache);
+    cacheCount = nextCount;
+
+    // Rescore the cached and evicted vertices, then pick the best triangle touching the cache.
+    float bestScore = -1.0f;
+    bestTriangle = invalidIndex;
+    for (int i = 0; i < cacheCount; ++i) {
+      GLuint v = cache[i];
+      float newScore = score(i < forsythCacheSize ? i : -1, valence[v]);
+      float delta = newScore - vertexScore[v];
+      vertexScore[v] = newScore;
+      const GLuint* begin = &adjacency[adjacencyOffset[v]];
+      for (const GLuint* t = begin; t != begin + valence[v]; ++t) {
+        triangleScore[*t] += delta;
+        if (i < forsythCacheSize && triangleScore[*t] > bestScore) {
+          bestScore = triangleScore[*t];
+          bestTriangle = *t;
+        }
+      }
+    }
+    cacheCount = std::min(cacheCount, forsythCacheSize);
+  }
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+std::size_t optimizeVertexFetch(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, int stride) {
+  const std::size_t vertexCount = vertices.size() / stride;
+  std::vector<GLuint> remap(vertexCount, invalidIndex);
+  GLuint usedCount = 0;
+  for (GLuint& index : indices) {
+    if (remap[index] == invalidIndex) remap[index] = usedCount++;
+    index = remap[index];
+  }
+  std::vector<GLfloat> reordered(static_cast<std::size_t>(usedCount) * stride);
+  for (std::size_t v = 0; v < vertexCount; ++v) {
+    if (remap[v] == invalidIndex) continue;
+    std::copy_n(&vertices[v * stride], stride, &reordered[static_cast<std::size_t>(remap[v]) * stride]);
+  }
+  vertices.swap(reordered);
+  return usedCount;
+}
+
+MeshOptimizationReport optimizeMesh(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, int stride) {
+  MeshOptimizationReport report;
+  std::size_t vertexCount = vertices.size() / stride;
+  report.before = analyzeVertexCache(indices, vertexCount);
+  optimizeVertexCache(indices, vertexCount);
+  vertexCount = optimizeVertexFetch(vertices, indices, stride);
+  report.after = analyzeVertexCache(indices, vertexCount);
+  return report;
+}
+}  // namespace graphics::shape
@@ -0,0 +1,74 @@
+// Vertex cache simulation on known index orders, and optimizeMesh on plane and sphere grids: ACMR must drop and
+// the optimized mesh must draw the same triangles.
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "shape/optimizer.h"
+#include "shape/plane.h"
+#include "shape/sphere.h"
+#include "testing.h"
+
+namespace {
+using graphics::shape::Plane;
+using graphics::shape::Sphere;
+using Triangle = std::array<std::array<GLfloat, 3>, 3>;
+
+/// @return Triangles as vertex positions, rotated to start at the smallest corner and sorted.
+std::vector<Triangle> getTriangles(const std::vector<GLfloat>& vertices,
+                                   const std::vector<GLuint>& indices,
+                                   int stride) {
+  std::vector<Triangle> triangles(indices.size() / 3);
+  for (std::size_t i = 0; i < triangles.size(); ++i) {
+    for (int corner = 0; corner < 3; ++corner) {
+      const GLfloat* position = vertices.data() + indices[i * 3 + corner] * stride;
+      std::copy(position, position + 3, triangles[i][corner].begin());
+    }
+    // Rotation keeps the winding.
+    std::rotate(triangles[i].begin(), std::min_element(triangles[i].begin(), triangles[i].end()), triangles[i].end());
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+void testOptimizeMesh(const char* name, std::vector<GLfloat> vertices, std::vector<GLuint> indices, int stride) {
+  const std::vector<Triangle> triangles = getTriangles(vertices, indices, stride);
+  const std::size_t vertexCount = vertices.size() / stride;
+  const graphics::shape::MeshOptimizationReport report = graphics::shape::optimizeMesh(vertices, indices, stride);
+  std::printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name, report.before.acmr, report.after.acmr,
+              report.before.atvr, report.after.atvr);
+  EXPECT(report.after.acmr < report.before.acmr);
+  EXPECT(report.after.transformedVertices < report.before.transformedVertices);
+  EXPECT(report.after.atvr >= 1.0f);
+  // Fetch reordering only drops unreferenced vertices, e.g. the duplicated sphere poles.
+  const std::size_t optimizedCount = vertices.size() / stride;
+  EXPECT(optimizedCount <= vertexCount);
+  EXPECT(std::all_of(indices.begin(), indices.end(), [&](GLuint index) { return index < optimizedCount; }));
+  EXPECT(getTriangles(vertices, indices, stride) == triangles);
+}
+}  // namespace
+
+int main() {
+  using graphics::shape::analyzeVertexCache;
+  // One triangle: every vertex is transformed once.
+  graphics::shape::VertexCacheStatistics statistics = analyzeVertexCache({0, 1, 2}, 3);
+  EXPECT(statistics.transformedVertices == 3);
+  EXPECT(statistics.acmr == 3.0f);
+  EXPECT(statistics.atvr == 1.0f);
+  // A quad shares two vertices between its triangles.
+  statistics = analyzeVertexCache({0, 1, 2, 2, 1, 3}, 4);
+  EXPECT(statistics.transformedVertices == 4);
+  EXPECT(statistics.acmr == 2.0f);
+  // With a cache of 3 entries, the first vertex is evicted before it is used again.
+  statistics = analyzeVertexCache({0, 1, 2, 3, 4, 5, 0, 1, 2}, 6, 3);
+  EXPECT(statistics.transformedVertices == 9);
+  EXPECT(statistics.atvr == 1.5f);
+
+  std::vector<GLfloat> vertices;
+  std::vector<GLuint> indices;
+  Plane::generateVertices(vertices, indices, 64);
+  testOptimizeMesh("plane", vertices, indices, Plane::vertexStride);
+  Sphere::generateVertices(vertices, indices, 64, 128);
+  testOptimizeMesh("sphere", vertices, indices, Sphere::vertexStride);
+  return utils::testFailures() != 0;
+}
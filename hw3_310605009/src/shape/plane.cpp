@@ -1,83 +1,106 @@
 #include "shape/plane.h"
+
+#include "shape/meshfile.h"
+#include "shape/optimizer.h"
+
+namespace {
+// Bitangent (0, 0, -1) = cross(normal, tangent) * w.
+const GLuint planeNormal = graphics::shape::packDirection(glm::vec4(0, 1, 0, 0));
+const GLuint planeTangent = graphics::shape::packDirection(glm::vec4(1, 0, 0, 1));
+
+// Calls emit(vertexIndex, x, z, s, t) for every grid vertex and writes the triangle list, rows are split across
+// threads.
+template <typename Emit>
+void generateGrid(GLuint* indices, int subdivision, float width, float height, bool scaleTexture, Emit emit) {
+  // Spawning threads only pays off for large grids.
+  constexpr int minVerticesPerThread = 1 << 15;
+  const int rowSize = subdivision + 1;
+  const int minRowsPerThread = minVerticesPerThread / rowSize + 1;
+
+  float wStep = 2.0f * width / subdivision;
+  float hStep = 2.0f * height / subdivision;
+  float wTexStep = scaleTexture ? 1.0f / subdivision : width / subdivision;
+  float hTexStep = scaleTexture ? 1.0f / subdivision : height / subdivision;
+  float texTop = scaleTexture ? 1.0f : height;
+  utils::parallelFor(subdivision + 1, minRowsPerThread, [=](int first, int last) {
+    std::size_t vertex = static_cast<std::size_t>(first) * rowSize;
+    for (int i = first; i < last; ++i) {
+      for (int j = 0; j < rowSize; ++j, ++vertex) {
+        emit(vertex, -width + j * wStep, -height + i * hStep, 0 + j * wTexStep, texTop - i * hTexStep);
+      }
+    }
+  });
+
+  utils::parallelFor(subdivision, minRowsPerThread, [=](int first, int last) {
+    GLuint* index = indices + static_cast<std::size_t>(first) * subdivision * 6;
+    for (int i = first; i < last; ++i) {
+      GLuint offset = static_cast<GLuint>(i) * rowSize;
+      for (int j = 0; j < subdivision; ++j, index += 6) {
+        index[0] = offset + j;
+        index[1] = offset + j + subdivision + 1;
+        index[2] = offset + j + 1;
+
+        index[3] = offset + j + 1;
+        index[4] = offset + j + subdivision + 1;
+        index[5] = offset + j + subdivision + 2;
+      }
+    }
+  });
+}
+}  // namespace
+
 namespace graphics::shape {
 
-std::weak_ptr<buffer::VertexArray> Plane::vao_weak;
-std::weak_ptr<buffer::ArrayBuffer> Plane::vbo_weak;
-std::weak_ptr<buffer::ElementArrayBuffer> Plane::ebo_weak;
-
-Plane::Plane() {
-  if ((ebo = ebo_weak.lock())) {
-    // Already have vertex data.
-    vao = vao_weak.lock();
-    vbo = vbo_weak.lock();
-  } else {
-    // First object.
-    std::vector<GLfloat> vertices;
-    std::vector<GLuint> indices;
-    generateVertices(vertices, indices);
-
-    vao_weak = vao = std::make_shared<buffer::VertexArray>();
-    vbo_weak = vbo = std::make_shared<buffer::ArrayBuffer>();
-    ebo_weak = ebo = std::make_shared<buffer::ElementArrayBuffer>();
-
-    vbo->allocate_load(vertices.size() * sizeof(GLfloat), vertices.data());
-    ebo->allocate_load(indices.size() * sizeof(GLuint), indices.data());
-
-    vao->bind();
-    vbo->bind();
-    ebo->bind();
-
-    vao->enable(0);
-    vao->setAttributePointer(0, 3, 14, 0);
-    vao->enable(1);
-    vao->setAttributePointer(1, 3, 14, 3);
-    vao->enable(2);
-    vao->setAttributePointer(2, 2, 14, 6);
-    vao->enable(3);
-    vao->setAttributePointer(3, 3, 14, 8);
-    vao->enable(4);
-    vao->setAttributePointer(4, 3, 14, 11);
-
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  }
+Plane::Plane(int subdivision, float width, float height, bool scaleTexture) : primitive(GL_TRIANGLES) {
+  GeometryKey key = makeGeometryKey(ShapeType::Plane, subdivision, width, height, scaleTexture);
+  geometry = GeometryRegistry::get(key, [=] {
+    static const VertexLayout layout = makeFloatLayout({3, 3, 2, 3, 3});
+    return MeshCache::load(key, layout, [=](std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) {
+      generateVertices(vertices, indices, subdivision, width, height, scaleTexture);
+      optimizeMesh(vertices, indices, vertexStride);
+    });
+  });
+  localBounds = geometry->getBounds();
 }
 
-Plane::Plane(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices) {
-  vao = std::make_shared<buffer::VertexArray>();
-  vbo = std::make_shared<buffer::ArrayBuffer>();
-  ebo = std::make_shared<buffer::ElementArrayBuffer>();
-
-  vbo->allocate_load(vertices.size() * sizeof(GLfloat), vertices.data());
-  ebo->allocate_load(indices.size() * sizeof(GLuint), indices.data());
-
-  vao->bind();
-  vbo->bind();
-  ebo->bind();
-
-  vao->enable(0);
-  vao->setAttributePointer(0, 3, 14, 0);
-  vao->enable(1);
-  vao->setAttributePointer(1, 3, 14, 3);
-  vao->enable(2);
-  vao->setAttributePointer(2, 2, 14, 6);
-  vao->enable(3);
-  vao->setAttributePointer(3, 3, 14, 8);
-  vao->enable(4);
-  vao->setAttributePointer(4, 3, 14, 11);
-
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+Plane::Plane(const std::vector<GLfloat>& vertices, const std::vector<GLuint>& indices, GLenum _primitive)
+    : primitive(_primitive) {
+  acquireGeometry(vertices.data(), vertices.size() * sizeof(GLfloat), indices, VertexFormat::Float);
+}
+
+Plane::Plane(const std::vector<PackedVertex>& vertices, const std::vector<GLuint>& indices, GLenum _primitive)
+    : primitive(_primitive) {
+  acquireGeometry(vertices.data(), vertices.size() * sizeof(PackedVertex), indices, VertexFormat::Packed);
+}
+
+Plane::Plane(const std::vector<QuantizedVertex>& vertices, const std::vector<GLuint>& indices, GLenum _primitive)
+    : primitive(_primitive) {
+  acquireGeometry(vertices.data(), vertices.size() * sizeof(QuantizedVertex), indices, VertexFormat::Quantized);
+}
+
+GeometryPTR Plane::makeGeometry(const void* vertices,
+                                std::size_t size,
+                                const std::vector<GLuint>& indices,
+                                VertexFormat format,
+                                GLenum primitive) {
+  return std::make_shared<Geometry>(vertices, size, indices, getVertexLayout(format), primitive);
+}
+
+void Plane::acquireGeometry(const void* vertices,
+                            std::size_t size,
+                            const std::vector<GLuint>& indices,
+                            VertexFormat format) {
+  // Same bytes in another layout or primitive is another mesh.
+  uint64_t tag = static_cast<uint64_t>(getType()) | static_cast<uint64_t>(format) << 8 |
+                 static_cast<uint64_t>(primitive) << 16;
+  geometry = GeometryRegistry::get(vertices, size, indices, tag,
+                                   [&] { return makeGeometry(vertices, size, indices, format, primitive); });
+  localBounds = geometry->getBounds();
 }
 
 void Plane::draw() const {
   if (preDrawCallback) preDrawCallback();
-  vao->bind();
-  GLsizei indexCount = static_cast<GLsizei>(ebo->getSize() / sizeof(GLuint));
-  glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
-  glBindVertexArray(0);
+  geometry->draw();
   if (postDrawCallback) postDrawCallback();
 }
 
@@ -87,34 +110,97 @@ void Plane::generateVertices(std::vector<GLfloat>& vertices,
                              float width,
                              float height,
                              bool scaleTexture) {
-  vertices.reserve((subdivision + 1) * (subdivision + 1) * 8);
-  indices.reserve((subdivision) * (2 * subdivision + 3));
+  // Exact sizes, every element is overwritten below.
+  vertices.resize(getVertexCount(subdivision) * vertexStride);
+  indices.resize(getIndexCount(subdivision));
+  generateVertices(vertices.data(), indices.data(), subdivision, width, height, scaleTexture);
+}
 
-  float wStep = 2.0f * width / subdivision;
-  float hStep = 2.0f * height / subdivision;
-  float wTexStep = scaleTexture ? 1.0f / subdivision : width / subdivision;
-  float hTexStep = scaleTexture ? 1.0f / subdivision : height / subdivision;
-  for (int i = 0; i < subdivision + 1; ++i) {
-    for (int j = 0; j < subdivision + 1; ++j) {
-      vertices.insert(vertices.end(), {-width + j * wStep, 0, -height + i * hStep, 0, 1, 0});
-      if (scaleTexture)
-        vertices.insert(vertices.end(), {0 + j * wTexStep, 1 - i * hTexStep});
-      else
-        vertices.insert(vertices.end(), {0 + j * wTexStep, height - i * hTexStep});
-      vertices.insert(vertices.end(), {1, 0, 0, 0, 0, -1});
-    }
-  }
+void Plane::generateVertices(GLfloat* vertices,
+                             GLuint* indices,
+                             int subdivision,
+                             float width,
+                             float height,
+                             bool scaleTexture) {
+  generateGrid(indices, subdivision, width, height, scaleTexture,
+               [vertices](std::size_t i, float x, float z, float s, float t) {
+                 GLfloat* vertex = vertices + i * vertexStride;
+                 vertex[0] = x;
+                 vertex[1] = 0;
+                 vertex[2] = z;
+                 vertex[3] = 0;
+                 vertex[4] = 1;
+                 vertex[5] = 0;
+                 vertex[6] = s;
+                 vertex[7] = t;
+                 vertex[8] = 1;
+                 vertex[9] = 0;
+                 vertex[10] = 0;
+                 vertex[11] = 0;
+                 vertex[12] = 0;
+                 vertex[13] = -1;
+               });
+}
+
+void Plane::generateVertices(std::vector<PackedVertex>& vertices,
+                             std::vector<GLuint>& indices,
+                             int subdivision,
+                             float width,
+                             float height,
+                             bool scaleTexture) {
+  vertices.resize(getVertexCount(subdivision));
+  indices.resize(getIndexCount(subdivision));
+  PackedVertex* data = vertices.data();
+  generateGrid(indices.data(), subdivision, width, height, scaleTexture,
+               [data](std::size_t i, float x, float z, float s, float t) {
+                 PackedVertex& vertex = data[i];
+                 vertex.position[0] = x;
+                 vertex.position[1] = 0;
+                 vertex.position[2] = z;
+                 vertex.normal = planeNormal;
+                 vertex.tangent = planeTangent;
+                 vertex.textureCoordinate[0] = glm::packHalf1x16(s);
+                 vertex.textureCoordinate[1] = glm::packHalf1x16(t);
+               });
+}
+
+void Plane::generateVertices(std::vector<QuantizedVertex>& vertices,
+                             std::vector<GLuint>& indices,
+                             PositionQuantization& quantization,
+                             int subdivision,
+                             float width,
+                             float height,
+                             bool scaleTexture) {
+  vertices.resize(getVertexCount(subdivision));
+  indices.resize(getIndexCount(subdivision));
+  // y is always 0, a zero scale makes it exact.
+  quantization.scale = glm::vec3(2.0f * width, 0.0f, 2.0f * height);
+  quantization.bias = glm::vec3(-width, 0.0f, -height);
+  const PositionQuantization q = quantization;
+  QuantizedVertex* data = vertices.data();
+  generateGrid(indices.data(), subdivision, width, height, scaleTexture,
+               [data, q](std::size_t i, float x, float z, float s, float t) {
+                 QuantizedVertex& vertex = data[i];
+                 vertex.position[0] = quantizePosition(x, q.scale.x, q.bias.x);
+                 vertex.position[1] = 0;
+                 vertex.position[2] = quantizePosition(z, q.scale.z, q.bias.z);
+                 vertex.padding = 0;
+                 vertex.normal = planeNormal;
+                 vertex.tangent = planeTangent;
+                 vertex.textureCoordinate[0] = glm::packHalf1x16(s);
+                 vertex.textureCoordinate[1] = glm::packHalf1x16(t);
+               });
+}
 
+void Plane::generateStripIndices(std::vector<GLuint>& indices, int subdivision) {
+  indices.resize(getStripIndexCount(subdivision));
+  GLuint* index = indices.data();
   for (int i = 0; i < subdivision; ++i) {
-    int offset = i * (subdivision + 1);
-    for (int j = 0; j < subdivision; ++j) {
-      indices.emplace_back(offset + j);
-      indices.emplace_back(offset + j + subdivision + 1);
-      indices.emplace_back(offset + j + 1);
-
-      indices.emplace_back(offset + j + 1);
-      indices.emplace_back(offset + j + subdivision + 1);
-      indices.emplace_back(offset + j + subdivision + 2);
+    if (i != 0) *index++ = buffer::ElementArrayBuffer::restartIndex;
+    GLuint offset = static_cast<GLuint>(i) * (subdivision + 1);
+    for (int j = 0; j < subdivision + 1; ++j) {
+      *index++ = offset + j;
+      *index++ = offset + j + subdivision + 1;
     }
   }
 }
@@ -0,0 +1,24 @@
+// Plane::generateVertices into preallocated storage, for subdivisions up to 4096 (or the first argument).
+// Time per vertex should stay flat as the grid grows, and drop with the thread count.
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "benchmark.h"
+#include "shape/plane.h"
+
+int main(int argc, char** argv) {
+  using graphics::shape::Plane;
+  const int maxSubdivision = argc > 1 ? std::atoi(argv[1]) : 4096;
+  std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+  std::printf("%12s %12s %12s %14s\n", "subdivision", "vertices", "ms", "ns / vertex");
+  for (int subdivision = 256; subdivision <= maxSubdivision; subdivision *= 2) {
+    const std::size_t vertexCount = Plane::getVertexCount(subdivision);
+    auto vertex = std::make_unique<GLfloat[]>(vertexCount * Plane::vertexStride);
+    auto index = std::make_unique<GLuint[]>(Plane::getIndexCount(subdivision));
+    const double milliseconds = utils::measureMilliseconds(
+        3, [&] { Plane::generateVertices(vertex.get(), index.get(), subdivision, 1, 1, true); });
+    std::printf("%12d %12zu %12.2f %14.2f\n", subdivision, vertexCount, milliseconds, milliseconds * 1e6 / vertexCount);
+  }
+}
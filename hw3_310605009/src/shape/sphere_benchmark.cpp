@@ -0,0 +1,54 @@
+// Sphere::generateVertices against the per-vertex sinf / cosf loop it replaced, for stack and slice up to 2048
+// (or the first argument). Both write preallocated storage, so only the vertex math and index loops are compared.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "benchmark.h"
+#include "shape/sphere.h"
+
+namespace {
+using graphics::shape::Sphere;
+/// The generator before trig tables, see http://www.songho.ca/opengl/gl_sphere.html#sphere
+void generateReference(GLfloat* vertex, GLuint* index, int stack, int slice) {
+  const float sectorStep = glm::two_pi<float>() / slice;
+  const float stackStep = glm::pi<float>() / stack;
+  for (int i = 0; i <= stack; ++i) {
+    const float stackAngle = glm::half_pi<float>() - i * stackStep;
+    const float xy = cosf(stackAngle), z = sinf(stackAngle);
+    for (int j = 0; j <= slice; ++j, vertex += Sphere::vertexStride) {
+      const float sectorAngle = j * sectorStep;
+      const float x = xy * cosf(sectorAngle), y = xy * sinf(sectorAngle);
+      const GLfloat data[] = {x, y, z, x, y, z, static_cast<float>(j) / slice, static_cast<float>(i) / stack};
+      std::copy(data, data + Sphere::vertexStride, vertex);
+    }
+  }
+  for (GLuint i = 0; i < static_cast<GLuint>(stack); ++i) {
+    GLuint k1 = i * (slice + 1), k2 = k1 + slice + 1;
+    for (int j = 0; j < slice; ++j, ++k1, ++k2) {
+      if (i != 0) *index++ = k1, *index++ = k2, *index++ = k1 + 1;
+      if (i + 1 != static_cast<GLuint>(stack)) *index++ = k1 + 1, *index++ = k2, *index++ = k2 + 1;
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int maxResolution = argc > 1 ? std::atoi(argv[1]) : 2048;
+  std::printf("%12s %12s %16s %16s %10s\n", "stack/slice", "vertices", "reference Mv/s", "tables Mv/s", "speedup");
+  for (int n = 128; n <= maxResolution; n *= 2) {
+    const std::size_t vertexCount = Sphere::getVertexCount(n, n);
+    auto vertex = std::make_unique<GLfloat[]>(vertexCount * Sphere::vertexStride);
+    auto index = std::make_unique<GLuint[]>(Sphere::getIndexCount(n, n));
+    const double reference = utils::measureMilliseconds(3, [&] { generateReference(vertex.get(), index.get(), n, n); });
+    const double tables =
+        utils::measureMilliseconds(3, [&] { Sphere::generateVertices(vertex.get(), index.get(), n, n); });
+    std::printf("%12d %12zu %16.1f %16.1f %9.2fx\n", n, vertexCount, vertexCount / reference / 1e3,
+                vertexCount / tables / 1e3, reference / tables);
+  }
+}
@@ -0,0 +1,73 @@
+#include "shape/vertexformat.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace {
+using graphics::shape::VertexLayout;
+
+// Attributes 0 ~ 3 of PackedVertex-like formats, normal and tangent are GL_INT_2_10_10_10_REV.
+VertexLayout makePackedLayout(uint32_t stride,
+                              GLenum positionType,
+                              bool positionNormalized,
+                              uint32_t position,
+                              uint32_t normal,
+                              uint32_t textureCoordinate,
+                              uint32_t tangent) {
+  VertexLayout layout;
+  layout.stride = stride;
+  layout.attributeCount = 4;
+  layout.attributes[0] = {0, 3, positionType, positionNormalized, position};
+  layout.attributes[1] = {1, 4, GL_INT_2_10_10_10_REV, true, normal};
+  layout.attributes[2] = {2, 2, GL_HALF_FLOAT, false, textureCoordinate};
+  layout.attributes[3] = {3, 4, GL_INT_2_10_10_10_REV, true, tangent};
+  return layout;
+}
+}  // namespace
+
+namespace graphics::shape {
+void VertexLayout::apply(buffer::VertexArray& vao, const buffer::ArrayBuffer& vbo) const {
+  vao.setVertexBuffer(0, vbo, 0, stride);
+  for (uint32_t i = 0; i < attributeCount; ++i) {
+    const VertexAttribute& attribute = attributes[i];
+    vao.enable(attribute.index);
+    vao.setAttributeFormat(attribute.index, attribute.size, attribute.type, attribute.normalized != 0,
+                           attribute.offset);
+  }
+}
+
+bool VertexLayout::operator==(const VertexLayout& other) const {
+  return stride == other.stride && attributeCount == other.attributeCount &&
+         std::memcmp(attributes, other.attributes, attributeCount * sizeof(VertexAttribute)) == 0;
+}
+
+VertexLayout makeFloatLayout(std::initializer_list<int> sizes) {
+  VertexLayout layout;
+  for (int size : sizes) {
+    if (layout.attributeCount == VertexLayout::maxAttributes)
+      THROW_EXCEPTION(std::length_error, "Too many vertex attributes");
+    VertexAttribute& attribute = layout.attributes[layout.attributeCount];
+    attribute.index = layout.attributeCount++;
+    attribute.size = size;
+    attribute.type = GL_FLOAT;
+    attribute.normalized = GL_FALSE;
+    attribute.offset = layout.stride;
+    layout.stride += size * sizeof(GLfloat);
+  }
+  return layout;
+}
+
+const VertexLayout& getVertexLayout(VertexFormat format) {
+  // Packed and quantized vertices share everything but the position type.
+  static const VertexLayout layouts[3] = {
+      makeFloatLayout({3, 3, 2, 3, 3}),
+      makePackedLayout(sizeof(PackedVertex), GL_FLOAT, false, offsetof(PackedVertex, position),
+                       offsetof(PackedVertex, normal), offsetof(PackedVertex, textureCoordinate),
+                       offsetof(PackedVertex, tangent)),
+      makePackedLayout(sizeof(QuantizedVertex), GL_UNSIGNED_SHORT, true, offsetof(QuantizedVertex, position),
+                       offsetof(QuantizedVertex, normal), offsetof(QuantizedVertex, textureCoordinate),
+                       offsetof(QuantizedVertex, tangent)),
+  };
+  return layouts[static_cast<int>(format)];
+}
+}  // namespace graphics::shape
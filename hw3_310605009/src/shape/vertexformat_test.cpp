@@ -0,0 +1,141 @@
+// Encode / decode round trips of PackedVertex and QuantizedVertex components, checked against the error bounds
+// stated in vertexformat.h, and the packed planes against the float plane.
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "shape/plane.h"
+#include "shape/vertexformat.h"
+#include "testing.h"
+
+namespace {
+using namespace graphics::shape;
+constexpr float directionError = 1.0f / 511.0f;
+constexpr float legacyDirectionError = 3.0f / 1023.0f;
+// Float rounding of the decode itself
+constexpr float epsilon = 1e-6f;
+
+/// @return Signed 10-bit component i of GL_INT_2_10_10_10_REV.
+int getComponent(GLuint packed, int i) {
+  const int value = static_cast<int>((packed >> (10 * i)) & 1023u);
+  return value >= 512 ? value - 1024 : value;
+}
+/// @brief Decode with the GL 4.2 rule, max(c / 511, -1).
+glm::vec4 decodeDirection(GLuint packed) {
+  glm::vec4 direction;
+  for (int i = 0; i < 3; ++i) direction[i] = std::max(getComponent(packed, i) / 511.0f, -1.0f);
+  const int w = static_cast<int>(packed >> 30);
+  direction.w = std::max(static_cast<float>(w >= 2 ? w - 4 : w), -1.0f);
+  return direction;
+}
+/// @brief Decode with the GL 3.3 rule, (2c + 1) / 1023.
+glm::vec3 decodeDirectionLegacy(GLuint packed) {
+  glm::vec3 direction;
+  for (int i = 0; i < 3; ++i) direction[i] = (2.0f * getComponent(packed, i) + 1.0f) / 1023.0f;
+  return direction;
+}
+bool isNear(float a, float b, float error) { return std::abs(a - b) <= error + epsilon; }
+bool isNear(const glm::vec3& a, const glm::vec3& b, float error) {
+  return isNear(a.x, b.x, error) && isNear(a.y, b.y, error) && isNear(a.z, b.z, error);
+}
+/// @brief Half precision: relative error 2^-11, absolute 2^-25 among the subnormals.
+bool isNearHalf(float decoded, float value) {
+  return std::abs(decoded - value) <= std::max(std::ldexp(std::abs(value), -11), std::ldexp(1.0f, -25));
+}
+
+void testDirections() {
+  std::mt19937 random(310605009);
+  std::normal_distribution<float> normal;
+  for (int i = 0; i < 100000; ++i) {
+    const glm::vec3 direction = glm::normalize(glm::vec3(normal(random), normal(random), normal(random)));
+    const float sign = i % 2 == 0 ? 1.0f : -1.0f;
+    const GLuint packed = packDirection(glm::vec4(direction, sign));
+    const glm::vec4 decoded = decodeDirection(packed);
+    if (!EXPECT(isNear(glm::vec3(decoded), direction, directionError))) break;
+    if (!EXPECT(isNear(decodeDirectionLegacy(packed), direction, legacyDirectionError))) break;
+    if (!EXPECT(decoded.w == sign)) break;
+  }
+  // The axes are exact under the GL 4.2 rule.
+  EXPECT(decodeDirection(packDirection(glm::vec4(0, 1, 0, 1))).y == 1.0f);
+  EXPECT(decodeDirection(packDirection(glm::vec4(0, 0, -1, -1))).z == -1.0f);
+}
+
+void testPositions() {
+  const float scale = 7.5f, bias = -3.25f;
+  for (int i = 0; i <= 100000; ++i) {
+    const float position = bias + scale * i / 100000.0f;
+    const float decoded = quantizePosition(position, scale, bias) / 65535.0f * scale + bias;
+    if (!EXPECT(isNear(decoded, position, 0.5f / 65535.0f * scale))) break;
+  }
+  EXPECT(quantizePosition(bias, scale, bias) == 0);
+  EXPECT(quantizePosition(bias + scale, scale, bias) == 65535);
+  EXPECT(quantizePosition(4.0f, 0.0f, 0.0f) == 0);
+}
+
+void testTextureCoordinates() {
+  for (int i = 0; i <= 100000; ++i) {
+    const float coordinate = i / 100000.0f;
+    if (!EXPECT(isNearHalf(glm::unpackHalf1x16(glm::packHalf1x16(coordinate)), coordinate))) break;
+  }
+}
+
+void testLayouts() {
+  for (VertexFormat format : {VertexFormat::Float, VertexFormat::Packed, VertexFormat::Quantized})
+    EXPECT(getVertexLayout(format).stride == static_cast<uint32_t>(getVertexSize(format)));
+  EXPECT(getVertexSize(VertexFormat::Float) == Plane::vertexStride * static_cast<int>(sizeof(GLfloat)));
+}
+
+/// @brief Decoded normal, tangent and bitangent of a packed vertex against the float vertex.
+template <typename Vertex>
+bool isNearFrame(const Vertex& vertex, const GLfloat* expected) {
+  const glm::vec4 normal = decodeDirection(vertex.normal), tangent = decodeDirection(vertex.tangent);
+  const glm::vec3 bitangent = glm::cross(glm::vec3(normal), glm::vec3(tangent)) * tangent.w;
+  // Each factor of the cross product carries the direction error.
+  return isNear(glm::vec3(normal), glm::vec3(expected[3], expected[4], expected[5]), directionError) &&
+         isNear(glm::vec3(tangent), glm::vec3(expected[8], expected[9], expected[10]), directionError) &&
+         isNear(bitangent, glm::vec3(expected[11], expected[12], expected[13]), 4 * directionError);
+}
+template <typename Vertex>
+bool isNearTextureCoordinate(const Vertex& vertex, const GLfloat* expected) {
+  return isNearHalf(glm::unpackHalf1x16(vertex.textureCoordinate[0]), expected[6]) &&
+         isNearHalf(glm::unpackHalf1x16(vertex.textureCoordinate[1]), expected[7]);
+}
+
+void testPlanes() {
+  constexpr int subdivision = 50;
+  constexpr float width = 3, height = 2;
+  std::vector<GLfloat> reference;
+  std::vector<PackedVertex> packed;
+  std::vector<QuantizedVertex> quantized;
+  std::vector<GLuint> referenceIndex, packedIndex, quantizedIndex;
+  PositionQuantization quantization;
+  Plane::generateVertices(reference, referenceIndex, subdivision, width, height);
+  Plane::generateVertices(packed, packedIndex, subdivision, width, height);
+  Plane::generateVertices(quantized, quantizedIndex, quantization, subdivision, width, height);
+  EXPECT(packed.size() == Plane::getVertexCount(subdivision) && quantized.size() == packed.size());
+  EXPECT(packedIndex == referenceIndex && quantizedIndex == referenceIndex);
+  for (std::size_t i = 0; i < packed.size(); ++i) {
+    const GLfloat* expected = reference.data() + i * Plane::vertexStride;
+    const glm::vec3 position(expected[0], expected[1], expected[2]);
+    if (!EXPECT(glm::vec3(packed[i].position[0], packed[i].position[1], packed[i].position[2]) == position)) break;
+    glm::vec3 decoded;
+    for (int axis = 0; axis < 3; ++axis)
+      decoded[axis] = quantized[i].position[axis] / 65535.0f * quantization.scale[axis] + quantization.bias[axis];
+    const float positionError = 0.5f / 65535.0f * std::max(quantization.scale.x, quantization.scale.z);
+    if (!EXPECT(isNear(decoded, position, positionError))) break;
+    if (!EXPECT(isNearFrame(packed[i], expected) && isNearFrame(quantized[i], expected))) break;
+    if (!EXPECT(isNearTextureCoordinate(packed[i], expected) && isNearTextureCoordinate(quantized[i], expected)))
+      break;
+  }
+}
+}  // namespace
+
+int main() {
+  testDirections();
+  testPositions();
+  testTextureCoordinates();
+  testLayouts();
+  testPlanes();
+  return utils::testFailures() != 0;
+}
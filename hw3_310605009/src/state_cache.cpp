@@ -0,0 +1,195 @@
+#include "state_cache.h"
+
+#include "context_manager.h"
+
+namespace {
+/// @return Slot of a cached buffer target, -1 for targets that are always issued.
+int getBufferTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_UNIFORM_BUFFER: return 1;
+    case GL_SHADER_STORAGE_BUFFER: return 2;
+    case GL_DRAW_INDIRECT_BUFFER: return 3;
+    case GL_COPY_READ_BUFFER: return 4;
+    case GL_COPY_WRITE_BUFFER: return 5;
+    default: return -1;
+  }
+}
+
+/// @return Slot of a cached texture target, -1 for targets that are always issued.
+int getTextureTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    case GL_TEXTURE_3D: return 2;
+    case GL_TEXTURE_CUBE_MAP: return 3;
+    default: return -1;
+  }
+}
+}  // namespace
+
+void OpenGLStateCache::invalidate() noexcept {
+  program = vertexArray = activeTextureUnit = unknown;
+  buffers.fill(unknown);
+  uniformRanges.fill(BufferRange{unknown, 0, 0});
+  storageRanges.fill(BufferRange{unknown, 0, 0});
+  for (auto& unit : textures) unit.fill(unknown);
+  drawFramebuffer = readFramebuffer = unknown;
+  depthTest = cullFace = blend = primitiveRestart = depthMask = -1;
+  depthFunc = cullMode = frontFace = GL_NONE;
+  blendFunc.fill(unknown);
+  restartIndex = unknown;
+  viewport.fill(-1);
+}
+
+void OpenGLStateCache::beginFrame() noexcept {
+  lastFrame = frame;
+  frame = Counters();
+}
+
+void OpenGLStateCache::useProgram(GLuint _program) noexcept {
+  if (update(program, _program)) glUseProgram(program);
+}
+
+void OpenGLStateCache::bindVertexArray(GLuint _vertexArray) noexcept {
+  if (update(vertexArray, _vertexArray)) glBindVertexArray(vertexArray);
+}
+
+void OpenGLStateCache::bindBuffer(GLenum target, GLuint buffer) noexcept {
+  int index = getBufferTargetIndex(target);
+  if (index < 0) {
+    ++frame.issued;
+    glBindBuffer(target, buffer);
+  } else if (update(buffers[index], buffer)) {
+    glBindBuffer(target, buffer);
+  }
+}
+
+void OpenGLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset,
+                                       GLsizeiptr size) noexcept {
+  BufferRange* range = nullptr;
+  if (index < indexedBindingCount && target == GL_UNIFORM_BUFFER) range = &uniformRanges[index];
+  if (index < indexedBindingCount && target == GL_SHADER_STORAGE_BUFFER) range = &storageRanges[index];
+  if (range == nullptr) {
+    ++frame.issued;
+  } else if (!update(*range, BufferRange{buffer, offset, size})) {
+    return;
+  }
+  if (size == 0) {
+    glBindBufferBase(target, index, buffer);
+  } else {
+    glBindBufferRange(target, index, buffer, offset, size);
+  }
+  // Indexed binds also bind the generic target.
+  if (int generic = getBufferTargetIndex(target); generic >= 0) buffers[generic] = buffer;
+}
+
+void OpenGLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) noexcept {
+  int index = getTextureTargetIndex(target);
+  if (unit >= textureUnitCount || index < 0) {
+    ++frame.issued;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+    activeTextureUnit = unit;
+    return;
+  }
+  if (OpenGLContext::hasDirectStateAccess()) {
+    if (!update(textures[unit][index], texture)) return;
+    glBindTextureUnit(unit, texture);
+    // Binding 0 unbinds every target of the unit.
+    if (texture == 0) textures[unit].fill(0);
+    return;
+  }
+  // Editing without direct state access relies on the unit being active, even if the texture is bound already.
+  if (update(activeTextureUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+  if (update(textures[unit][index], texture)) glBindTexture(target, texture);
+}
+
+void OpenGLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer) noexcept {
+  switch (target) {
+    case GL_DRAW_FRAMEBUFFER:
+      if (update(drawFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+      break;
+    case GL_READ_FRAMEBUFFER:
+      if (update(readFramebuffer, framebuffer)) glBindFramebuffer(target, framebuffer);
+      break;
+    default:
+      if (drawFramebuffer == framebuffer && readFramebuffer == framebuffer) {
+        ++frame.skipped;
+        break;
+      }
+      ++frame.issued;
+      drawFramebuffer = readFramebuffer = framebuffer;
+      glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+      break;
+  }
+}
+
+void OpenGLStateCache::setCapability(GLenum capability, int8_t& cached, bool enable) noexcept {
+  if (!update(cached, static_cast<int8_t>(enable))) return;
+  if (enable) {
+    glEnable(capability);
+  } else {
+    glDisable(capability);
+  }
+}
+
+void OpenGLStateCache::setDepthTest(bool enable) noexcept { setCapability(GL_DEPTH_TEST, depthTest, enable); }
+void OpenGLStateCache::setDepthFunc(GLenum func) noexcept {
+  if (update(depthFunc, func)) glDepthFunc(func);
+}
+void OpenGLStateCache::setDepthMask(bool enable) noexcept {
+  if (update(depthMask, static_cast<int8_t>(enable))) glDepthMask(enable ? GL_TRUE : GL_FALSE);
+}
+void OpenGLStateCache::setCullFace(bool enable) noexcept { setCapability(GL_CULL_FACE, cullFace, enable); }
+void OpenGLStateCache::setCullMode(GLenum mode) noexcept {
+  if (update(cullMode, mode)) glCullFace(mode);
+}
+void OpenGLStateCache::setFrontFace(GLenum mode) noexcept {
+  if (update(frontFace, mode)) glFrontFace(mode);
+}
+void OpenGLStateCache::setBlend(bool enable) noexcept { setCapability(GL_BLEND, blend, enable); }
+void OpenGLStateCache::setBlendFunc(GLenum source, GLenum destination) noexcept {
+  if (update(blendFunc, {source, destination})) glBlendFunc(source, destination);
+}
+void OpenGLStateCache::setPrimitiveRestart(bool enable, GLuint index) noexcept {
+  setCapability(GL_PRIMITIVE_RESTART, primitiveRestart, enable);
+  if (enable && update(restartIndex, index)) glPrimitiveRestartIndex(index);
+}
+void OpenGLStateCache::setViewport(GLint x, GLint y, GLsizei width, GLsizei height) noexcept {
+  if (update(viewport, {x, y, width, height})) glViewport(x, y, width, height);
+}
+
+void OpenGLStateCache::deleteProgram(GLuint _program) noexcept {
+  glDeleteProgram(_program);
+  if (program == _program) program = unknown;
+}
+
+void OpenGLStateCache::deleteVertexArray(GLuint _vertexArray) noexcept {
+  glDeleteVertexArrays(1, &_vertexArray);
+  if (vertexArray == _vertexArray) vertexArray = 0;
+}
+
+void OpenGLStateCache::deleteBuffer(GLuint buffer) noexcept {
+  glDeleteBuffers(1, &buffer);
+  // GL unbinds deleted buffers, the name may come back from glGenBuffers.
+  for (GLuint& bound : buffers)
+    if (bound == buffer) bound = 0;
+  for (BufferRange& range : uniformRanges)
+    if (range.buffer == buffer) range.buffer = unknown;
+  for (BufferRange& range : storageRanges)
+    if (range.buffer == buffer) range.buffer = unknown;
+}
+
+void OpenGLStateCache::deleteTexture(GLuint texture) noexcept {
+  glDeleteTextures(1, &texture);
+  for (auto& unit : textures)
+    for (GLuint& bound : unit)
+      if (bound == texture) bound = 0;
+}
+
+void OpenGLStateCache::deleteFramebuffer(GLuint framebuffer) noexcept {
+  glDeleteFramebuffers(1, &framebuffer);
+  if (drawFramebuffer == framebuffer) drawFramebuffer = 0;
+  if (readFramebuffer == framebuffer) readFramebuffer = 0;
+}
@@ -3,6 +3,8 @@
 
 #include <stb_image.h>
 #include <glm/gtc/type_ptr.hpp>
+
+#include "context_manager.h"
 namespace graphics::texture {
 void TextureCubeMap::fromFile(const utils::fs::path& posx,
                               const utils::fs::path& negx,
@@ -14,6 +16,23 @@ void TextureCubeMap::fromFile(const utils::fs::path& posx,
   std::array<const utils::fs::path, 6> filenames{posx, negx, posy, negy, posz, negz};
   int width, height, nChannels;
   stbi_set_flip_vertically_on_load(flip);
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    for (int i = 0; i < 6; ++i) {
+      stbi_uc* data = stbi_load(filenames[i].string().c_str(), &width, &height, &nChannels, STBI_default);
+      if (data == nullptr) THROW_EXCEPTION(std::runtime_error, "Failed to load texture file");
+      // Storage is sized by the first face, faces are layers of the cube map.
+      if (i == 0) glTextureStorage2D(handle, getMipmapLevels(width, height), GL_RGBA8, width, height);
+      glTextureSubImage3D(handle, 0, 0, 0, i, width, height, 1, getColorFormat(nChannels), GL_UNSIGNED_BYTE, data);
+      stbi_image_free(data);
+    }
+    glGenerateTextureMipmap(handle);
+    return;
+  }
   bind(15);
   for (int i = 0; i < 6; ++i) {
     stbi_uc* data = stbi_load(filenames[i].string().c_str(), &width, &height, &nChannels, STBI_default);
@@ -37,6 +56,19 @@ void TextureCubeMap::fromColor(const glm::vec4& posx,
                                const glm::vec4& posz,
                                const glm::vec4& negz) const {
   std::array<const glm::vec4, 6> colors{posx, negx, posy, negy, posz, negz};
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureStorage2D(handle, 1, GL_RGBA8, 1, 1);
+    for (int i = 0; i < 6; ++i) {
+      glm::u8vec4 colorByte = glm::round(255.0f * colors[i]);
+      glTextureSubImage3D(handle, 0, 0, 0, i, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, glm::value_ptr(colorByte));
+    }
+    return;
+  }
   bind(15);
   for (int i = 0; i < 6; ++i) {
     glm::u8vec4 colorByte = glm::round(255.0f * colors[i]);
@@ -1,32 +1,62 @@
 #include "texture/framebuffertexture.h"
 #include <vector>
+
+#include "context_manager.h"
 namespace graphics::texture {
-Framebuffer::Framebuffer() noexcept : handle(0) { glGenFramebuffers(1, &handle); }
+Framebuffer::Framebuffer() noexcept : handle(0) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateFramebuffers(1, &handle);
+  } else {
+    glGenFramebuffers(1, &handle);
+  }
+}
 
-Framebuffer::~Framebuffer() { glDeleteFramebuffers(1, &handle); }
+Framebuffer::~Framebuffer() { OpenGLContext::getStateCache().deleteFramebuffer(handle); }
 
 void Framebuffer::setBuffers(std::initializer_list<GLenum> drawbuffers, GLenum readbuffer) const {
-  bind();
   std::vector<GLenum> attachments{drawbuffers};
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glNamedFramebufferDrawBuffers(handle, attachments.size(), attachments.data());
+    glNamedFramebufferReadBuffer(handle, readbuffer);
+    return;
+  }
+  bind();
   glDrawBuffers(attachments.size(), attachments.data());
   glReadBuffer(readbuffer);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  unbind();
 }
 
-void Framebuffer::bind() const { glBindFramebuffer(GL_DRAW_FRAMEBUFFER, handle); }
+void Framebuffer::bind() const { OpenGLContext::getStateCache().bindFramebuffer(GL_DRAW_FRAMEBUFFER, handle); }
+void Framebuffer::unbind() { OpenGLContext::getStateCache().bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); }
 
-FramebufferTexture::FramebufferTexture(unsigned int size) noexcept : textureSize{size} {}
+FramebufferTexture::FramebufferTexture(unsigned int size) noexcept : Texture(GL_TEXTURE_2D), textureSize{size} {}
 
 void FramebufferTexture::attachtoFramebuffer(Framebuffer* fbo, GLenum attachment) const {
+  GLuint clearColor[4] = {0, 0, 0, 0};
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glNamedFramebufferTexture(fbo->getHandle(), attachment, handle, 0);
+    glClearNamedFramebufferuiv(fbo->getHandle(), GL_COLOR, 0, clearColor);
+    return;
+  }
   fbo->bind();
   glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, attachment, GL_TEXTURE_2D, handle, 0);
-  GLuint clearColor[4] = {0, 0, 0, 0};
   glClearBufferuiv(GL_COLOR, 0, clearColor);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  Framebuffer::unbind();
 }
 
 DepthMap::DepthMap(unsigned int size, GLenum internalColor) noexcept : FramebufferTexture(size) {
   GLfloat borderColor[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTextureParameteri(handle, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTextureParameterfv(handle, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glTextureStorage2D(handle, 1, getSizedFormat(internalColor), size, size);
+    return;
+  }
   bind(15);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
@@ -39,6 +69,12 @@ DepthMap::DepthMap(unsigned int size, GLenum internalColor) noexcept : Framebuff
 }
 
 ColorMap::ColorMap(unsigned int size, GLenum internalColor) noexcept : FramebufferTexture(size) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureStorage2D(handle, 1, getSizedFormat(internalColor), size, size);
+    return;
+  }
   bind(15);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -1,26 +1,20 @@
 #include "texture/texture.h"
 
-namespace graphics::texture {
-std::array<std::unordered_map<GLenum, GLuint>, 16> Texture::currentBinding;
-GLenum Texture::currentActiveTextureUnit = GL_TEXTURE0;
-
-Texture::Texture() noexcept : handle(0) { glGenTextures(1, &handle); }
+#include "context_manager.h"
 
-Texture::~Texture() { glDeleteTextures(1, &handle); }
+namespace graphics::texture {
 
-void Texture::bind(GLuint index) const {
-  GLenum textureUnit = GL_TEXTURE0 + index;
-  if (currentActiveTextureUnit != textureUnit) {
-    glActiveTexture(textureUnit);
-    currentActiveTextureUnit = textureUnit;
-  }
-  GLenum textureType = getType();
-  auto& currentHandle = currentBinding[index][textureType];
-  if (handle != currentHandle) {
-    glBindTexture(textureType, handle);
-    currentHandle = handle;
+Texture::Texture(GLenum target) noexcept : handle(0) {
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glCreateTextures(target, 1, &handle);
+  } else {
+    glGenTextures(1, &handle);
   }
 }
 
+Texture::~Texture() { OpenGLContext::getStateCache().deleteTexture(handle); }
+
+void Texture::bind(GLuint index) const { OpenGLContext::getStateCache().bindTexture(index, getType(), handle); }
+
 GLuint Texture::getHandle() const { return handle; }
 }  // namespace graphics::texture
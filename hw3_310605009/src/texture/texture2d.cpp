@@ -4,12 +4,25 @@
 #include <stb_image.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "context_manager.h"
+
 namespace graphics::texture {
 void Texture2D::fromFile(const std::filesystem::path& filename) const {
   int width, height, nChannels;
   stbi_set_flip_vertically_on_load(1);
   stbi_uc* data = stbi_load(filename.string().c_str(), &width, &height, &nChannels, STBI_default);
   if (data == nullptr) THROW_EXCEPTION(std::runtime_error, "Failed to load texture file");
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureStorage2D(handle, getMipmapLevels(width, height), GL_RGBA8, width, height);
+    glTextureSubImage2D(handle, 0, 0, 0, width, height, getColorFormat(nChannels), GL_UNSIGNED_BYTE, data);
+    glGenerateTextureMipmap(handle);
+    stbi_image_free(data);
+    return;
+  }
   bind(15);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -22,6 +35,15 @@ void Texture2D::fromFile(const std::filesystem::path& filename) const {
 
 void Texture2D::fromColor(const glm::vec4& color) const {
   glm::u8vec4 colorByte = glm::round(255.0f * color);
+  if (OpenGLContext::hasDirectStateAccess()) {
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureStorage2D(handle, 1, GL_RGBA8, 1, 1);
+    glTextureSubImage2D(handle, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, glm::value_ptr(colorByte));
+    return;
+  }
   bind(15);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);